@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
 
@@ -8,6 +9,54 @@
 #include "transaction/types.h"
 #include "format.h"
 
+// parse data sent in two chunks split at first_len, then in chunks of chunk_len bytes
+static parser_status_e parse_chunks(const uint8_t *data,
+                                    size_t size,
+                                    size_t first_len,
+                                    size_t chunk_len,
+                                    transaction_parser_t *parser,
+                                    transaction_t *tx) {
+    parser_status_e status = PARSING_OK;
+    size_t offset = 0;
+    size_t len = first_len;
+
+    transaction_parser_init(parser, tx);
+    while (status == PARSING_OK && offset < size) {
+        if (len > size - offset) {
+            len = size - offset;
+        }
+        buffer_t buf = {.ptr = data + offset, .size = len, .offset = 0};
+        status = transaction_parser_update(parser, &buf);
+        offset += len;
+        len = chunk_len;
+    }
+
+    return (status == PARSING_OK) ? transaction_parser_finish(parser) : status;
+}
+
+// the chunks must not change whether a transaction is accepted, nor its fields
+static void check_chunks(const uint8_t *data,
+                         size_t size,
+                         size_t first_len,
+                         size_t chunk_len,
+                         parser_status_e expected,
+                         const transaction_t *expected_tx) {
+    static transaction_parser_t parser;
+    transaction_t tx;
+    parser_status_e status = parse_chunks(data, size, first_len, chunk_len, &parser, &tx);
+
+    if ((status == PARSING_OK) != (expected == PARSING_OK)) {
+        abort();
+    }
+    if (status == PARSING_OK &&
+        (tx.nonce != expected_tx->nonce || tx.value != expected_tx->value ||
+         memcmp(tx.to, expected_tx->to, ADDRESS_LEN) != 0 ||
+         tx.memo_len != expected_tx->memo_len ||
+         memcmp(tx.memo, expected_tx->memo, tx.memo_len) != 0)) {
+        abort();
+    }
+}
+
 int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
     buffer_t buf = {.ptr = data, .size = size, .offset = 0};
     transaction_t tx;
@@ -21,6 +70,14 @@ int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
 
     status = transaction_deserialize(&buf, &tx);
 
+    if (size <= MAX_TX_LEN + 1) {
+        // every boundary between two chunks, then every boundary at once
+        for (size_t first_len = 0; first_len <= size; first_len++) {
+            check_chunks(data, size, first_len, size, status, &tx);
+        }
+        check_chunks(data, size, 1, 1, status, &tx);
+    }
+
     if (status == PARSING_OK) {
         format_u64(nonce, sizeof(nonce), tx.nonce);
         printf("nonce: %s\n", nonce);
@@ -20,6 +20,42 @@
  * Parameter 1 for maximum APDU number.
  */
 #define P1_MAX 0x03
+/**
+ * Parameter 1 for first APDU of a note, with its lengths.
+ */
+#define P1_NOTE_START 0x00
+/**
+ * Parameter 1 for next APDU of a note, with its next bytes.
+ */
+#define P1_NOTE_CONTINUE 0x01
+/**
+ * Parameter 1 for last APDU of a note, with its hash.
+ */
+#define P1_NOTE_FINISH 0x02
+/**
+ * Parameter 1 for APDU announcing several notes, with their number and total length.
+ */
+#define P1_NOTE_BATCH 0x03
+/**
+ * Parameter 1 for first APDU of an encrypted note, with the length of its payload.
+ */
+#define P1_NOTE_ENCRYPTED_START 0x04
+/**
+ * Parameter 1 for next APDU of an encrypted note, with the next bytes of its payload.
+ */
+#define P1_NOTE_ENCRYPTED_CONTINUE 0x05
+/**
+ * Parameter 1 for first APDU of a transaction batch, with the BIP32 path and their number.
+ */
+#define P1_BATCH_START 0x00
+/**
+ * Parameter 1 for APDU with a chunk of the next transaction of a batch.
+ */
+#define P1_BATCH_TX 0x01
+/**
+ * Parameter 1 for APDU getting the next signatures of an approved batch.
+ */
+#define P1_BATCH_SIGNATURES 0x02
 
 /**
  * Dispatch APDU command received to the right handler.
@@ -21,15 +21,34 @@ extern "C" {
  *      DEFINES
  *********************/
 #define APPVERSION              "1.0.0"
-#define NB_MAX_NOTES            10
 #define NOTE_TITLE_MAX_LEN      128
 #define NOTE_CONTENT_MAX_LEN    512
 #define CONTACT_NAME_LEN        32
 #define CONTACT_ADDRESS_MAX_LEN 32
-#define NB_MAX_CONTACTS         16
+#define CONTACT_PUBLIC_KEY_LEN  33  // compressed secp256k1 public key, used to share notes
+#define SHARING_KEY_LEN         32
+
+// Stax and Flex have enough flash for hundreds of notes
+#if defined(TARGET_STAX) || defined(TARGET_FLEX)
+#define NB_MAX_NOTES    256
+#define NB_MAX_CONTACTS 64
+#else  // TARGET_STAX || TARGET_FLEX
+#define NB_MAX_NOTES    32
+#define NB_MAX_CONTACTS 16
+#endif  // TARGET_STAX || TARGET_FLEX
 
 #define NB_MAX_PARAGRAPHS 10
 
+// number of edited bytes of a note after which its modifications are saved, even if it is still
+// being edited
+#ifndef NOTES_EDIT_MAX_DIRTY_BYTES
+#define NOTES_EDIT_MAX_DIRTY_BYTES NOTE_CONTENT_MAX_LEN
+#endif  // NOTES_EDIT_MAX_DIRTY_BYTES
+
+// length of a modified slot returned by app_notesGetChanges(): slot (2) || sequence number (4) ||
+// hash (32)
+#define STORE_CHANGE_LEN (2 + 4 + 32)
+
 #define MAX_PIN_LENGTH 8
 #define MIN_PIN_LENGTH 4
 
@@ -37,17 +56,25 @@ extern "C" {
  *      TYPEDEFS
  **********************/
 typedef struct {
-    uint8_t index;
-    char   *title;
-    char   *content;
+    uint16_t index;
+    char    *title;
+    char    *content;
 } Note_t;
 
 typedef struct {
-    uint8_t index;
-    char   *name;
-    char   *address;
+    uint16_t index;
+    char    *name;
+    char    *address;
 } Contact_t;
 
+// metadata of a saved note, kept in RAM so that screens do not need to read it from NVRAM
+typedef struct {
+    uint16_t contentLength;  // length of the decoded content, without final '\0'
+    uint16_t contentHash;    // CRC-16 of the decoded content
+    uint16_t nbParagraphs;   // number of paragraphs of the content (0 if empty)
+    uint8_t  titleLength;    // length of the title, without final '\0'
+} NoteInfo_t;
+
 /**********************
  *      VARIABLES
  **********************/
@@ -78,27 +105,64 @@ void    app_notesDisplay(nbgl_callback_t onBack, Note_t *note);
 void    app_notesActionOnNote(nbgl_callback_t onBack, Note_t *note);
 void    app_notesShare(nbgl_callback_t onBack, Note_t *note);
 void    app_notesNewContact(nbgl_callback_t onBack, Contact_t *contact);
-void    app_notesAddAddress(const char *address);
-Note_t *app_notesGetSharedNote(void);
+void    app_notesAddAddress(const char *address, const uint8_t *publicKey);
+const uint8_t *app_notesGetSharedPayload(uint16_t *length);
+void    app_notesSharedNoteSent(void);
 int     app_notesReceiveSharedNote(const char *title, const char *content);
-
-void    app_notesInit(void);
-uint8_t app_notesGetAll(Note_t noteArray[NB_MAX_NOTES]);
-int     app_notesGetNote(uint8_t index, Note_t *note);
-int     app_notesAddNote(const char *title, const char *content);
-int     app_notesModifyNote(uint8_t index, const char *title, const char *content);
-int     app_notesDeleteNote(uint8_t index);
+int     app_notesReceiveSharedNotes(uint16_t nbNotes, uint16_t nbBytes);
+bool    app_notesSharedPayloadBegin(uint16_t length);
+int     app_notesSharedPayloadReceive(const uint8_t *bytes, uint16_t length);
+const uint8_t *app_notesSharedPayloadOpen(uint8_t *titleLength, uint16_t *contentLength);
+void    app_notesSharedPayloadClose(void);
+
+void     app_notesInit(void);
+uint16_t app_notesGetAll(Note_t noteArray[NB_MAX_NOTES]);
+uint16_t app_notesGetRange(uint16_t first, uint16_t nbNotes, Note_t *noteArray);
+int      app_notesGetNote(uint16_t index, Note_t *note);
+const NoteInfo_t *app_notesGetNoteInfo(uint16_t index);
+int      app_notesAddNote(const char *title, const char *content);
+int      app_notesModifyNote(uint16_t index, const char *title, const char *content);
+int      app_notesDeleteNote(uint16_t index);
+int      app_notesUpdateNote(uint16_t    index,
+                             const char *title,
+                             const char *content,
+                             uint16_t    nbEditedBytes);
+int      app_notesFlushNote(void);
+int      app_notesGetLostDraft(void);
+int      app_notesStagingBegin(uint16_t nbNotes, uint16_t totalLength);
+int      app_notesStagingStart(uint16_t titleLength, uint16_t contentLength);
+int      app_notesStagingAppend(const uint8_t *bytes, uint16_t length);
+int      app_notesStagingFinish(const uint8_t *hash, Note_t *note);
+uint16_t app_notesStagingGetSummary(uint16_t *nbBytes);
+int      app_notesStagingCommit(void);
+void     app_notesStagingDiscard(void);
+void     app_notesGetLastWriteStats(uint32_t *nbBytes, uint32_t *nbPages);
 
 bool app_notesSettingsIsLocked(void);
 bool app_notesSettingsCheckPasscode(uint8_t *digits, uint8_t nbDigits);
 void app_notesSettingsSetLockAndPasscode(bool lock, uint8_t *digits, uint8_t nbDigits);
 bool app_notesIsSessionUnlocked(void);
 void app_notesSessionLock(void);
-
-uint8_t app_notesGetContacts(Contact_t contactsArray[NB_MAX_CONTACTS]);
-int     app_notesAddContact(const char *name, const char *address);
-int     app_notesModifyContact(uint8_t index, const char *name, const char *address);
-int     app_notesDeleteContact(uint8_t index);
+bool app_notesIsExportAllowed(void);
+void app_notesAllowExport(void);
+
+uint16_t app_notesGetContacts(Contact_t contactsArray[NB_MAX_CONTACTS]);
+int      app_notesAddContact(const char *name, const char *address, const uint8_t *publicKey);
+int      app_notesModifyContact(uint16_t index, const char *name, const char *address);
+int      app_notesDeleteContact(uint16_t index);
+int      app_notesGetContactPublicKey(uint16_t index, uint8_t publicKey[CONTACT_PUBLIC_KEY_LEN]);
+int      app_notesGetContactSharingKey(uint16_t index, uint8_t key[SHARING_KEY_LEN]);
+int      app_notesGetSenderSharingKey(const uint8_t publicKey[CONTACT_PUBLIC_KEY_LEN],
+                                      uint8_t       key[SHARING_KEY_LEN]);
+int      app_notesGetSharingPublicKey(uint8_t publicKey[CONTACT_PUBLIC_KEY_LEN]);
+
+uint32_t app_notesGetContactWrites(uint16_t index);
+uint16_t app_notesGetHeapNbPages(void);
+uint32_t app_notesGetHeapPageWrites(uint8_t bank, uint16_t page);
+uint16_t app_notesGetStoreRoot(uint8_t *root);
+uint32_t app_notesGetNextSeq(void);
+uint16_t app_notesGetChanges(uint32_t cursor, uint16_t *slot, uint8_t *buffer, uint16_t size);
+uint16_t app_notesExport(uint16_t *slot, uint16_t *offset, uint8_t *buffer, uint16_t size);
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -224,6 +224,19 @@ static void paragraphs2content(void)
     }
 }
 
+// keep the modified note in the edit cache (it is saved when leaving it) and display it again
+static void saveAndDisplay(uint16_t nbEditedBytes)
+{
+    if (app_notesUpdateNote(
+            context.note->index, context.note->title, context.note->content, nbEditedBytes)
+        < 0) {
+        // the modification is lost, go back to saved notes
+        nbgl_useCaseStatus("Not enough memory\nto save this Note", false, context.onBack);
+        return;
+    }
+    app_notesDisplay(context.onBack, context.note);
+}
+
 // called when a new paragraph is added
 static void onNewParagraphConfirmed(void)
 {
@@ -241,8 +254,7 @@ static void onNewParagraphConfirmed(void)
     context.nbParagraphs++;
     paragraphs2content();
     // save this note
-    app_notesModifyNote(context.note->index, context.note->title, context.note->content);
-    app_notesDisplay(context.onBack, context.note);
+    saveAndDisplay(strlen(tmpString) + 1);
 }
 
 // called when a paragraph is modified
@@ -284,8 +296,7 @@ static void onParagraphModified(void)
     }
     paragraphs2content();
     // save modified
-    app_notesModifyNote(context.note->index, context.note->title, context.note->content);
-    app_notesDisplay(context.onBack, context.note);
+    saveAndDisplay(MAX(newLen, currentLen) + 1);
 }
 
 // called when the title is modified
@@ -294,8 +305,7 @@ static void onTitleModified(void)
     strcpy(context.note->title, tmpString);
     paragraphs2content();
     // save modified
-    app_notesModifyNote(context.note->index, context.note->title, context.note->content);
-    app_notesDisplay(context.onBack, context.note);
+    saveAndDisplay(strlen(tmpString) + 1);
 }
 
 static void backFromDisplay(void)
@@ -308,6 +318,11 @@ static void layoutTouchCallback(int token, uint8_t index)
 {
     if (token == BACK_BUTTON_TOKEN) {
         context.modifiedParagraphIndex = 0;
+        // all the modifications of the note are saved when leaving it
+        if (app_notesFlushNote() < 0) {
+            nbgl_useCaseStatus("Not enough memory\nto save this Note", false, context.onBack);
+            return;
+        }
         context.onBack();
     }
     else if (token == NAV_TOKEN) {
@@ -421,7 +436,9 @@ void app_notesDisplay(nbgl_callback_t onBack, Note_t *note)
     context.onBack = onBack;
     context.note   = note;
 
-    context.smallFont = (strlen(context.note->content) > 50);
+    // the content is taken from the working buffer, which holds the modifications not saved yet
+    // (the metadata of the saved note can be outdated)
+    context.smallFont = strlen(note->content) > 50;
 
     content2paragraphs(note);
     if (context.nbParagraphs) {
@@ -26,16 +26,20 @@ enum {
 // if no nav
 #define CONTENT_AREA_HEIGHT (SCREEN_HEIGHT - TOUCHABLE_HEADER_BAR_HEIGHT)
 
+// max number of notes in a page (a note bar is added only if it ends above the content area)
+#define NB_MAX_NOTES_IN_PAGE ((CONTENT_AREA_HEIGHT - 1) / TOUCHABLE_BAR_HEIGHT)
+
 /**********************
  *      TYPEDEFS
  **********************/
 typedef struct {
-    uint8_t nbUsedNotes;
-    Note_t  noteArray[NB_MAX_NOTES];
-    uint8_t currentPage;
-    uint8_t nbPages;
-    uint8_t firstNoteIndexInPage;
-    uint8_t selectedNoteIndex;
+    uint16_t nbUsedNotes;
+    Note_t   noteArray[NB_MAX_NOTES_IN_PAGE];  // only the notes of the current page
+    char     titles[NB_MAX_NOTES_IN_PAGE][NOTE_TITLE_MAX_LEN];  // their decrypted titles
+    uint8_t  currentPage;
+    uint8_t  nbPages;
+    uint16_t firstNoteIndexInPage;
+    uint16_t selectedNoteIndex;
 } ListContext_t;
 
 /**********************
@@ -53,91 +57,56 @@ static nbgl_layout_t *layoutContext;
  **********************/
 static void displayNoteList(void);
 
-static uint8_t getNbNotesInPage(uint8_t nbNotes, uint16_t maxHeight)
+// gets the number of notes fitting in a page of the given height
+static uint8_t getNbNotesInPage(uint16_t maxHeight)
 {
-    uint8_t  nbNotesInPage = 0;
-    uint16_t currentHeight = 0;
-
-    while (nbNotesInPage < nbNotes) {
-        // value height
-        currentHeight += TOUCHABLE_BAR_HEIGHT;
-        if (currentHeight >= maxHeight) {
-            break;
-        }
-        nbNotesInPage++;
-    }
-    return nbNotesInPage;
+    // a note bar is added only if it ends above the given height
+    return (maxHeight - 1) / TOUCHABLE_BAR_HEIGHT;
 }
 
-static uint8_t getNbPagesTotal(uint8_t nbTotalNotes)
+static uint8_t getNbPagesTotal(uint16_t nbTotalNotes)
 {
-    uint8_t nbPages          = 0;
-    uint8_t nbRemainingNotes = nbTotalNotes;
     uint8_t nbNotesInPage;
 
-    if (nbTotalNotes == 0) {
+    if (nbTotalNotes <= getNbNotesInPage(CONTENT_AREA_HEIGHT)) {
         return 1;
     }
-    while (nbRemainingNotes > 0) {
-        nbNotesInPage = getNbNotesInPage(nbRemainingNotes, CONTENT_AREA_HEIGHT);
-        // if we already know that there are more than 1 page, or it at the first page
-        // all notes cannot be displayed, it mean that there will be a nav bar
-        if ((nbPages > 0) || (nbRemainingNotes > nbNotesInPage)) {
-            nbNotesInPage
-                = getNbNotesInPage(nbRemainingNotes, CONTENT_AREA_HEIGHT - SIMPLE_FOOTER_HEIGHT);
-        }
-        nbRemainingNotes -= nbNotesInPage;
-        nbPages++;
-    }
-    return nbPages;
+    // if all notes cannot be displayed in the first page, it means that there will be a nav bar
+    // in all pages
+    nbNotesInPage = getNbNotesInPage(CONTENT_AREA_HEIGHT - SIMPLE_FOOTER_HEIGHT);
+    return (nbTotalNotes + nbNotesInPage - 1) / nbNotesInPage;
 }
 
 // gets the number of notes and the index of the first note fitting in the given page
-static uint8_t getNotesForPage(uint8_t  nbTotalNotes,
-                               uint8_t  page,
-                               uint16_t maxHeight,
-                               uint8_t *firstParagraphIndexInPage)
+static uint8_t getNotesForPage(uint16_t  nbTotalNotes,
+                               uint8_t   page,
+                               uint16_t  maxHeight,
+                               uint16_t *firstNoteIndexInPage)
 {
-    uint8_t nbPages          = 0;
-    uint8_t nbRemainingNotes = nbTotalNotes;
-    uint8_t nbNotesInPage;
-    uint8_t i = 0;
-    ;
+    uint8_t nbNotesInPage = getNbNotesInPage(maxHeight);
 
-    while (i < nbTotalNotes) {
-        // upper margin
-        nbNotesInPage = getNbNotesInPage(nbRemainingNotes, maxHeight);
-        if (nbPages == page) {
-            *firstParagraphIndexInPage = i;
-            return nbNotesInPage;
-        }
-        i += nbNotesInPage;
-        nbRemainingNotes -= nbNotesInPage;
-        nbPages++;
+    *firstNoteIndexInPage = page * nbNotesInPage;
+    if (*firstNoteIndexInPage >= nbTotalNotes) {
+        return 0;
     }
-    return nbPages;
+    if ((nbTotalNotes - *firstNoteIndexInPage) < nbNotesInPage) {
+        return nbTotalNotes - *firstNoteIndexInPage;
+    }
+    return nbNotesInPage;
 }
 
-// gets the number of notes and the index of the first note fitting in the given page
-static uint8_t getPageForNoteIndex(uint8_t nbTotalNotes, uint8_t noteIndex, uint16_t maxHeight)
+// gets the page containing the note at the given index (or the last page if after the last note)
+static uint8_t getPageForNoteIndex(uint16_t nbTotalNotes, uint16_t noteIndex, uint16_t maxHeight)
 {
-    uint8_t nbPages          = 0;
-    uint8_t nbRemainingNotes = nbTotalNotes;
-    uint8_t nbNotesInPage;
-    uint8_t i = 0;
-    ;
-
-    while (i < nbTotalNotes) {
-        // upper margin
-        nbNotesInPage = getNbNotesInPage(nbRemainingNotes, maxHeight);
-        i += nbNotesInPage;
-        if (i >= noteIndex) {
-            return nbPages;
-        }
-        nbRemainingNotes -= nbNotesInPage;
-        nbPages++;
+    if (noteIndex >= nbTotalNotes) {
+        noteIndex = nbTotalNotes - 1;
     }
-    return nbPages;
+    return noteIndex / getNbNotesInPage(maxHeight);
+}
+
+static void displayCurrentNote(void)
+{
+    app_notesDisplay(app_notesList, &currentNote);
 }
 
 static void layoutTouchCallback(int token, uint8_t index)
@@ -156,10 +125,13 @@ static void layoutTouchCallback(int token, uint8_t index)
     }
     else if (token >= BAR_TOUCHED_TOKEN) {
         context.selectedNoteIndex = context.firstNoteIndexInPage + token - BAR_TOUCHED_TOKEN;
-        currentNote.index         = context.noteArray[context.selectedNoteIndex].index;
-        strcpy(currentNote.title, context.noteArray[context.selectedNoteIndex].title);
-        strcpy(currentNote.content, context.noteArray[context.selectedNoteIndex].content);
-        app_notesDisplay(app_notesList, &currentNote);
+        // a corrupted note is still displayed, so that it can be repaired or deleted
+        if (app_notesGetNote(context.noteArray[token - BAR_TOUCHED_TOKEN].index, &currentNote)
+            < 0) {
+            nbgl_useCaseStatus("This Note\nis corrupted", false, displayCurrentNote);
+            return;
+        }
+        displayCurrentNote();
     }
 }
 
@@ -219,8 +191,14 @@ static void displayNoteList(void)
         }
         uint8_t nbNotesInPage = getNotesForPage(
             context.nbUsedNotes, context.currentPage, maxHeight, &context.firstNoteIndexInPage);
+        // only the notes of the page are retrieved, and only their titles are decrypted
+        for (uint8_t i = 0; i < nbNotesInPage; i++) {
+            context.noteArray[i].title = context.titles[i];
+        }
+        nbNotesInPage
+            = app_notesGetRange(context.firstNoteIndexInPage, nbNotesInPage, context.noteArray);
         for (uint8_t i = 0; i < nbNotesInPage; i++) {
-            barLayout.text  = context.noteArray[context.firstNoteIndexInPage + i].title;
+            barLayout.text  = context.noteArray[i].title;
             barLayout.token = BAR_TOUCHED_TOKEN + i;
             nbgl_layoutAddTouchableBar(layoutContext, &barLayout);
             nbgl_layoutAddSeparationLine(layoutContext);
@@ -242,7 +220,7 @@ static void displayNoteList(void)
  */
 void app_notesList(void)
 {
-    context.nbUsedNotes = app_notesGetAll(context.noteArray);
+    context.nbUsedNotes = app_notesGetAll(NULL);
     // compute number of pages
     context.nbPages = getNbPagesTotal(context.nbUsedNotes);
     if (context.nbUsedNotes) {
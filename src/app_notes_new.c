@@ -44,9 +44,11 @@ static void onTitleConfirmed(void)
     int status;
     // save note without content
     status = app_notesAddNote(newNote->title, newNote->content);
-    if (status >= 0) {
-        newNote->index = (uint8_t) status;
+    if (status < 0) {
+        nbgl_useCaseStatus("Not enough memory\nto add a Note", false, onBackCallback);
+        return;
     }
+    newNote->index = (uint16_t) status;
     app_notesDisplay(app_notesList, newNote);
 }
 
@@ -101,17 +101,16 @@ void app_notesNewContact(nbgl_callback_t onBack, Contact_t *contact)
 }
 
 /**
- * @brief Function when receiving APDU with address
+ * @brief Function when receiving APDU with address, and optionally the public key of the contact
  *
  */
-void app_notesAddAddress(const char *address)
+void app_notesAddAddress(const char *address, const uint8_t *publicKey)
 {
     int status;
 
-    // save contact without address
-    status = app_notesAddContact(newContact->name, address);
+    status = app_notesAddContact(newContact->name, address, publicKey);
     if (status >= 0) {
-        newContact->index = (uint8_t) status;
+        newContact->index = (uint16_t) status;
     }
     onBackCallback();
 }
\ No newline at end of file
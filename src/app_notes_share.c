@@ -1,7 +1,8 @@
 
 /**
  * @file app_notes_share.c
- * @brief Page to display the list of contacts and share a note
+ * @brief Page to select the contacts to share a note with, all of them receiving the same
+ * encrypted payload
  *
  */
 
@@ -12,6 +13,8 @@
 #include "nbgl_debug.h"
 #include "nbgl_use_case.h"
 #include "app_notes.h"
+#include "bitmap.h"
+#include "note_share.h"
 
 /*********************
  *      DEFINES
@@ -21,11 +24,12 @@ enum {
     NAV_TOKEN,
     ADD_CONTACT_TOKEN,
     CANCEL_TOKEN,
-    BAR_TOUCHED_TOKEN,
+    SHARE_TOKEN,
+    CONTACT_SWITCH_TOKEN,
 };
 
-// if no nav
-#define CONTENT_AREA_HEIGHT (SCREEN_HEIGHT - TOUCHABLE_HEADER_BAR_HEIGHT)
+// the footer is always displayed, with the share button and the nav if needed
+#define CONTENT_AREA_HEIGHT (SCREEN_HEIGHT - TOUCHABLE_HEADER_BAR_HEIGHT - SIMPLE_FOOTER_HEIGHT)
 
 /**********************
  *      TYPEDEFS
@@ -38,6 +42,9 @@ typedef struct {
     uint8_t         nbPages;
     uint8_t         firstContactIndexInPage;
     uint8_t         selectedContactIndex;
+    uint32_t        selectedContacts[BITMAP_NB_WORDS(NB_MAX_CONTACTS)];  // by contact index
+    uint8_t         nbRecipients;
+    char            shareText[32];
     Note_t          receivedNote;
     nbgl_callback_t onBack;
 } ShareContext_t;
@@ -85,12 +92,6 @@ static uint8_t getNbPagesTotal(uint8_t nbTotalNotes)
     }
     while (nbRemainingNotes > 0) {
         nbNotesInPage = getNbNotesInPage(nbRemainingNotes, CONTENT_AREA_HEIGHT);
-        // if we already know that there are more than 1 page, or it at the first page
-        // all notes cannot be displayed, it mean that there will be a nav bar
-        if ((nbPages > 0) || (nbRemainingNotes > nbNotesInPage)) {
-            nbNotesInPage
-                = getNbNotesInPage(nbRemainingNotes, CONTENT_AREA_HEIGHT - SIMPLE_FOOTER_HEIGHT);
-        }
         nbRemainingNotes -= nbNotesInPage;
         nbPages++;
     }
@@ -145,17 +146,42 @@ static uint8_t getPageForContactIndex(uint8_t nbTotalNotes, uint8_t noteIndex, u
     return nbPages;
 }
 
+static void displayContacts(void)
+{
+    uint8_t publicKey[CONTACT_PUBLIC_KEY_LEN];
+    uint8_t nbContacts = app_notesGetContacts(context.contacts);
+
+    // only the contacts with a public key can receive an encrypted note
+    context.nbUsedContacts = 0;
+    for (uint8_t i = 0; i < nbContacts; i++) {
+        if (app_notesGetContactPublicKey(context.contacts[i].index, publicKey) == 0) {
+            context.contacts[context.nbUsedContacts++] = context.contacts[i];
+        }
+        else {
+            bitmap_clear(context.selectedContacts, context.contacts[i].index);
+        }
+    }
+    // compute number of pages
+    context.nbPages = getNbPagesTotal(context.nbUsedContacts);
+    if (context.nbUsedContacts) {
+        context.currentPage = getPageForContactIndex(
+            context.nbUsedContacts, context.selectedContactIndex, CONTENT_AREA_HEIGHT);
+    }
+    buildScreen();
+}
+
 static void onBackOnShare(void)
 {
-    app_notesShare(context.onBack, context.note);
+    note_share_clear();
+    displayContacts();
 }
 
 static void onNoteReceptionChoice(bool confirm)
 {
     if (confirm) {
         int status;
-        // save note without content
-        status = app_notesAddNote(context.receivedNote.title, context.receivedNote.content);
+        // the received notes are already written in NVRAM, so they only have to be committed
+        status = app_notesStagingCommit();
         if (status >= 0) {
             ui_menu_main();
         }
@@ -166,6 +192,7 @@ static void onNoteReceptionChoice(bool confirm)
         }
     }
     else {
+        app_notesStagingDiscard();
         ui_menu_main();
     }
 }
@@ -193,16 +220,59 @@ static void displayWaitingScreen(void)
         = {.type = HEADER_EMPTY, .separationLine = false, .emptySpace.height = 40};
     nbgl_layoutAddHeader(layoutContext, &headerDesc);
 #endif  // TARGET_STAX
-    snprintf(tmpString,
-             sizeof(tmpString),
-             "Use Ledger Live to share this Note with %s.",
-             currentContact.name);
+    if (context.nbRecipients == 1) {
+        snprintf(tmpString,
+                 sizeof(tmpString),
+                 "Use Ledger Live to share this Note with %s.",
+                 currentContact.name);
+    }
+    else {
+        snprintf(tmpString,
+                 sizeof(tmpString),
+                 "Use Ledger Live to share this Note with %d contacts.",
+                 context.nbRecipients);
+    }
     nbgl_layoutAddCenteredInfo(layoutContext, &centeredInfo);
     nbgl_layoutAddExtendedFooter(layoutContext, &footerDesc);
 
     nbgl_layoutDraw(layoutContext);
 }
 
+// build the payload for all the selected contacts at once: the note is only encrypted once
+static void shareWithSelectedContacts(void)
+{
+    uint8_t publicKey[CONTACT_PUBLIC_KEY_LEN];
+    uint8_t sharingKey[SHARING_KEY_LEN];
+    bool    ok;
+
+    // the contacts compute the key they share with the device from its sharing public key
+    ok = (app_notesGetSharingPublicKey(publicKey) == 0) && note_share_begin(publicKey);
+    context.nbRecipients = 0;
+    for (uint8_t i = 0; ok && (i < context.nbUsedContacts); i++) {
+        uint16_t index = context.contacts[i].index;
+
+        if (!bitmap_test(context.selectedContacts, index)) {
+            continue;
+        }
+        ok = (app_notesGetContactPublicKey(index, publicKey) == 0)
+             && (app_notesGetContactSharingKey(index, sharingKey) == 0)
+             && note_share_add_recipient(publicKey, sharingKey);
+        // the first one is named in the messages if it is the only one
+        if (context.nbRecipients++ == 0) {
+            currentContact.index = index;
+            strcpy(currentContact.name, context.contacts[i].name);
+            strcpy(currentContact.address, context.contacts[i].address);
+        }
+    }
+    explicit_bzero(sharingKey, sizeof(sharingKey));
+    if (!ok || (note_share_finish(context.note->title, context.note->content) < 0)) {
+        note_share_clear();
+        nbgl_useCaseStatus("Impossible to share Note", false, displayContacts);
+        return;
+    }
+    displayWaitingScreen();
+}
+
 static void layoutTouchCallback(int token, uint8_t index)
 {
     if (token == BACK_BUTTON_TOKEN) {
@@ -220,12 +290,31 @@ static void layoutTouchCallback(int token, uint8_t index)
     else if (token == CANCEL_TOKEN) {
         onBackOnShare();
     }
-    else if (token >= BAR_TOUCHED_TOKEN) {
-        context.selectedContactIndex = context.firstContactIndexInPage + token - BAR_TOUCHED_TOKEN;
-        currentContact.index         = context.contacts[context.selectedContactIndex].index;
-        strcpy(currentContact.name, context.contacts[context.selectedContactIndex].name);
-        strcpy(currentContact.address, context.contacts[context.selectedContactIndex].address);
-        displayWaitingScreen();
+    else if (token == SHARE_TOKEN) {
+        shareWithSelectedContacts();
+    }
+    else if (token >= CONTACT_SWITCH_TOKEN) {
+        context.selectedContactIndex
+            = context.firstContactIndexInPage + token - CONTACT_SWITCH_TOKEN;
+        uint16_t contact = context.contacts[context.selectedContactIndex].index;
+        if (index != ON_STATE) {
+            bitmap_clear(context.selectedContacts, contact);
+        }
+        else if (bitmap_count(context.selectedContacts, NB_MAX_CONTACTS)
+                 < NOTE_SHARE_MAX_RECIPIENTS) {
+            bitmap_set(context.selectedContacts, contact);
+        }
+        else {
+            // the switch is restored by the redisplay
+            snprintf(tmpString,
+                     sizeof(tmpString),
+                     "A Note can be shared with up to %d contacts at once",
+                     NOTE_SHARE_MAX_RECIPIENTS);
+            nbgl_useCaseStatus(tmpString, false, buildScreen);
+            return;
+        }
+        // update the share button
+        buildScreen();
     }
 }
 
@@ -240,25 +329,25 @@ static void buildScreen(void)
                                                   .separationLine = true,
                                                   .extendedBack.backToken = BACK_BUTTON_TOKEN,
                                                   .extendedBack.tuneId    = TUNE_TAP_CASUAL,
-                                                  .extendedBack.text = (char *) "Choose receiver",
+                                                  .extendedBack.text = (char *) "Choose receivers",
 #ifdef TARGET_STAX
                                       .extendedBack.actionIcon = &C_Plus_32px,
 #else   // TARGET_STAX
                                       .extendedBack.actionIcon = &C_Plus_40px,
 #endif  // TARGET_STAX
                                       .extendedBack.textToken = NBGL_INVALID_TOKEN};
-    nbgl_layoutBar_t barLayout = {
-        .centered  = false,
-        .iconLeft  = NULL,
-        .iconRight = &PUSH_ICON,
-        .inactive  = false,
-        .large     = false,
-        .subText   = false,
-        .tuneId    = NBGL_NO_TUNE,
+    nbgl_layoutSwitch_t switchInfo = {
+        .subText = NULL,
+        .tuneId  = TUNE_TAP_CASUAL,
     };
+    nbgl_layoutFooter_t footerDesc = {.type = FOOTER_SIMPLE_TEXT};
+    uint8_t             nbSelected = bitmap_count(context.selectedContacts, NB_MAX_CONTACTS);
+    // the share button is only active once at least a contact is selected
+    uint8_t             shareToken = (nbSelected > 0) ? SHARE_TOKEN : NBGL_INVALID_TOKEN;
 
     layoutContext = nbgl_layoutGet(&layoutDescription);
-    if (context.nbUsedContacts < NB_MAX_CONTACTS) {
+    // the contacts without public key are not listed, but they are counted
+    if (app_notesGetContacts(NULL) < NB_MAX_CONTACTS) {
         headerDesc.extendedBack.actionToken = ADD_CONTACT_TOKEN;
     }
     else {
@@ -267,6 +356,30 @@ static void buildScreen(void)
     }
     nbgl_layoutAddHeader(layoutContext, &headerDesc);
 
+    // if content is not empty, display it as a list of switches
+    if (context.nbUsedContacts) {
+        uint8_t nbNotesInPage = getContactsForPage(context.nbUsedContacts,
+                                                   context.currentPage,
+                                                   CONTENT_AREA_HEIGHT,
+                                                   &context.firstContactIndexInPage);
+        for (uint8_t i = 0; i < nbNotesInPage; i++) {
+            const Contact_t *contact = &context.contacts[context.firstContactIndexInPage + i];
+
+            switchInfo.text = contact->name;
+            switchInfo.initState
+                = bitmap_test(context.selectedContacts, contact->index) ? ON_STATE : OFF_STATE;
+            switchInfo.token = CONTACT_SWITCH_TOKEN + i;
+            nbgl_layoutAddSwitch(layoutContext, &switchInfo);
+            nbgl_layoutAddSeparationLine(layoutContext);
+        }
+    }
+
+    if (nbSelected == 0) {
+        snprintf(context.shareText, sizeof(context.shareText), "Select contacts");
+    }
+    else {
+        snprintf(context.shareText, sizeof(context.shareText), "Share with %d", nbSelected);
+    }
     if (context.nbPages > 1) {
         nbgl_layoutNavigationBar_t navInfo = {.activePage         = context.currentPage,
                                               .nbPages            = context.nbPages,
@@ -274,26 +387,19 @@ static void buildScreen(void)
                                               .tuneId             = NBGL_NO_TUNE,
                                               .withBackKey        = true,
                                               .withExitKey        = false,
-                                              .withSeparationLine = true};
-        nbgl_layoutAddNavigationBar(layoutContext, &navInfo);
+                                              .withSeparationLine = false};
+        footerDesc.type                  = FOOTER_TEXT_AND_NAV;
+        footerDesc.textAndNav.text       = context.shareText;
+        footerDesc.textAndNav.token      = shareToken;
+        footerDesc.textAndNav.tuneId     = TUNE_TAP_CASUAL;
+        footerDesc.textAndNav.navigation = navInfo;
     }
-    // if content is not empty, display it as a list of touchable bars
-    if (context.nbUsedContacts) {
-        uint16_t maxHeight = CONTENT_AREA_HEIGHT;
-        if (context.nbPages > 1) {
-            maxHeight -= SIMPLE_FOOTER_HEIGHT;
-        }
-        uint8_t nbNotesInPage = getContactsForPage(context.nbUsedContacts,
-                                                   context.currentPage,
-                                                   maxHeight,
-                                                   &context.firstContactIndexInPage);
-        for (uint8_t i = 0; i < nbNotesInPage; i++) {
-            barLayout.text  = context.contacts[context.firstContactIndexInPage + i].name;
-            barLayout.token = BAR_TOUCHED_TOKEN + i;
-            nbgl_layoutAddTouchableBar(layoutContext, &barLayout);
-            nbgl_layoutAddSeparationLine(layoutContext);
-        }
+    else {
+        footerDesc.simpleText.text   = context.shareText;
+        footerDesc.simpleText.token  = shareToken;
+        footerDesc.simpleText.tuneId = TUNE_TAP_CASUAL;
     }
+    nbgl_layoutAddExtendedFooter(layoutContext, &footerDesc);
 
     nbgl_layoutDraw(layoutContext);
 
@@ -305,43 +411,111 @@ static void buildScreen(void)
  **********************/
 
 /**
- * @brief Page to list the contacts to share a note
+ * @brief Page to select the contacts to share a note with
  *
  */
 void app_notesShare(nbgl_callback_t onBack, Note_t *note)
 {
-    context.onBack         = onBack;
-    context.note           = note;
-    context.nbUsedContacts = app_notesGetContacts(context.contacts);
-    // compute number of pages
-    context.nbPages = getNbPagesTotal(context.nbUsedContacts);
-    if (context.nbUsedContacts) {
-        uint16_t maxHeight = CONTENT_AREA_HEIGHT;
-        if (context.nbPages > 1) {
-            maxHeight -= SIMPLE_FOOTER_HEIGHT;
-        }
-        context.currentPage = getPageForContactIndex(
-            context.nbUsedContacts, context.selectedContactIndex, maxHeight);
-    }
-    buildScreen();
+    context.onBack = onBack;
+    context.note   = note;
+    memset(context.selectedContacts, 0, sizeof(context.selectedContacts));
+    note_share_clear();
+    displayContacts();
 }
 
 /**
- * @brief Function when receiving APDU for sharing emission
+ * @brief Function when receiving APDU for sharing emission (the payload may be sent in several
+ * APDUs)
  *
+ * @param length filled with the length of the payload
+ * @return the encrypted payload for the selected contacts, or NULL if no note is shared
  */
-Note_t *app_notesGetSharedNote(void)
+const uint8_t *app_notesGetSharedPayload(uint16_t *length)
 {
-    if (context.note == NULL) {
-        return NULL;
+    return note_share_get_payload(length);
+}
+
+/**
+ * @brief Function when the last APDU for sharing emission has been received
+ *
+ */
+void app_notesSharedNoteSent(void)
+{
+    if (context.nbRecipients == 1) {
+        snprintf(tmpString,
+                 sizeof(tmpString),
+                 "Note sent\nNext, %s has to accept it.",
+                 currentContact.name);
+    }
+    else {
+        snprintf(tmpString,
+                 sizeof(tmpString),
+                 "Note sent\nNext, the %d contacts have to accept it.",
+                 context.nbRecipients);
     }
-    snprintf(tmpString,
-             sizeof(tmpString),
-             "Note sent\nNext, %s has to accept it.",
-             currentContact.name);
     // display status
     nbgl_useCaseStatus(tmpString, true, app_notesList);
-    return context.note;
+}
+
+/**
+ * @brief Function when receiving APDU for the start of an encrypted payload (the payload may be
+ * received in several APDUs), dropping any payload being shared
+ *
+ * @param length length of the whole payload
+ * @return true if OK, false if the length is not the one of a payload
+ */
+bool app_notesSharedPayloadBegin(uint16_t length)
+{
+    return note_share_receive_begin(length);
+}
+
+/**
+ * @brief Function when receiving APDU for the next bytes of an encrypted payload
+ *
+ * @param bytes next bytes of the payload
+ * @param length number of bytes
+ * @return number of bytes still to be received, or -1 if too many bytes
+ */
+int app_notesSharedPayloadReceive(const uint8_t *bytes, uint16_t length)
+{
+    return note_share_receive(bytes, length);
+}
+
+/**
+ * @brief Decrypt the received payload for the device, with the key shared with its sender
+ *
+ * @param titleLength filled with the length of the title
+ * @param contentLength filled with the length of the content
+ * @return the title followed by the content (without final '\0'), valid until
+ * app_notesSharedPayloadClose() is called, or NULL if the device is not a recipient or the
+ * payload is not authentic (it is then dropped)
+ */
+const uint8_t *app_notesSharedPayloadOpen(uint8_t *titleLength, uint16_t *contentLength)
+{
+    uint8_t        publicKey[CONTACT_PUBLIC_KEY_LEN];
+    uint8_t        sharingKey[SHARING_KEY_LEN];
+    const uint8_t *sender = note_share_get_sender();
+    const uint8_t *note   = NULL;
+
+    // the recipient of the device is found by the public key of its sharing key
+    if ((sender != NULL) && (app_notesGetSharingPublicKey(publicKey) == 0)
+        && (app_notesGetSenderSharingKey(sender, sharingKey) == 0)) {
+        note = note_share_open(publicKey, sharingKey, titleLength, contentLength);
+    }
+    explicit_bzero(sharingKey, sizeof(sharingKey));
+    if (note == NULL) {
+        note_share_clear();
+    }
+    return note;
+}
+
+/**
+ * @brief Drop the received payload, wiping the decrypted note
+ *
+ */
+void app_notesSharedPayloadClose(void)
+{
+    note_share_clear();
 }
 
 /**
@@ -353,9 +527,6 @@ int app_notesReceiveSharedNote(const char *title, const char *content)
     if (title == NULL) {
         return -1;
     }
-    if (content == NULL) {
-        return -1;
-    }
     context.receivedNote.title   = (char *) title;
     context.receivedNote.content = (char *) content;
     // display status
@@ -366,4 +537,39 @@ int app_notesReceiveSharedNote(const char *title, const char *content)
                        "Reject Note",
                        onNoteReceptionChoice);
     return 0;
+}
+
+/**
+ * @brief Ask the user to accept several received notes at once, with a summary of them
+ *
+ * @param nbNotes number of received notes
+ * @param nbBytes total length of their titles and contents
+ * @return >= 0 if OK
+ */
+int app_notesReceiveSharedNotes(uint16_t nbNotes, uint16_t nbBytes)
+{
+    static char sizeString[16];
+
+    if (nbNotes == 0) {
+        return -1;
+    }
+    snprintf(tmpString, sizeof(tmpString), "Add %d shared Notes?", nbNotes);
+    if (nbBytes < 1024) {
+        snprintf(sizeString, sizeof(sizeString), "%d bytes", nbBytes);
+    }
+    else {
+        snprintf(sizeString,
+                 sizeof(sizeString),
+                 "%d.%d KB",
+                 nbBytes / 1024,
+                 ((nbBytes % 1024) * 10) / 1024);
+    }
+    // display status
+    nbgl_useCaseChoice(&C_Download_64px,
+                       tmpString,
+                       sizeString,
+                       "Add Notes",
+                       "Reject Notes",
+                       onNoteReceptionChoice);
+    return 0;
 }
\ No newline at end of file
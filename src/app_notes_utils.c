@@ -1,162 +1,2130 @@
+/**
+ * @file app_notes_utils.c
+ * @brief non-UI functions to manages notes (get/add) in Note App
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stddef.h>
+#include <string.h>
+#include "cx.h"
+#include "nbgl_debug.h"
+#include "nbgl_use_case.h"
+#include "app_notes.h"
+#include "bitmap.h"
+#include "key_cache.h"
+#include "merkle.h"
+#include "note_crypt.h"
+#include "nvram_struct.h"
+#include "os_nvm.h"
+#include "os_pic.h"
+#include "compression/text_codec.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+// value of a record table entry when the field of the note has no record
+#define NO_RECORD 0xFFFF
+
+// value of the index of the note with an open draft, when there is none
+#define NO_DRAFT 0xFFFF
+
+// title returned instead of the one of a corrupted note, which may not be terminated
+#define CORRUPTED_NOTE_TITLE "Corrupted Note"
+
+// number of slots exported by app_notesExport(): the notes then the contacts
+#define EXPORT_NB_SLOTS (NB_MAX_NOTES + NB_MAX_CONTACTS)
+
+// possible flags of an exported note
+#define EXPORT_FLAG_CORRUPTED 0x01
+
+// kinds of leaves of the Merkle tree of the store
+#define STORE_LEAF_NOTE    0x01
+#define STORE_LEAF_CONTACT 0x02
+
+// size of a heap record with the given length of data, rounded up to a multiple of 4 bytes
+#define RECORD_SIZE(_length) ((sizeof(NvramNoteRecord_t) + (_length) + 3) & ~((uint32_t) 3))
+
+// when the free space of the active bank is below this threshold, the heap is compacted when
+// going back to the home page, rather than when saving a note
+#define COMPACTION_THRESHOLD \
+    RECORD_SIZE(NOTE_TITLE_MAX_LEN + NOTE_CONTENT_MAX_LEN + 2 * NOTE_CRYPT_OVERHEAD)
+
+// state of the conversion from the given version, before running the given step (the tag makes
+// the state of a never converted NVRAM unlikely to be valid)
+#define CONVERSION_STATE(_fromVersion, _step) \
+    (0x43560000 | ((uint32_t) (_fromVersion) << 8) | (_step))
+#define CONVERSION_STATE_MASK 0xFFFFFF00
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+// offsets in active bank of the records holding the current fields of a note
+typedef struct {
+    uint16_t title;
+    uint16_t content;
+} NoteRecords_t;
+
+// step of a conversion of NVRAM from an older version
+// a step may be interrupted by a power loss, and is then run again from its beginning at next
+// start-up, so it must not depend on the data it overwrites
+typedef void (*ConversionStep_t)(void);
+
+// conversion of NVRAM from an older version to the current one
+typedef struct {
+    uint8_t                 fromVersion;
+    uint8_t                 nbSteps;
+    const ConversionStep_t *steps;
+} Conversion_t;
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static char workingTitle[NOTE_TITLE_MAX_LEN];
+static char workingContent[NOTE_CONTENT_MAX_LEN];
+static char workingName[CONTACT_NAME_LEN];
+static char workingAddress[CONTACT_ADDRESS_MAX_LEN];
+static bool isUnlocked = false;
+static bool isExportAllowed = false;  // allowed by the user for one export in a session
+
+// record being prepared, so that it can be written by a single NVRAM write
+static union {
+    NvramNoteRecord_t header;
+    uint8_t bytes[sizeof(NvramNoteRecord_t) + NOTE_TITLE_MAX_LEN + NOTE_CONTENT_MAX_LEN
+                  + 2 * NOTE_CRYPT_OVERHEAD];
+} pendingRecord;
+
+// encrypted field being written (a field of a received note, or a field left in plaintext because
+// the keys could not be derived, and encrypted when packed), or compressed content being decrypted
+// before decoding
+static uint8_t fieldBuffer[NOTE_CONTENT_MAX_LEN + NOTE_CRYPT_OVERHEAD];
+
+// record table and bitmap of used notes, rebuilt once at start-up by scanning the active bank
+static NoteRecords_t noteRecords[NB_MAX_NOTES];
+static uint32_t      usedNotes[BITMAP_NB_WORDS(NB_MAX_NOTES)];
+static uint16_t      nbUsedNotes;  // cached number of bits set in usedNotes
+static uint8_t       activeBank;
+static uint16_t      heapTop;  // offset of the first free byte in active bank
+static uint32_t      nextSeq;  // sequence number of the next mutation of a note or a contact
+static uint16_t      draftIndex;  // note whose last record is a draft record (if any)
+
+// sequence number of the last update or deletion of each note, if its record is in the active bank
+// (0 otherwise, for an unused note whose deletion has been dropped when the bank was packed)
+static uint32_t noteSeqs[NB_MAX_NOTES];
+
+// notes whose data have been checked against their CRCs since their records last changed, and the
+// ones among them found corrupted (the check is done at first access, rather than at start-up)
+static uint32_t verifiedNotes[BITMAP_NB_WORDS(NB_MAX_NOTES)];
+static uint32_t corruptedNotes[BITMAP_NB_WORDS(NB_MAX_NOTES)];
+
+// metadata of each used note: the length of its title, known from its record, and the ones of its
+// content, only known once decrypted (at first access, rather than at start-up) and then updated
+// with the metadata of the pending record when it is appended
+static NoteInfo_t noteInfos[NB_MAX_NOTES];
+static uint32_t   knownInfos[BITMAP_NB_WORDS(NB_MAX_NOTES)];
+static NoteInfo_t pendingInfo;
+
+// number of writes of each page of the active bank since it was packed (not stored, as they can
+// be counted again from its records)
+static uint32_t heapPageWrites[NOTES_HEAP_BANK_PAGES];
+
+// current copy of each contact slot, found at start-up, and copy of the bitmap of used contacts
+static uint8_t  contactCopies[NB_MAX_CONTACTS];
+static uint32_t usedContacts[BITMAP_NB_WORDS(NB_MAX_CONTACTS)];
+static uint16_t nbUsedContacts;  // cached number of bits set in usedContacts
+
+static bool storageLoaded = false;
+
+// note being edited, whose modifications are kept in the given buffers until flushed in NVRAM
+static struct {
+    const char *title;
+    const char *content;
+    uint16_t    index;
+    uint16_t    nbDirtyBytes;  // number of bytes edited since the last flush
+    bool        isDirty;
+} editCache;
+
+// notes being received, whose records are written directly after the last record of the active
+// bank, except the header of the first one: the scan of the heap stops there, so that they are all
+// saved at once by only writing this header once accepted
+static struct {
+    cx_sha256_t       hash;           // running hash of the title and content being received
+    NvramNoteRecord_t firstRecord;    // header of the first record, written to commit the notes
+    uint32_t          firstSeq;       // sequence number of the first note, reserved for all notes
+    uint16_t          start;          // offset of the first record in the active bank
+    uint16_t          end;            // end of the space reserved for the records
+    uint16_t          offset;         // offset of the record of the note being received
+    uint16_t          index;          // index of the note being received
+    uint16_t          nbNotes;        // number of announced notes
+    uint16_t          nbStaged;       // number of notes completely received
+    uint16_t          nbBytes;        // total length of the titles and contents received
+    uint16_t          titleLength;    // expected length of the title, without final '\0'
+    uint16_t          contentLength;  // expected length of the content, without final '\0'
+    uint16_t          nbReceived;     // number of bytes of the title and the content received
+    note_crypt_ctx_t  crypt;          // encryption of the field being received
+    char              title[NOTE_TITLE_MAX_LEN];  // title being received, to be displayed
+    bool              isActive;       // cancelled by any other record appended in the active bank
+    bool              isBatch;        // whether the number of notes has been announced
+    bool              isReceiving;    // whether a note has been started and not finished
+} staging;
+
+// note whose modifications have been lost, because its draft was still open at start-up
+static uint16_t lostDraftIndex = NO_DRAFT;
+
+// what has actually been written in NVRAM by the latest modification
+static Nvram_write_stats_t writeStats;
+
+/**********************
+ *      VARIABLES
+ **********************/
+Note_t    currentNote;
+Contact_t currentContact;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+// get the record at the given offset of the given bank
+static volatile NvramNoteRecord_t *heapRecord(uint8_t bank, uint16_t offset)
+{
+    return (volatile NvramNoteRecord_t *) &N_nvram.data.notesBanks[bank].records[offset];
+}
+
+// get the data of the record at the given offset of the given bank
+static uint8_t *heapData(uint8_t bank, uint16_t offset)
+{
+    return (uint8_t *) &N_nvram.data.notesBanks[bank].records[offset + sizeof(NvramNoteRecord_t)];
+}
+
+// get the size of the record at the given offset of the active bank
+static uint16_t heapRecordSize(uint16_t offset)
+{
+    volatile NvramNoteRecord_t *record = heapRecord(activeBank, offset);
+
+    return RECORD_SIZE(record->titleLength + record->contentLength);
+}
+
+// compute the CRC of the given record header (without its final CRC)
+static uint16_t heapHeaderCrc(const volatile NvramNoteRecord_t *record)
+{
+    return cx_crc16((const void *) record, offsetof(NvramNoteRecord_t, headerCrc));
+}
+
+// check whether the given length of a field, encrypted or not, is valid
+static bool heapIsValidLength(uint16_t length, bool isEncrypted, uint16_t maxLength)
+{
+    if (isEncrypted && (length > 0)) {
+        return (length > NOTE_CRYPT_OVERHEAD) && (length <= (maxLength + NOTE_CRYPT_OVERHEAD));
+    }
+    return length <= maxLength;
+}
+
+// check whether the header of the record at the given offset of the active bank is valid
+static bool heapIsValidRecord(uint16_t offset)
+{
+    volatile NvramNoteRecord_t *record = heapRecord(activeBank, offset);
+
+    if ((offset + sizeof(NvramNoteRecord_t)) > NOTES_HEAP_BANK_SIZE) {
+        return false;
+    }
+    if ((record->generation != (uint16_t) N_nvram.data.notesBanks[activeBank].generation)
+        || (record->headerCrc != heapHeaderCrc(record)) || (record->index >= NB_MAX_NOTES)) {
+        return false;
+    }
+    if (record->type == NOTES_HEAP_RECORD_UPDATE) {
+        if (!heapIsValidLength(record->titleLength,
+                               record->flags & NOTES_HEAP_FLAG_ENCRYPTED_TITLE,
+                               NOTE_TITLE_MAX_LEN)
+            || !heapIsValidLength(record->contentLength,
+                                  record->flags & NOTES_HEAP_FLAG_ENCRYPTED_CONTENT,
+                                  NOTE_CONTENT_MAX_LEN)
+            || ((record->titleLength == 0) && (record->contentLength == 0))) {
+            return false;
+        }
+    }
+    else if ((record->type == NOTES_HEAP_RECORD_DELETE)
+             || (record->type == NOTES_HEAP_RECORD_DRAFT)) {
+        if ((record->titleLength != 0) || (record->contentLength != 0)) {
+            return false;
+        }
+    }
+    else {
+        return false;
+    }
+    return ((offset + heapRecordSize(offset)) <= NOTES_HEAP_BANK_SIZE);
+}
+
+// check whether the data of the record at the given offset of the active bank is valid
+static bool heapIsValidData(uint16_t offset)
+{
+    volatile NvramNoteRecord_t *record = heapRecord(activeBank, offset);
+
+    return (record->dataCrc
+            == cx_crc16(heapData(activeBank, offset), record->titleLength + record->contentLength));
+}
+
+// check whether the data of the record at the given offset of the active bank (if any) are intact
+static bool heapIsIntactData(uint16_t offset)
+{
+    if (offset == NO_RECORD) {
+        return true;
+    }
+    return ((heapRecord(activeBank, offset)->flags & NOTES_HEAP_FLAG_CORRUPTED) == 0)
+           && heapIsValidData(offset);
+}
+
+// check whether the data of the records holding the current fields of the given note are intact,
+// their CRCs being only checked at the first call since the note was last modified
+static bool noteIsIntact(uint16_t index)
+{
+    if (!bitmap_test(verifiedNotes, index)) {
+        if (heapIsIntactData(noteRecords[index].title)
+            && ((noteRecords[index].content == noteRecords[index].title)
+                || heapIsIntactData(noteRecords[index].content))) {
+            bitmap_clear(corruptedNotes, index);
+        }
+        else {
+            bitmap_set(corruptedNotes, index);
+        }
+        bitmap_set(verifiedNotes, index);
+    }
+    return !bitmap_test(corruptedNotes, index);
+}
+
+// count the writes of the pages of the active bank covered by the given range
+static void heapCountWrites(uint16_t offset, uint16_t size)
+{
+    uint16_t page;
+
+    for (page = offset / NVRAM_PAGE_SIZE; page <= (offset + size - 1) / NVRAM_PAGE_SIZE; page++) {
+        heapPageWrites[page]++;
+    }
+}
+
+// mark the given note as used or not, maintaining the number of used notes
+static void setNoteUsed(uint16_t index, bool used)
+{
+    if (bitmap_test(usedNotes, index) == used) {
+        return;
+    }
+    if (used) {
+        bitmap_set(usedNotes, index);
+        nbUsedNotes++;
+    }
+    else {
+        bitmap_clear(usedNotes, index);
+        nbUsedNotes--;
+    }
+}
+
+// update the record table and the bitmap of used notes with the record at the given offset of
+// the active bank
+static void heapApplyRecord(uint16_t offset)
+{
+    volatile NvramNoteRecord_t *record = heapRecord(activeBank, offset);
+    uint16_t                    index  = record->index;
+
+    // a draft is closed by any later record of its note
+    if (record->type == NOTES_HEAP_RECORD_DRAFT) {
+        draftIndex = index;
+        return;
+    }
+    if (index == draftIndex) {
+        draftIndex = NO_DRAFT;
+    }
+    bitmap_clear(verifiedNotes, index);
+    noteSeqs[index] = record->seq;
+    if (record->type == NOTES_HEAP_RECORD_DELETE) {
+        setNoteUsed(index, false);
+        noteRecords[index].title   = NO_RECORD;
+        noteRecords[index].content = NO_RECORD;
+        memset(&noteInfos[index], 0, sizeof(NoteInfo_t));
+        bitmap_clear(knownInfos, index);
+        return;
+    }
+    setNoteUsed(index, true);
+    if (record->titleLength > 0) {
+        noteRecords[index].title = offset;
+    }
+    if (record->contentLength > 0) {
+        noteRecords[index].content = offset;
+        bitmap_clear(knownInfos, index);
+    }
+}
+
+// build the record table, by scanning the active bank once
+// only the last record may have been interrupted by a power loss, so only its data is checked,
+// and it is dropped if not valid (then overwritten by the next record)
+static void heapScan(void)
+{
+    uint16_t offset = 0;
+
+    memset(noteRecords, 0xFF, sizeof(noteRecords));
+    memset(usedNotes, 0, sizeof(usedNotes));
+    memset(verifiedNotes, 0, sizeof(verifiedNotes));
+    // the deletions dropped when the bank was packed are only known from its header
+    memcpy(noteSeqs,
+           (const void *) N_nvram.data.notesBanks[activeBank].noteSeqs,
+           sizeof(noteSeqs));
+    nbUsedNotes = 0;
+    draftIndex  = NO_DRAFT;
+    nextSeq   = N_nvram.data.notesBanks[activeBank].seq;
+    // the first page has also been written when the bank was packed
+    memset(heapPageWrites, 0, sizeof(heapPageWrites));
+    heapPageWrites[0] = 1;
+    while (heapIsValidRecord(offset)) {
+        uint16_t nextOffset = offset + heapRecordSize(offset);
+
+        if (!heapIsValidRecord(nextOffset) && !heapIsValidData(offset)) {
+            break;
+        }
+        heapApplyRecord(offset);
+        heapCountWrites(offset, nextOffset - offset);
+        if (heapRecord(activeBank, offset)->seq >= nextSeq) {
+            nextSeq = heapRecord(activeBank, offset)->seq + 1;
+        }
+        offset = nextOffset;
+    }
+    heapTop = offset;
+}
+
+// select the active bank and build the record table
+static void heapLoad(void)
+{
+    activeBank = (N_nvram.data.notesBanks[1].generation > N_nvram.data.notesBanks[0].generation)
+                     ? 1
+                     : 0;
+    heapScan();
+}
+
+// erase the sequence numbers of the notes stored in the header of the given bank, before it
+// becomes the active one without being packed
+static void heapResetNoteSeqs(uint8_t bank)
+{
+    memset(noteSeqs, 0, sizeof(noteSeqs));
+    nvram_write_delta(
+        (void *) N_nvram.data.notesBanks[bank].noteSeqs, noteSeqs, sizeof(noteSeqs), NULL);
+}
+
+// get the length of the given field once decrypted, if it is encrypted
+static uint16_t heapPlainLength(uint16_t length, bool isEncrypted)
+{
+    // the length of an encrypted field has been checked at load
+    return (isEncrypted && (length > 0)) ? (length - NOTE_CRYPT_OVERHEAD) : length;
+}
+
+// get the field of an encrypted content with the given record flags
+static uint8_t heapContentField(uint16_t flags)
+{
+    return (flags & NOTES_HEAP_FLAG_COMPRESSED) ? NOTE_CRYPT_FIELD_COMPRESSED_CONTENT
+                                                : NOTE_CRYPT_FIELD_CONTENT;
+}
+
+// get the size of the current title of the given note, as stored in the heap
+static uint16_t getNoteTitleSize(uint16_t index)
+{
+    if (noteRecords[index].title == NO_RECORD) {
+        return 0;
+    }
+    return heapRecord(activeBank, noteRecords[index].title)->titleLength;
+}
+
+// get the length of the current title of the given note once decrypted (including final '\0')
+static uint16_t getNoteTitleLength(uint16_t index)
+{
+    volatile NvramNoteRecord_t *record;
+
+    if (noteRecords[index].title == NO_RECORD) {
+        return 0;
+    }
+    record = heapRecord(activeBank, noteRecords[index].title);
+    return heapPlainLength(record->titleLength, record->flags & NOTES_HEAP_FLAG_ENCRYPTED_TITLE);
+}
+
+// decrypt the current title of the given note in the given buffer (of NOTE_TITLE_MAX_LEN bytes),
+// and return false if it is not authentic (the buffer then holds an empty title)
+static bool getNoteTitle(uint16_t index, char *title)
+{
+    volatile NvramNoteRecord_t *record;
+    const uint8_t              *data;
+    uint16_t                    length = getNoteTitleLength(index);
+
+    title[0] = '\0';
+    if (length == 0) {
+        return true;
+    }
+    record = heapRecord(activeBank, noteRecords[index].title);
+    data   = heapData(activeBank, noteRecords[index].title);
+    if (record->flags & NOTES_HEAP_FLAG_ENCRYPTED_TITLE) {
+        if (note_crypt_open(
+                index, NOTE_CRYPT_FIELD_TITLE, data, record->titleLength, (uint8_t *) title)
+            < 0) {
+            title[0] = '\0';
+            return false;
+        }
+    }
+    else {
+        // left in plaintext as the keys could not be derived, until the heap is packed
+        memcpy(title, data, length);
+    }
+    title[length - 1] = '\0';
+    return true;
+}
+
+// get the current content of the given note, as stored in the heap
+static uint8_t *getNoteContentData(uint16_t index)
+{
+    uint16_t offset = noteRecords[index].content;
+
+    return heapData(activeBank, offset) + heapRecord(activeBank, offset)->titleLength;
+}
+
+// get the length of the current content of the given note, as stored in the heap
+static uint16_t getNoteContentLength(uint16_t index)
+{
+    if (noteRecords[index].content == NO_RECORD) {
+        return 0;
+    }
+    return heapRecord(activeBank, noteRecords[index].content)->contentLength;
+}
+
+// set the content metadata of the given info with the given decoded content
+static void noteInfoSetContent(NoteInfo_t *info, const char *content)
+{
+    const char *currentChar = content;
+
+    info->nbParagraphs = (*content != '\0') ? 1 : 0;
+    while (*currentChar) {
+        if (*currentChar == '\n') {
+            info->nbParagraphs++;
+        }
+        currentChar++;
+    }
+    info->contentLength = currentChar - content;
+    info->contentHash   = cx_crc16(content, info->contentLength);
+}
+
+// decrypt and decode the current content of the given note in the given buffer, updating its
+// metadata on the way, and return false if it is not authentic (the buffer then holds an empty
+// content)
+static bool getNoteContent(uint16_t index, char *content)
+{
+    volatile NvramNoteRecord_t *record;
+    const uint8_t              *data;
+    uint16_t                    length = getNoteContentLength(index);
+
+    content[0] = '\0';
+    if (length > 0) {
+        record = heapRecord(activeBank, noteRecords[index].content);
+        data   = getNoteContentData(index);
+        if (record->flags & NOTES_HEAP_FLAG_ENCRYPTED_CONTENT) {
+            // a raw content is decrypted in place, a compressed one before being decoded there
+            uint8_t *plain  = (record->flags & NOTES_HEAP_FLAG_COMPRESSED) ? fieldBuffer
+                                                                           : (uint8_t *) content;
+            int plainLength = note_crypt_open(
+                index, heapContentField(record->flags), data, length, plain);
+
+            if (plainLength < 0) {
+                content[0] = '\0';
+                return false;
+            }
+            data   = plain;
+            length = plainLength;
+        }
+        if (record->flags & NOTES_HEAP_FLAG_COMPRESSED) {
+            if (text_codec_decompress(data, length, content, NOTE_CONTENT_MAX_LEN) < 0) {
+                content[0] = '\0';
+            }
+        }
+        else {
+            // the length of a raw content has been checked at load, and includes the final '\0'
+            memmove(content, data, length);
+            content[length - 1] = '\0';
+        }
+    }
+    noteInfoSetContent(&noteInfos[index], content);
+    bitmap_set(knownInfos, index);
+    return true;
+}
+
+// build the metadata of the used notes known without decrypting them, the ones of their contents
+// being computed when first decrypted, so that start-up does not depend on the size of the notes
+static void noteInfosLoad(void)
+{
+    uint16_t i;
+
+    memset(noteInfos, 0, sizeof(noteInfos));
+    memset(knownInfos, 0, sizeof(knownInfos));
+    for (i = bitmap_next_set(usedNotes, NB_MAX_NOTES, 0); i < NB_MAX_NOTES;
+         i = bitmap_next_set(usedNotes, NB_MAX_NOTES, i + 1)) {
+        if (getNoteTitleLength(i) > 0) {
+            noteInfos[i].titleLength = getNoteTitleLength(i) - 1;
+        }
+    }
+}
+
+// get the number of bytes of the active bank that would be used by the used notes once packed
+static uint16_t heapGetLiveSize(void)
+{
+    uint16_t size = 0;
+    uint16_t i;
+
+    for (i = bitmap_next_set(usedNotes, NB_MAX_NOTES, 0); i < NB_MAX_NOTES;
+         i = bitmap_next_set(usedNotes, NB_MAX_NOTES, i + 1)) {
+        size += RECORD_SIZE(getNoteTitleSize(i) + getNoteContentLength(i));
+    }
+    if (draftIndex != NO_DRAFT) {
+        size += RECORD_SIZE(0);
+    }
+    return size;
+}
+
+// write the given field of the given note at the given address of the bank being packed, first
+// encrypting it if requested, and return its length there (the length of the given field if it
+// could not be encrypted)
+static uint16_t heapPackField(uint8_t       *dst,
+                              const uint8_t *src,
+                              uint16_t       length,
+                              uint16_t       index,
+                              uint8_t        field,
+                              bool           encrypt)
+{
+    if (encrypt) {
+        memcpy(&fieldBuffer[NOTE_CRYPT_NONCE_LEN], src, length);
+        encrypt = note_crypt_seal(index, field, fieldBuffer, length);
+        if (encrypt) {
+            nvram_write_delta(dst, fieldBuffer, length + NOTE_CRYPT_OVERHEAD, &writeStats);
+        }
+        explicit_bzero(fieldBuffer, sizeof(fieldBuffer));
+        if (encrypt) {
+            return length + NOTE_CRYPT_OVERHEAD;
+        }
+    }
+    nvram_write_delta(dst, src, length, &writeStats);
+    return length;
+}
+
+// pack the used notes in the other bank, each of them in a single record, then make it the
+// active one (if interrupted, the other bank is not valid and the active one is kept)
+// the page writes of the active bank are added to the ones stored in the new bank
+// the fields left in plaintext (the keys could not be derived when they were written) are
+// encrypted on the way, as long as records with the given total size can still be appended in the
+// new bank
+static void heapCompact(uint32_t needed)
+{
+    uint8_t  newBank       = 1 - activeBank;
+    uint32_t newGeneration = N_nvram.data.notesBanks[activeBank].generation + 1;
+    uint16_t newTop        = 0;
+    uint32_t liveLeft      = heapGetLiveSize();
+    uint16_t i;
+
+    // the data of the note being received (if any) are not packed
+    staging.isActive = false;
+    for (i = 0; i < NOTES_HEAP_BANK_PAGES; i++) {
+        heapPageWrites[i] += N_nvram.data.notesBanks[activeBank].pageWrites[activeBank][i];
+    }
+    nvram_write_delta((void *) N_nvram.data.notesBanks[newBank].pageWrites[activeBank],
+                      heapPageWrites,
+                      sizeof(heapPageWrites),
+                      &writeStats);
+    nvram_write_delta((void *) N_nvram.data.notesBanks[newBank].pageWrites[newBank],
+                      (void *) N_nvram.data.notesBanks[activeBank].pageWrites[newBank],
+                      sizeof(heapPageWrites),
+                      &writeStats);
+    memset(heapPageWrites, 0, sizeof(heapPageWrites));
+    heapPageWrites[0] = 1;
+    for (i = bitmap_next_set(usedNotes, NB_MAX_NOTES, 0); i < NB_MAX_NOTES;
+         i = bitmap_next_set(usedNotes, NB_MAX_NOTES, i + 1)) {
+        volatile NvramNoteRecord_t *titleRecord   = heapRecord(activeBank, noteRecords[i].title);
+        volatile NvramNoteRecord_t *contentRecord = heapRecord(activeBank, noteRecords[i].content);
+        NvramNoteRecord_t           record;
+        uint8_t                    *data = heapData(newBank, newTop);
+        uint16_t                    titleLength;
+        uint16_t                    contentLength;
+        bool                        encryptTitle;
+        bool                        encryptContent;
+
+        memset(&record, 0, sizeof(record));
+        record.seq        = noteSeqs[i];
+        record.generation = (uint16_t) newGeneration;
+        record.index      = i;
+        record.type       = NOTES_HEAP_RECORD_UPDATE;
+        record.flags
+            = (contentRecord->flags
+               & (NOTES_HEAP_FLAG_COMPRESSED | NOTES_HEAP_FLAG_ENCRYPTED_CONTENT))
+              | (titleRecord->flags & NOTES_HEAP_FLAG_ENCRYPTED_TITLE);
+        titleLength    = titleRecord->titleLength;
+        contentLength  = contentRecord->contentLength;
+        encryptTitle   = !(record.flags & NOTES_HEAP_FLAG_ENCRYPTED_TITLE);
+        encryptContent = !(record.flags & NOTES_HEAP_FLAG_ENCRYPTED_CONTENT);
+        liveLeft -= RECORD_SIZE(titleLength + contentLength);
+        // the CRC of a corrupted note is computed again, so it is flagged as corrupted (and it is
+        // not encrypted, as its fields may not have the expected lengths)
+        if (!noteIsIntact(i)) {
+            record.flags |= NOTES_HEAP_FLAG_CORRUPTED;
+            encryptTitle   = false;
+            encryptContent = false;
+        }
+        if ((newTop
+             + RECORD_SIZE(titleLength + contentLength
+                           + (encryptTitle ? NOTE_CRYPT_OVERHEAD : 0)
+                           + (encryptContent ? NOTE_CRYPT_OVERHEAD : 0))
+             + liveLeft + needed)
+            > NOTES_HEAP_BANK_SIZE) {
+            encryptTitle   = false;
+            encryptContent = false;
+        }
+        record.titleLength = heapPackField(data,
+                                           heapData(activeBank, noteRecords[i].title),
+                                           titleLength,
+                                           i,
+                                           NOTE_CRYPT_FIELD_TITLE,
+                                           encryptTitle);
+        if (record.titleLength != titleLength) {
+            record.flags |= NOTES_HEAP_FLAG_ENCRYPTED_TITLE;
+        }
+        record.contentLength = heapPackField(&data[record.titleLength],
+                                             getNoteContentData(i),
+                                             contentLength,
+                                             i,
+                                             heapContentField(record.flags),
+                                             encryptContent);
+        if (record.contentLength != contentLength) {
+            record.flags |= NOTES_HEAP_FLAG_ENCRYPTED_CONTENT;
+        }
+        record.dataCrc   = cx_crc16(data, record.titleLength + record.contentLength);
+        record.headerCrc = heapHeaderCrc(&record);
+        nvram_write_delta(
+            (void *) heapRecord(newBank, newTop), &record, sizeof(record), &writeStats);
+        // the note is not read from the active bank anymore, so its entry can be updated now
+        noteRecords[i].title   = newTop;
+        noteRecords[i].content = newTop;
+        heapCountWrites(newTop, RECORD_SIZE(record.titleLength + record.contentLength));
+        newTop += RECORD_SIZE(record.titleLength + record.contentLength);
+    }
+    // the open draft is kept, so that its modifications are still known as not saved
+    if (draftIndex != NO_DRAFT) {
+        NvramNoteRecord_t record;
+
+        memset(&record, 0, sizeof(record));
+        record.seq        = nextSeq++;
+        record.generation = (uint16_t) newGeneration;
+        record.index      = draftIndex;
+        record.type       = NOTES_HEAP_RECORD_DRAFT;
+        record.dataCrc    = cx_crc16(&record, 0);
+        record.headerCrc  = heapHeaderCrc(&record);
+        nvram_write_delta(
+            (void *) heapRecord(newBank, newTop), &record, sizeof(record), &writeStats);
+        heapCountWrites(newTop, RECORD_SIZE(0));
+        newTop += RECORD_SIZE(0);
+    }
+    nvram_write_delta((void *) N_nvram.data.notesBanks[newBank].noteSeqs,
+                      noteSeqs,
+                      sizeof(noteSeqs),
+                      &writeStats);
+    nvram_write(
+        (void *) &N_nvram.data.notesBanks[newBank].seq, &nextSeq, sizeof(uint32_t), &writeStats);
+    // the generation makes the new bank the active one
+    nvram_write((void *) &N_nvram.data.notesBanks[newBank].generation,
+                &newGeneration,
+                sizeof(uint32_t),
+                &writeStats);
+    activeBank = newBank;
+    heapTop    = newTop;
+}
+
+// ensure that records with the given total size can be appended in the active bank, compacting
+// it if needed
+// the notes modified by the records are counted as live with their current size, so that they are
+// kept until the records are written
+static bool heapReserveSize(uint32_t needed)
+{
+    // even after compaction, there would not be enough space
+    if ((heapGetLiveSize() + needed) > NOTES_HEAP_BANK_SIZE) {
+        return false;
+    }
+    if ((heapTop + needed) > NOTES_HEAP_BANK_SIZE) {
+        heapCompact(needed);
+    }
+    return true;
+}
+
+// ensure that a record with the given length of data can be appended in the active bank
+static bool heapReserve(uint16_t length)
+{
+    return heapReserveSize(RECORD_SIZE(length));
+}
+
+// make sure that the scan of the heap stops at the given offset, before writing a record ending
+// there: the records of cancelled received notes may have been left valid after the top of the heap
+static void heapClearStaleRecord(uint16_t offset)
+{
+    uint8_t type = 0;
+
+    if (heapIsValidRecord(offset)) {
+        nvram_write((void *) &heapRecord(activeBank, offset)->type, &type, 1, &writeStats);
+        heapCountWrites(offset, 1);
+    }
+}
+
+// prepare the pending record to update the given note with the given title and content (NULL if
+// unchanged), with the resulting metadata of the note, and return the length of its data
+// the content is stored compressed only if it saves space, and the record is left in plaintext
+// until sealed by heapSealRecord()
+static uint16_t heapPrepareRecord(uint16_t index, const char *title, const char *content)
+{
+    NvramNoteRecord_t *record = &pendingRecord.header;
+    uint8_t           *data   = &pendingRecord.bytes[sizeof(NvramNoteRecord_t)];
+
+    memset(record, 0, sizeof(NvramNoteRecord_t));
+    record->index = index;
+    record->type  = NOTES_HEAP_RECORD_UPDATE;
+    pendingInfo   = noteInfos[index];
+    if (title != NULL) {
+        pendingInfo.titleLength = strlen(title);
+        record->titleLength     = pendingInfo.titleLength + 1;
+        memcpy(data, title, record->titleLength);
+        data += record->titleLength;
+    }
+    if (content != NULL) {
+        int compressedLength = -1;
+
+        noteInfoSetContent(&pendingInfo, content);
+        record->contentLength = pendingInfo.contentLength + 1;
+#ifdef HAVE_NOTES_COMPRESSION
+        // the compressed content must be strictly smaller than the raw one
+        compressedLength = text_codec_compress(
+            content, record->contentLength - 1, data, record->contentLength - 1);
+#endif  // HAVE_NOTES_COMPRESSION
+        if (compressedLength > 0) {
+            record->contentLength = compressedLength;
+            record->flags |= NOTES_HEAP_FLAG_COMPRESSED;
+        }
+        else {
+            memcpy(data, content, record->contentLength);
+        }
+    }
+    return record->titleLength + record->contentLength;
+}
+
+// erase the pending record, whose data can hold the plaintext of a note (it is left in plaintext
+// until sealed, and also used as buffer to read notes)
+static void heapClearPendingRecord(void)
+{
+    explicit_bzero(&pendingRecord, sizeof(pendingRecord));
+}
+
+// encrypt the title and the content (if any) of the prepared record in place, each of them then
+// stored as nonce || ciphertext || tag, and return the new length of its data
+// if the keys cannot be derived, the record is left in plaintext rather than losing the
+// modification, and it is encrypted when the heap is next packed
+static uint16_t heapSealRecord(void)
+{
+    NvramNoteRecord_t *record        = &pendingRecord.header;
+    uint8_t           *data          = &pendingRecord.bytes[sizeof(NvramNoteRecord_t)];
+    uint16_t           titleLength   = record->titleLength;
+    uint16_t           contentLength = record->contentLength;
+    uint16_t           titleSize     = (titleLength > 0) ? titleLength + NOTE_CRYPT_OVERHEAD : 0;
+
+    if (note_crypt_unlock()) {
+        memmove(&data[titleSize + NOTE_CRYPT_NONCE_LEN], &data[titleLength], contentLength);
+        memmove(&data[NOTE_CRYPT_NONCE_LEN], data, titleLength);
+        if ((titleLength > 0)
+            && note_crypt_seal(record->index, NOTE_CRYPT_FIELD_TITLE, data, titleLength)) {
+            record->titleLength += NOTE_CRYPT_OVERHEAD;
+            record->flags |= NOTES_HEAP_FLAG_ENCRYPTED_TITLE;
+        }
+        if ((contentLength > 0)
+            && note_crypt_seal(record->index,
+                               heapContentField(record->flags),
+                               &data[titleSize],
+                               contentLength)) {
+            record->contentLength += NOTE_CRYPT_OVERHEAD;
+            record->flags |= NOTES_HEAP_FLAG_ENCRYPTED_CONTENT;
+        }
+    }
+    return record->titleLength + record->contentLength;
+}
+
+// check whether the given field of the record at the given offset of the active bank (if any)
+// holds the given bytes, decrypting it by blocks rather than in a buffer
+static bool heapIsSameField(uint16_t offset, bool isContent, const uint8_t *bytes, uint16_t length)
+{
+    volatile NvramNoteRecord_t *record;
+    const uint8_t              *data;
+    uint16_t                    stored;
+    bool                        isEncrypted;
+    uint8_t                     field = NOTE_CRYPT_FIELD_TITLE;
+    note_crypt_ctx_t            ctx;
+    uint8_t                     block[16];
+    uint16_t                    i;
+    bool                        isSame;
+
+    if (offset == NO_RECORD) {
+        return false;
+    }
+    record      = heapRecord(activeBank, offset);
+    data        = heapData(activeBank, offset);
+    stored      = record->titleLength;
+    isEncrypted = record->flags & NOTES_HEAP_FLAG_ENCRYPTED_TITLE;
+    if (isContent) {
+        data += record->titleLength;
+        stored      = record->contentLength;
+        isEncrypted = record->flags & NOTES_HEAP_FLAG_ENCRYPTED_CONTENT;
+        field       = heapContentField(record->flags);
+    }
+    if (!isEncrypted) {
+        return (stored == length) && (memcmp(data, bytes, length) == 0);
+    }
+    if ((stored != (length + NOTE_CRYPT_OVERHEAD))
+        || !note_crypt_start(&ctx, record->index, field, data)) {
+        return false;
+    }
+    data += NOTE_CRYPT_NONCE_LEN;
+    isSame = true;
+    for (i = 0; isSame && (i < length); i += sizeof(block)) {
+        uint16_t size = ((length - i) < sizeof(block)) ? (length - i) : sizeof(block);
+
+        isSame = note_crypt_decrypt(&ctx, &data[i], block, size)
+                 && (memcmp(block, &bytes[i], size) == 0);
+    }
+    isSame = isSame && note_crypt_check(&ctx, &data[length]);
+    explicit_bzero(&ctx, sizeof(ctx));
+    explicit_bzero(block, sizeof(block));
+    return isSame;
+}
+
+// check whether the content of the prepared record is the one currently stored for its note
+static bool heapIsSameContent(void)
+{
+    NvramNoteRecord_t *record = &pendingRecord.header;
+    uint16_t           offset = noteRecords[record->index].content;
+
+    return (offset != NO_RECORD)
+           && ((heapRecord(activeBank, offset)->flags & NOTES_HEAP_FLAG_COMPRESSED)
+            == (record->flags & NOTES_HEAP_FLAG_COMPRESSED))
+           && heapIsSameField(offset,
+                              true,
+                              &pendingRecord.bytes[sizeof(NvramNoteRecord_t) + record->titleLength],
+                              record->contentLength);
+}
+
+// append the pending record in the active bank with a single NVRAM write (space must have been
+// reserved), then apply it
+// if interrupted, the record is dropped at next start-up, because of its CRCs
+static void heapAppendRecord(void)
+{
+    NvramNoteRecord_t *record = &pendingRecord.header;
+    uint16_t           length = record->titleLength + record->contentLength;
+
+    // the record overwrites the data of the notes being received (if any)
+    staging.isActive   = false;
+    record->seq        = nextSeq++;
+    record->generation = (uint16_t) N_nvram.data.notesBanks[activeBank].generation;
+    record->dataCrc    = cx_crc16(&pendingRecord.bytes[sizeof(NvramNoteRecord_t)], length);
+    record->headerCrc  = heapHeaderCrc(record);
+    heapClearStaleRecord(heapTop + RECORD_SIZE(length));
+    nvram_write((void *) heapRecord(activeBank, heapTop),
+                pendingRecord.bytes,
+                sizeof(NvramNoteRecord_t) + length,
+                &writeStats);
+    heapApplyRecord(heapTop);
+    if (record->type == NOTES_HEAP_RECORD_UPDATE) {
+        noteInfos[record->index] = pendingInfo;
+        if (record->contentLength > 0) {
+            bitmap_set(knownInfos, record->index);
+        }
+    }
+    heapCountWrites(heapTop, RECORD_SIZE(length));
+    heapTop += RECORD_SIZE(length);
+    heapClearPendingRecord();
+}
+
+// append a record without data of the given type for the given note (space is always reserved
+// for it, as a note with a draft or being deleted does not need to be packed)
+static void heapAppendEmptyRecord(uint16_t index, uint8_t type)
+{
+    memset(&pendingRecord.header, 0, sizeof(NvramNoteRecord_t));
+    pendingRecord.header.index = index;
+    pendingRecord.header.type  = type;
+    heapReserve(0);
+    heapAppendRecord();
+}
+
+// close the open draft without modifying its note, by appending a record of its current title
+// (copied as stored, without decrypting it)
+static void heapCloseDraft(void)
+{
+    uint16_t offset = noteRecords[draftIndex].title;
+
+    if (offset == NO_RECORD) {
+        heapPrepareRecord(draftIndex, "", NULL);
+        heapSealRecord();
+    }
+    else {
+        heapPrepareRecord(draftIndex, NULL, NULL);
+        pendingRecord.header.titleLength = heapRecord(activeBank, offset)->titleLength;
+        pendingRecord.header.flags
+            = heapRecord(activeBank, offset)->flags & NOTES_HEAP_FLAG_ENCRYPTED_TITLE;
+        memcpy(&pendingRecord.bytes[sizeof(NvramNoteRecord_t)],
+               heapData(activeBank, offset),
+               pendingRecord.header.titleLength);
+    }
+    if (heapReserve(pendingRecord.header.titleLength)) {
+        heapAppendRecord();
+    }
+    heapClearPendingRecord();
+}
+
+// write the given bytes at the given position of the data of the note being received
+static void stagingWrite(uint16_t position, const void *bytes, uint16_t length)
+{
+    nvram_write(heapData(activeBank, staging.offset) + position, (void *) bytes, length, NULL);
+    heapCountWrites(staging.offset + sizeof(NvramNoteRecord_t) + position, length);
+}
+
+// get the position of the encrypted content of the note being received in its data
+static uint16_t stagingContentPosition(void)
+{
+    return staging.titleLength + 1 + NOTE_CRYPT_OVERHEAD;
+}
+
+// start encrypting the given field of the note being received, by writing a new nonce at the given
+// position of its data
+static bool stagingStartField(uint16_t position, uint8_t field)
+{
+    uint8_t nonce[NOTE_CRYPT_NONCE_LEN];
+
+    note_crypt_new_nonce(nonce);
+    stagingWrite(position, nonce, sizeof(nonce));
+    return note_crypt_start(&staging.crypt, staging.index, field, nonce);
+}
+
+// encrypt the given bytes of the field being received, and write them at the given position of the
+// data of its note
+static bool stagingWriteEncrypted(uint16_t position, const uint8_t *bytes, uint16_t length)
+{
+    bool ok = note_crypt_encrypt(&staging.crypt, bytes, fieldBuffer, length);
+
+    if (ok) {
+        stagingWrite(position, fieldBuffer, length);
+    }
+    explicit_bzero(fieldBuffer, length);
+    return ok;
+}
+
+// finish the field being received by writing its final '\0' and its tag at the given position of
+// the data of its note
+static bool stagingFinishField(uint16_t position)
+{
+    uint8_t end[1 + NOTE_CRYPT_TAG_LEN] = {0};
+
+    if (!note_crypt_encrypt(&staging.crypt, end, end, 1)) {
+        return false;
+    }
+    note_crypt_finish(&staging.crypt, &end[1]);
+    stagingWrite(position, end, sizeof(end));
+    return true;
+}
+
+// once the whole title of the note being received has been written, finish its field and start
+// the one of the content
+static bool stagingEndTitle(void)
+{
+    if (staging.nbReceived != staging.titleLength) {
+        return true;
+    }
+    return stagingFinishField(NOTE_CRYPT_NONCE_LEN + staging.titleLength)
+           && stagingStartField(stagingContentPosition(), NOTE_CRYPT_FIELD_CONTENT);
+}
+
+// check whether the given copy of the given contact slot is valid
+static bool contactIsValidCopy(uint16_t index, uint8_t copy)
+{
+    volatile NvramContactCopy_t *contactCopy = &N_nvram.data.contacts[index][copy];
+
+    return (contactCopy->crc
+            == cx_crc16((const void *) contactCopy, offsetof(NvramContactCopy_t, crc)));
+}
+
+// get the number of writes of the given contact slot
+static uint32_t contactGetWrites(uint16_t index)
+{
+    if (!contactIsValidCopy(index, contactCopies[index])) {
+        return 0;
+    }
+    return N_nvram.data.contacts[index][contactCopies[index]].seq;
+}
+
+// get the sequence number of the last mutation of the given contact slot
+static uint32_t contactGetSeq(uint16_t index)
+{
+    return N_nvram.data.contactSeqs[index][contactCopies[index]];
+}
+
+// find the current copy of each contact slot, and repair the bitmap of used contacts if a slot
+// has no valid copy
+// the next sequence number (found by scanning the notes heap) must also follow the ones of the
+// contacts
+static void contactsLoad(void)
+{
+    uint16_t i;
+
+    memcpy(usedContacts, (void *) N_nvram.data.usedContacts, sizeof(usedContacts));
+    for (i = 0; i < NB_MAX_CONTACTS; i++) {
+        bool isValid0 = contactIsValidCopy(i, 0);
+        bool isValid1 = contactIsValidCopy(i, 1);
+
+        contactCopies[i] = (isValid1
+                            && (!isValid0
+                                || (N_nvram.data.contacts[i][1].seq
+                                    > N_nvram.data.contacts[i][0].seq)))
+                               ? 1
+                               : 0;
+        if (contactGetSeq(i) >= nextSeq) {
+            nextSeq = contactGetSeq(i) + 1;
+        }
+        if (!isValid0 && !isValid1 && bitmap_test(usedContacts, i)) {
+            bitmap_clear(usedContacts, i);
+            nvm_write((void *) &N_nvram.data.usedContacts[i / 32],
+                      &usedContacts[i / 32],
+                      sizeof(uint32_t));
+        }
+    }
+    nbUsedContacts = bitmap_count(usedContacts, NB_MAX_CONTACTS);
+}
+
+// mark the given contact as used or not, by writing the single word of the bitmap holding it
+static void setContactUsed(uint16_t index, bool used)
+{
+    if (bitmap_test(usedContacts, index) == used) {
+        return;
+    }
+    if (used) {
+        bitmap_set(usedContacts, index);
+        nbUsedContacts++;
+    }
+    else {
+        bitmap_clear(usedContacts, index);
+        nbUsedContacts--;
+    }
+    nvram_write((void *) &N_nvram.data.usedContacts[index / 32],
+                &usedContacts[index / 32],
+                sizeof(uint32_t),
+                &writeStats);
+}
+
+// stamp the given copy of the given contact slot with the next sequence number (before writing it)
+static void contactStamp(uint16_t index, uint8_t copy)
+{
+    uint32_t seq = nextSeq++;
+
+    nvram_write(
+        (void *) &N_nvram.data.contactSeqs[index][copy], &seq, sizeof(uint32_t), &writeStats);
+}
+
+// reset the sequence numbers of both copies of the given contact slot
+static void contactResetSeqs(uint16_t index)
+{
+    uint32_t seqs[2] = {0, 0};
+
+    nvram_write_delta((void *) N_nvram.data.contactSeqs[index], seqs, sizeof(seqs), NULL);
+}
+
+// erase the public keys of both copies of the given contact slot
+static void contactResetKeys(uint16_t index)
+{
+    uint8_t keys[2][CONTACT_PUBLIC_KEY_LEN];
+
+    memset(keys, 0, sizeof(keys));
+    nvram_write_delta((void *) N_nvram.data.contactKeys[index], keys, sizeof(keys), NULL);
+}
+
+// write the given name, address and public key (NULL if unknown) in the copy of the given contact
+// slot which is not the current one, then make it the current one
+// if interrupted, the copy is not valid and the current one is kept
+static void contactWrite(uint16_t      index,
+                         const char    *name,
+                         const char    *address,
+                         const uint8_t *publicKey)
+{
+    NvramContactCopy_t copy;
+    uint8_t            key[CONTACT_PUBLIC_KEY_LEN];
+    uint8_t            newCopy = 1 - contactCopies[index];
+
+    memset(&copy, 0, sizeof(copy));
+    copy.seq = contactGetWrites(index) + 1;
+    strncpy((char *) copy.contact.name, name, CONTACT_NAME_LEN - 1);
+    strncpy((char *) copy.contact.address, address, CONTACT_ADDRESS_MAX_LEN - 1);
+    copy.crc = cx_crc16(&copy, offsetof(NvramContactCopy_t, crc));
+    memset(key, 0, sizeof(key));
+    if (publicKey != NULL) {
+        memcpy(key, publicKey, sizeof(key));
+    }
+    contactStamp(index, newCopy);
+    nvram_write_delta(
+        (void *) N_nvram.data.contactKeys[index][newCopy], key, sizeof(key), &writeStats);
+    nvram_write_delta(
+        (void *) &N_nvram.data.contacts[index][newCopy], &copy, sizeof(copy), &writeStats);
+    contactCopies[index] = newCopy;
+}
+
+// version 1 is converted in place: its notes are read before being overwritten by the contacts,
+// and its contacts before being overwritten by the other copies of contacts and the first bank
+_Static_assert(offsetof(Nvram_data_t, notesBanks[1]) >= sizeof(NvramDataV1_t),
+               "Second bank of notes heap overlaps data of version 1");
+_Static_assert(offsetof(Nvram_data_t, contacts[0][1]) >= offsetof(NvramDataV1_t, notes),
+               "Second copies of contacts overlap bit masks of version 1");
+_Static_assert(offsetof(Nvram_data_t, contacts[NVRAM_V1_NB_CONTACTS - 1][1])
+                       + sizeof(NvramContactCopy_t)
+                   <= offsetof(NvramDataV1_t, contacts),
+               "Converted contacts overlap contacts of version 1");
+_Static_assert(NVRAM_V1_NB_NOTES
+                       * RECORD_SIZE(NOTE_TITLE_MAX_LEN + NOTE_CONTENT_MAX_LEN
+                                     + 2 * NOTE_CRYPT_OVERHEAD)
+                   <= NOTES_HEAP_BANK_SIZE,
+               "Notes of version 1 do not fit in a bank of notes heap");
+_Static_assert((NVRAM_V1_NB_NOTES <= NB_MAX_NOTES) && (NVRAM_V1_NB_CONTACTS <= NB_MAX_CONTACTS),
+               "Not enough slots for version 1");
+
+// get the data of NVRAM, in version 1
+static volatile NvramDataV1_t *getDataV1(void)
+{
+    return (volatile NvramDataV1_t *) &N_nvram.data;
+}
+
+// step 1 of the conversion from version 1: append each used note as a record in the second bank
+// of the heap, one note at a time (the notes already found in the bank are not appended again)
+static void convertV1Notes(void)
+{
+    uint32_t generation = 1;
+    uint32_t seq        = 0;
+    uint16_t i;
+
+    // the second bank only becomes the active one when the header of the first one is erased
+    memset(heapPageWrites, 0, sizeof(heapPageWrites));
+    nvram_write_delta(
+        (void *) &N_nvram.data.notesBanks[1].generation, &generation, sizeof(uint32_t), NULL);
+    nvram_write_delta((void *) &N_nvram.data.notesBanks[1].seq, &seq, sizeof(uint32_t), NULL);
+    for (i = 0; i < 2; i++) {
+        nvram_write_delta((void *) N_nvram.data.notesBanks[1].pageWrites[i],
+                          heapPageWrites,
+                          sizeof(heapPageWrites),
+                          NULL);
+    }
+    heapResetNoteSeqs(1);
+    activeBank = 1;
+    heapScan();
+    for (i = 0; i < NVRAM_V1_NB_NOTES; i++) {
+        if (((getDataV1()->usedNotes & (1UL << i)) == 0) || bitmap_test(usedNotes, i)) {
+            continue;
+        }
+        // the strings of version 1 are not trusted to be terminated
+        strncpy(workingTitle, (const char *) getDataV1()->notes[i].title, NOTE_TITLE_MAX_LEN - 1);
+        workingTitle[NOTE_TITLE_MAX_LEN - 1] = '\0';
+        strncpy(workingContent,
+                (const char *) getDataV1()->notes[i].content,
+                NOTE_CONTENT_MAX_LEN - 1);
+        workingContent[NOTE_CONTENT_MAX_LEN - 1] = '\0';
+        heapPrepareRecord(i, workingTitle, workingContent);
+        heapSealRecord();
+        heapAppendRecord();
+    }
+}
+
+// step 2 of the conversion from version 1: write the contacts of version 1 in their second copy,
+// with a sequence number of 1 if used, and erase the sequence numbers of mutation and the public
+// keys of all contacts
+// the other copies are left untouched, as the first one can overlap the bit mask of used contacts
+// of version 1 and the next ones its contacts, which are read again if the step is interrupted
+static void convertV1Contacts(void)
+{
+    NvramContactCopy_t copy;
+    uint16_t           i;
+
+    for (i = 0; i < NVRAM_V1_NB_CONTACTS; i++) {
+        memset(&copy, 0, sizeof(copy));
+        if (getDataV1()->usedContacts & (1UL << i)) {
+            copy.seq = 1;
+            strncpy((char *) copy.contact.name,
+                    (const char *) getDataV1()->contacts[i].name,
+                    CONTACT_NAME_LEN - 1);
+            strncpy((char *) copy.contact.address,
+                    (const char *) getDataV1()->contacts[i].address,
+                    CONTACT_ADDRESS_MAX_LEN - 1);
+            copy.crc = cx_crc16(&copy, offsetof(NvramContactCopy_t, crc));
+        }
+        nvram_write_delta((void *) &N_nvram.data.contacts[i][1], &copy, sizeof(copy), NULL);
+    }
+    for (i = 0; i < NB_MAX_CONTACTS; i++) {
+        contactResetSeqs(i);
+        contactResetKeys(i);
+    }
+}
+
+// step 3 of the conversion from version 1: erase the first copies of the contacts, and the second
+// ones of the contacts not in version 1 (over the notes, the bit masks and the contacts of
+// version 1)
+static void convertV1ContactCopies(void)
+{
+    NvramContactCopy_t copy;
+    uint16_t           i;
+
+    memset(&copy, 0, sizeof(copy));
+    for (i = 0; i < NB_MAX_CONTACTS; i++) {
+        nvram_write_delta((void *) &N_nvram.data.contacts[i][0], &copy, sizeof(copy), NULL);
+        if (i >= NVRAM_V1_NB_CONTACTS) {
+            nvram_write_delta((void *) &N_nvram.data.contacts[i][1], &copy, sizeof(copy), NULL);
+        }
+    }
+}
+
+// step 4 of the conversion from version 1: build the bitmap of used contacts from their copies
+// (over the bit masks of version 1), then erase the header of the first bank of the heap (over
+// the contacts of version 1), so that the second one becomes the active one
+static void convertV1Finish(void)
+{
+    uint32_t generation = 0;
+    uint32_t seq        = 0;
+    uint16_t i;
+
+    memset(usedContacts, 0, sizeof(usedContacts));
+    for (i = 0; i < NB_MAX_CONTACTS; i++) {
+        if (contactIsValidCopy(i, 1) && (N_nvram.data.contacts[i][1].seq != 0)) {
+            bitmap_set(usedContacts, i);
+        }
+    }
+    nvram_write_delta(
+        (void *) N_nvram.data.usedContacts, usedContacts, sizeof(usedContacts), NULL);
+    memset(heapPageWrites, 0, sizeof(heapPageWrites));
+    for (i = 0; i < 2; i++) {
+        nvram_write_delta((void *) N_nvram.data.notesBanks[0].pageWrites[i],
+                          heapPageWrites,
+                          sizeof(heapPageWrites),
+                          NULL);
+    }
+    nvram_write_delta((void *) &N_nvram.data.notesBanks[0].seq, &seq, sizeof(uint32_t), NULL);
+    nvram_write_delta(
+        (void *) &N_nvram.data.notesBanks[0].generation, &generation, sizeof(uint32_t), NULL);
+}
+
+static const ConversionStep_t conversionStepsV1[] = {
+    convertV1Notes,
+    convertV1Contacts,
+    convertV1ContactCopies,
+    convertV1Finish,
+};
+
+// conversions from all supported older versions, each of them directly to the current version
+static const Conversion_t conversions[] = {
+    {1, sizeof(conversionStepsV1) / sizeof(conversionStepsV1[0]), conversionStepsV1},
+    {0, 0, NULL},
+};
+
+// initialize NVRAM from scratch, by only writing what is read before being allocated: the
+// settings, the bitmap of used contacts, the sequence numbers of the contacts and the headers of
+// the heap banks (with the sequence numbers of the notes of the first one)
+// contact copies and heap records are left undefined, as they are only used once valid, and the
+// first bank gets a new generation, so that the records left in it are not valid
+// the header is written last, so that an interrupted init is restarted
+static void nvramReset(void)
+{
+    NvramSettings_t settings;
+    uint32_t        generation = 0;
+    uint32_t        seq        = 0;
+    uint8_t         i;
+
+    memset(&settings, 0, sizeof(settings));
+    nvram_write_delta((void *) &N_nvram.data.settings, &settings, sizeof(settings), NULL);
+    memset(usedContacts, 0, sizeof(usedContacts));
+    nvram_write_delta(
+        (void *) N_nvram.data.usedContacts, usedContacts, sizeof(usedContacts), NULL);
+    for (i = 0; i < NB_MAX_CONTACTS; i++) {
+        contactResetSeqs(i);
+    }
+    // the page writes stored in the first bank are added to the ones of the second bank when it is
+    // packed, which writes all its header
+    memset(heapPageWrites, 0, sizeof(heapPageWrites));
+    for (i = 0; i < 2; i++) {
+        nvram_write_delta((void *) N_nvram.data.notesBanks[0].pageWrites[i],
+                          heapPageWrites,
+                          sizeof(heapPageWrites),
+                          NULL);
+    }
+    nvram_write_delta((void *) &N_nvram.data.notesBanks[0].seq, &seq, sizeof(uint32_t), NULL);
+    heapResetNoteSeqs(0);
+    for (i = 0; i < 2; i++) {
+        if (N_nvram.data.notesBanks[i].generation >= generation) {
+            generation = N_nvram.data.notesBanks[i].generation + 1;
+        }
+    }
+    if (generation == 0) {
+        generation = 1;
+    }
+    seq = 0;
+    nvram_write_delta(
+        (void *) &N_nvram.data.notesBanks[1].generation, &seq, sizeof(uint32_t), NULL);
+    nvram_write_delta(
+        (void *) &N_nvram.data.notesBanks[0].generation, &generation, sizeof(uint32_t), NULL);
+    nvram_init();
+}
+
+// get the first step of the given conversion not completed yet, from the valid copies of the
+// conversion state
+static uint8_t conversionGetStep(const Conversion_t *conversion)
+{
+    uint8_t step = 0;
+    uint8_t i;
+
+    for (i = 0; i < 2; i++) {
+        volatile NvramConversionCopy_t *copy = &N_nvram.data.conversion.copies[i];
+
+        if ((copy->check == ~copy->state)
+            && ((copy->state & CONVERSION_STATE_MASK)
+                == CONVERSION_STATE(conversion->fromVersion, 0))
+            && ((copy->state & ~CONVERSION_STATE_MASK) <= conversion->nbSteps)
+            && ((copy->state & ~CONVERSION_STATE_MASK) > step)) {
+            step = copy->state & ~CONVERSION_STATE_MASK;
+        }
+    }
+    return step;
+}
+
+// record that the steps of the given conversion before the given one are completed, in the copy
+// of the conversion state which is not the current one
+// if interrupted, the copy is not valid, and the previous step is run again
+static void conversionSetStep(const Conversion_t *conversion, uint8_t step)
+{
+    NvramConversionCopy_t copy;
+
+    copy.state = CONVERSION_STATE(conversion->fromVersion, step);
+    copy.check = ~copy.state;
+    nvm_write((void *) &N_nvram.data.conversion.copies[step % 2], &copy, sizeof(copy));
+}
+
+// convert NVRAM from its older version, with the steps of the matching conversion, resuming from
+// the step which was interrupted (if any), then write the header with the current version
+// each step converts the data a note or a contact at a time, so that RAM usage is bounded, and
+// the conversion state is written after each of them
+static void nvramConvert(void)
+{
+    uint8_t             version    = nvram_get_struct_version();
+    const Conversion_t *conversion = (const Conversion_t *) PIC(conversions);
+    uint8_t             step;
+
+    while ((conversion->steps != NULL) && (conversion->fromVersion != version)) {
+        conversion++;
+    }
+    if (conversion->steps == NULL) {
+        // no conversion from this version
+        nvramReset();
+        return;
+    }
+    for (step = conversionGetStep(conversion); step < conversion->nbSteps; step++) {
+        const ConversionStep_t *steps = (const ConversionStep_t *) PIC(conversion->steps);
+
+        ((ConversionStep_t) PIC(steps[step]))();
+        conversionSetStep(conversion, step + 1);
+    }
+    nvram_init();
+}
+
+// start the hash of a leaf of the Merkle tree of the store, with its kind and index
+static void storeLeafInit(cx_sha256_t *leaf, uint8_t kind, uint16_t index)
+{
+    uint8_t header[3] = {kind, index >> 8, index & 0xFF};
+
+    merkle_leaf_init(leaf);
+    merkle_leaf_update(leaf, header, sizeof(header));
+}
+
+// add a field to the hash of a leaf of the Merkle tree of the store, prefixed by its length
+static void storeLeafAddField(cx_sha256_t *leaf, const void *field, uint16_t length)
+{
+    uint8_t header[2] = {length >> 8, length & 0xFF};
+
+    merkle_leaf_update(leaf, header, sizeof(header));
+    merkle_leaf_update(leaf, field, length);
+}
+
+// compute the hash of the leaf of the Merkle tree of the store for the given used slot (notes,
+// then contacts from NB_MAX_NOTES), the given buffer being used to decrypt the title then the
+// content of a note
+static void storeLeafBuild(cx_sha256_t *leaf, uint16_t slot, char *content)
+{
+    if (slot < NB_MAX_NOTES) {
+        storeLeafInit(leaf, STORE_LEAF_NOTE, slot);
+        getNoteTitle(slot, content);
+        storeLeafAddField(leaf, content, strlen(content));
+        getNoteContent(slot, content);
+        storeLeafAddField(leaf, content, strlen(content));
+    }
+    else {
+        uint16_t                 index = slot - NB_MAX_NOTES;
+        volatile NvramContact_t *contact;
+
+        contact = &N_nvram.data.contacts[index][contactCopies[index]].contact;
+        storeLeafInit(leaf, STORE_LEAF_CONTACT, index);
+        storeLeafAddField(
+            leaf, (const void *) contact->name, strlen((const char *) contact->name));
+        storeLeafAddField(
+            leaf, (const void *) contact->address, strlen((const char *) contact->address));
+    }
+}
+
+// check whether the given slot (notes, then contacts from NB_MAX_NOTES) is used
+static bool storeIsSlotUsed(uint16_t slot)
+{
+    if (slot < NB_MAX_NOTES) {
+        return bitmap_test(usedNotes, slot);
+    }
+    return bitmap_test(usedContacts, slot - NB_MAX_NOTES);
+}
+
+// get the sequence number of the last mutation of the given slot (notes, then contacts from
+// NB_MAX_NOTES), 0 if never used
+static uint32_t storeGetSlotSeq(uint16_t slot)
+{
+    if (slot >= NB_MAX_NOTES) {
+        return contactGetSeq(slot - NB_MAX_NOTES);
+    }
+    return noteSeqs[slot];
+}
+
+// get the first used slot exported by app_notesExport(), at or after the given one
+static uint16_t exportNextSlot(uint16_t slot)
+{
+    if (slot < NB_MAX_NOTES) {
+        slot = bitmap_next_set(usedNotes, NB_MAX_NOTES, slot);
+        if (slot < NB_MAX_NOTES) {
+            return slot;
+        }
+    }
+    return NB_MAX_NOTES + bitmap_next_set(usedContacts, NB_MAX_CONTACTS, slot - NB_MAX_NOTES);
+}
+
+// write the record exported by app_notesExport() for the given used slot in the given buffer
+// (large enough for a full note, with the final '\0' of its content), and return its length
+static uint16_t exportRecord(uint16_t slot, uint8_t *record)
+{
+    uint16_t length = 4;
+
+    // record = slot (2) || length of body (2) || body
+    record[0] = slot >> 8;
+    record[1] = slot & 0xFF;
+    if (slot < NB_MAX_NOTES) {
+        // body = sequence number (4) || flags (1) || title length (1) || title || content
+        uint32_t seq         = noteSeqs[slot];
+        uint16_t flagsOffset = length + 4;
+        bool     isAuthentic;
+
+        record[length++] = seq >> 24;
+        record[length++] = (seq >> 16) & 0xFF;
+        record[length++] = (seq >> 8) & 0xFF;
+        record[length++] = seq & 0xFF;
+        length += 2;
+        // the fields are decrypted in place, a field which is not authentic being exported empty
+        isAuthentic         = getNoteTitle(slot, (char *) &record[length]);
+        record[length - 1]  = strlen((const char *) &record[length]);
+        length += record[length - 1];
+        isAuthentic         = getNoteContent(slot, (char *) &record[length]) && isAuthentic;
+        length += strlen((const char *) &record[length]);
+        record[flagsOffset] = (noteIsIntact(slot) && isAuthentic) ? 0 : EXPORT_FLAG_CORRUPTED;
+    }
+    else {
+        // body = number of writes (4) || name length (1) || name || address
+        uint16_t                 index    = slot - NB_MAX_NOTES;
+        uint32_t                 nbWrites = contactGetWrites(index);
+        volatile NvramContact_t *contact;
+        uint8_t                  nameLength;
+        uint8_t                  addressLength;
+
+        contact       = &N_nvram.data.contacts[index][contactCopies[index]].contact;
+        nameLength    = strlen((const char *) contact->name);
+        addressLength = strlen((const char *) contact->address);
+
+        record[length++] = nbWrites >> 24;
+        record[length++] = (nbWrites >> 16) & 0xFF;
+        record[length++] = (nbWrites >> 8) & 0xFF;
+        record[length++] = nbWrites & 0xFF;
+        record[length++] = nameLength;
+        memcpy(&record[length], (const void *) contact->name, nameLength);
+        length += nameLength;
+        memcpy(&record[length], (const void *) contact->address, addressLength);
+        length += addressLength;
+    }
+    record[2] = (length - 4) >> 8;
+    record[3] = (length - 4) & 0xFF;
+    return length;
+}
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void app_notesInit(void)
+{
+    // If the NVRAM content is not initialized or of a too old version, let's init it from scratch
+    if (!nvram_is_initalized() || (nvram_get_struct_version() < NVRAM_FIRST_SUPPORTED_VERSION)) {
+        nvramReset();
+        storageLoaded = false;
+    }
+    else if (nvram_get_struct_version() != NVRAM_STRUCT_VERSION) {
+        // if the version is not current, let's convert it (or reset NVRAM if it has no
+        // conversion, like the layouts of development builds)
+        nvramConvert();
+        storageLoaded = false;
+    }
+    // NVRAM is scanned only once, then the RAM tables are maintained by modifications
+    if (!storageLoaded) {
+        heapLoad();
+        noteInfosLoad();
+        contactsLoad();
+        storageLoaded = true;
+        // a draft still open at start-up means that the modifications of its note have been lost
+        if (draftIndex != NO_DRAFT) {
+            lostDraftIndex = draftIndex;
+            heapCloseDraft();
+        }
+    }
+    // going back to the home page saves the note being edited
+    app_notesFlushNote();
+    // compact in advance if the active bank is almost full, so that saving a note stays fast
+    if (((NOTES_HEAP_BANK_SIZE - heapTop) < COMPACTION_THRESHOLD)
+        && (heapGetLiveSize() < heapTop)) {
+        memset(&writeStats, 0, sizeof(writeStats));
+        heapCompact(0);
+    }
+
+    currentNote.title      = workingTitle;
+    currentNote.content    = workingContent;
+    currentContact.name    = workingName;
+    currentContact.address = workingAddress;
+}
+
+/**
+ * @brief Get the number of used Notes, and set the given array with all found used notes
+ *
+ * @note the content of the notes is not retrieved, use @ref app_notesGetNote() to get it
+ *
+ * @param noteArray array of notes to be filled (if NULL, only the number of slots is retrieved)
+ * @return number of Notes (number of used elements in noteArray)
+ */
+uint16_t app_notesGetAll(Note_t noteArray[NB_MAX_NOTES])
+{
+    if (noteArray != NULL) {
+        return app_notesGetRange(0, nbUsedNotes, noteArray);
+    }
+    return nbUsedNotes;
+}
+
+/**
+ * @brief Get the used Notes of the given range, in the order of their indexes
+ *
+ * @note the content of the notes is neither retrieved nor decrypted, use @ref app_notesGetNote()
+ * to get it
+ * @note the data of each note are checked against their CRCs at its first access only, and the
+ * title of a corrupted note (or of a note whose title is not authentic) is replaced by a
+ * placeholder
+ *
+ * @param first rank of the first used note to get (0 for the first used note)
+ * @param nbNotes max number of notes to get
+ * @param noteArray array of at least nbNotes notes to be filled, the title of each note being
+ * decrypted in its buffer (of @ref NOTE_TITLE_MAX_LEN bytes)
+ * @return number of Notes (number of used elements in noteArray)
+ */
+uint16_t app_notesGetRange(uint16_t first, uint16_t nbNotes, Note_t *noteArray)
+{
+    uint16_t nbFound = 0;
+    uint16_t i;
+
+    // the first note is found by counting set bits a word at a time, then the next ones by
+    // skipping cleared bits
+    for (i = bitmap_select(usedNotes, NB_MAX_NOTES, first);
+         (i < NB_MAX_NOTES) && (nbFound < nbNotes);
+         i = bitmap_next_set(usedNotes, NB_MAX_NOTES, i + 1)) {
+        noteArray[nbFound].index = i;
+        if (!noteIsIntact(i) || !getNoteTitle(i, noteArray[nbFound].title)) {
+            strcpy(noteArray[nbFound].title, CORRUPTED_NOTE_TITLE);
+        }
+        noteArray[nbFound].content = NULL;
+        nbFound++;
+    }
+    return nbFound;
+}
+
+/**
+ * @brief Get note Title and Content at the given index
+ *
+ * @note the data of the note are checked against their CRCs at the first access only
+ *
+ * @param index index to the note to be retrieved
+ * @param note structure to fill with info (title and content are decrypted in its buffers, of
+ * @ref NOTE_TITLE_MAX_LEN and @ref NOTE_CONTENT_MAX_LEN bytes)
+ * @return >= 0 if OK, < 0 if the note is not used, or is corrupted or not authentic (its buffers
+ * are then filled with what can be read of it)
+ */
+int app_notesGetNote(uint16_t index, Note_t *note)
+{
+    // the buffers of the note being edited may be overwritten
+    app_notesFlushNote();
+    if ((index < NB_MAX_NOTES) && bitmap_test(usedNotes, index)) {
+        bool isAuthentic;
+
+        note->index = index;
+        isAuthentic = getNoteTitle(index, note->title);
+        isAuthentic = getNoteContent(index, note->content) && isAuthentic;
+        return (noteIsIntact(index) && isAuthentic) ? 0 : -1;
+    }
+    return -1;
+}
+
+/**
+ * @brief Get the metadata of the note at the given index, without reading it from NVRAM
+ *
+ * @note the metadata of the content are only known once the note has been decrypted by
+ * @ref app_notesGetNote() (or written) in the session
+ *
+ * @param index index of the note
+ * @return metadata of the note, or NULL if not used or not known yet
+ */
+const NoteInfo_t *app_notesGetNoteInfo(uint16_t index)
+{
+    if ((index < NB_MAX_NOTES) && bitmap_test(usedNotes, index) && bitmap_test(knownInfos, index)) {
+        return &noteInfos[index];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Add the new note in any available slot, with a single record
+ *
+ * @param title title to be applied (max @ref NOTE_TITLE_MAX_LEN bytes)
+ * @param content content to be applied (max @ref NOTE_CONTENT_MAX_LEN bytes
+ * @return index of the added note, or <0 if error (no available slot or not enough space)
+ */
+int app_notesAddNote(const char *title, const char *content)
+{
+    uint16_t i = bitmap_next_clear(usedNotes, NB_MAX_NOTES, 0);
+
+    memset(&writeStats, 0, sizeof(writeStats));
+    if (i == NB_MAX_NOTES) {
+        // no available slot
+        return -1;
+    }
+    heapPrepareRecord(i, title, content);
+    if (!heapReserve(heapSealRecord())) {
+        // not enough space in heap
+        heapClearPendingRecord();
+        return -1;
+    }
+    heapAppendRecord();
+    return i;
+}
+
+/**
+ * @brief Modify the note at the given index, by appending a record with its modified fields in
+ * the heap
+ *
+ * @param index index of the note to modify
+ * @param title title to be applied (max @ref NOTE_TITLE_MAX_LEN bytes)
+ * @param content content to be applied (max @ref NOTE_CONTENT_MAX_LEN bytes
+ * @return number of bytes actually written in NVRAM (>= 0) if OK, < 0 if not enough space
+ */
+int app_notesModifyNote(uint16_t index, const char *title, const char *content)
+{
+    // unchanged fields are not written at all (they are compared once decrypted, and content in
+    // its encoded form, only if its metadata do not already tell that it has changed), unless the
+    // note is corrupted, so that it is repaired
+    bool isIntact        = noteIsIntact(index);
+    bool isTitleModified = !isIntact || (strlen(title) != noteInfos[index].titleLength)
+                           || !heapIsSameField(noteRecords[index].title,
+                                               false,
+                                               (const uint8_t *) title,
+                                               noteInfos[index].titleLength + 1);
+
+    memset(&writeStats, 0, sizeof(writeStats));
+    heapPrepareRecord(index, isTitleModified ? title : NULL, content);
+    if (isIntact
+        && (!bitmap_test(knownInfos, index)
+            || ((pendingInfo.contentLength == noteInfos[index].contentLength)
+                && (pendingInfo.contentHash == noteInfos[index].contentHash)))
+        && heapIsSameContent()) {
+        pendingRecord.header.contentLength = 0;
+    }
+    if ((pendingRecord.header.titleLength == 0) && (pendingRecord.header.contentLength == 0)) {
+        heapClearPendingRecord();
+        return 0;
+    }
+    if (!heapReserve(heapSealRecord())) {
+        heapClearPendingRecord();
+        return -1;
+    }
+    heapAppendRecord();
+    return writeStats.nbBytes;
+}
+
+/**
+ * @brief Delete the note at the given slot, by appending a deletion record in the heap
+ *
+ * @param index index of the note to delete
+ * @return >= 0 if OK
+ */
+int app_notesDeleteNote(uint16_t index)
+{
+    memset(&writeStats, 0, sizeof(writeStats));
+    // the modifications of the note being edited are not saved if it is deleted
+    if (editCache.isDirty && (editCache.index == index)) {
+        editCache.isDirty = false;
+    }
+    // the note is not live anymore, so there is always enough space for the deletion record (and
+    // a compaction to make room for it already drops the note)
+    setNoteUsed(index, false);
+    heapAppendEmptyRecord(index, NOTES_HEAP_RECORD_DELETE);
+    return 0;
+}
+
+/**
+ * @brief Modify the note at the given index in RAM only, its modifications being saved in NVRAM
+ * in a single record when flushed, when another note is modified, or when enough bytes have been
+ * edited (see @ref NOTES_EDIT_MAX_DIRTY_BYTES)
+ *
+ * @note a draft record is appended when the note starts being modified, so that modifications
+ * lost by a power loss are detected at next start-up
+ *
+ * @param index index of the note to modify
+ * @param title title to be applied (its buffer must be kept until flushed)
+ * @param content content to be applied (its buffer must be kept until flushed)
+ * @param nbEditedBytes number of bytes edited by this modification
+ * @return >= 0 if OK, < 0 if there would not be enough space to save the note
+ */
+int app_notesUpdateNote(uint16_t    index,
+                        const char *title,
+                        const char *content,
+                        uint16_t    nbEditedBytes)
+{
+    uint16_t length = strlen(title) + 1 + strlen(content) + 1 + 2 * NOTE_CRYPT_OVERHEAD;
+
+    // the raw size of the note is an upper bound of the size of its record once saved
+    if ((heapGetLiveSize() + RECORD_SIZE(0) + RECORD_SIZE(length)) > NOTES_HEAP_BANK_SIZE) {
+        return -1;
+    }
+    if (editCache.isDirty && (editCache.index != index)) {
+        app_notesFlushNote();
+    }
+    if (!editCache.isDirty) {
+        memset(&writeStats, 0, sizeof(writeStats));
+        heapAppendEmptyRecord(index, NOTES_HEAP_RECORD_DRAFT);
+        editCache.index        = index;
+        editCache.nbDirtyBytes = 0;
+        editCache.isDirty      = true;
+    }
+    editCache.title   = title;
+    editCache.content = content;
+    editCache.nbDirtyBytes += nbEditedBytes;
+    if (editCache.nbDirtyBytes >= NOTES_EDIT_MAX_DIRTY_BYTES) {
+        return app_notesFlushNote();
+    }
+    return 0;
+}
 
 /**
- * @file app_notes_utils.c
- * @brief non-UI functions to manages notes (get/add) in Note App
+ * @brief Save the modifications of the note being edited (if any) in NVRAM, with a single record
  *
+ * @return number of bytes actually written in NVRAM (>= 0) if OK, < 0 if not enough space
  */
+int app_notesFlushNote(void)
+{
+    int status;
 
-/*********************
- *      INCLUDES
- *********************/
-#include <string.h>
-#include "nbgl_debug.h"
-#include "nbgl_use_case.h"
-#include "app_notes.h"
-#include "nvram_struct.h"
-#include "os_nvm.h"
-
-/*********************
- *      DEFINES
- *********************/
-
-/**********************
- *      TYPEDEFS
- **********************/
-
-/**********************
- *  STATIC VARIABLES
- **********************/
-static char workingTitle[NOTE_TITLE_MAX_LEN];
-static char workingContent[NOTE_CONTENT_MAX_LEN];
-static char workingName[CONTACT_NAME_LEN];
-static char workingAddress[CONTACT_ADDRESS_MAX_LEN];
-static bool isUnlocked = false;
+    if (!editCache.isDirty) {
+        return 0;
+    }
+    editCache.isDirty = false;
+    status            = app_notesModifyNote(editCache.index, editCache.title, editCache.content);
+    // if the note is finally not modified, its draft still has to be closed
+    if ((status == 0) && (draftIndex != NO_DRAFT)) {
+        heapCloseDraft();
+    }
+    return status;
+}
 
-/**********************
- *      VARIABLES
- **********************/
-Note_t    currentNote;
-Contact_t currentContact;
+/**
+ * @brief Announce the reception of several notes, by reserving space for all of them in the active
+ * bank of the heap
+ *
+ * @note the notes are cancelled by any other modification of the notes before being committed
+ *
+ * @param nbNotes number of notes
+ * @param totalLength total length of their titles and contents, without final '\0'
+ * @return >= 0 if OK, < 0 if there are not enough available slots or not enough space
+ */
+int app_notesStagingBegin(uint16_t nbNotes, uint16_t totalLength)
+{
+    // each record needs its header, two '\0', the encryption of two fields and at most 3 bytes of
+    // padding
+    uint32_t size
+        = (uint32_t) nbNotes * (sizeof(NvramNoteRecord_t) + 2 + 2 * NOTE_CRYPT_OVERHEAD + 3)
+          + totalLength;
 
-/**********************
- *  STATIC PROTOTYPES
- **********************/
+    staging.isActive = false;
+    if ((nbNotes == 0) || ((nbUsedNotes + nbNotes) > NB_MAX_NOTES) || !heapReserveSize(size)) {
+        return -1;
+    }
+    staging.start       = heapTop;
+    staging.end         = heapTop + size;
+    staging.offset      = heapTop;
+    staging.index       = bitmap_next_clear(usedNotes, NB_MAX_NOTES, 0);
+    staging.nbNotes     = nbNotes;
+    staging.nbStaged    = 0;
+    staging.nbBytes     = 0;
+    staging.isActive    = true;
+    staging.isBatch     = true;
+    staging.isReceiving = false;
+    // the sequence numbers of all the notes are reserved, as contacts may be modified meanwhile
+    staging.firstSeq = nextSeq;
+    nextSeq += nbNotes;
+    return 0;
+}
 
-/**********************
- *   GLOBAL FUNCTIONS
- **********************/
+/**
+ * @brief Start receiving a note, after the previous one of the announced notes, or alone (space is
+ * then reserved for it)
+ *
+ * @param titleLength length of the title, without final '\0'
+ * @param contentLength length of the content, without final '\0'
+ * @return >= 0 if OK, < 0 if there is no available slot or not enough space
+ */
+int app_notesStagingStart(uint16_t titleLength, uint16_t contentLength)
+{
+    if ((titleLength >= NOTE_TITLE_MAX_LEN) || (contentLength >= NOTE_CONTENT_MAX_LEN)) {
+        staging.isActive = false;
+        return -1;
+    }
+    if (!staging.isActive || !staging.isBatch) {
+        if (app_notesStagingBegin(1, titleLength + contentLength) < 0) {
+            return -1;
+        }
+        staging.isBatch = false;
+    }
+    else if (staging.isReceiving || (staging.nbStaged == staging.nbNotes)
+             || ((staging.offset
+                  + RECORD_SIZE(titleLength + 1 + contentLength + 1 + 2 * NOTE_CRYPT_OVERHEAD))
+                 > staging.end)) {
+        return -1;
+    }
+    if (staging.nbStaged > 0) {
+        staging.index = bitmap_next_clear(usedNotes, NB_MAX_NOTES, staging.index + 1);
+    }
+    cx_sha256_init_no_throw(&staging.hash);
+    staging.titleLength   = titleLength;
+    staging.contentLength = contentLength;
+    staging.nbReceived    = 0;
+    staging.isReceiving   = true;
+    if (!stagingStartField(0, NOTE_CRYPT_FIELD_TITLE) || !stagingEndTitle()) {
+        staging.isActive = false;
+        return -1;
+    }
+    return 0;
+}
 
-void app_notesInit(void)
+/**
+ * @brief Encrypt the next bytes of the note being received (its title then its content, without
+ * their final '\0') directly in NVRAM, and add them to its hash
+ *
+ * @param bytes bytes to write
+ * @param length number of bytes
+ * @return >= 0 if OK, < 0 if no note is being received or if there are too many bytes
+ */
+int app_notesStagingAppend(const uint8_t *bytes, uint16_t length)
 {
-    static Nvram_data_t storage = {0};
+    if (!staging.isActive || !staging.isReceiving
+        || (length > (staging.titleLength + staging.contentLength - staging.nbReceived))) {
+        return -1;
+    }
+    cx_hash_no_throw(&staging.hash.header, 0, bytes, length, NULL, 0);
+    // the bytes of the title are written after its nonce (and kept in plaintext to be displayed),
+    // the ones of the content after the end of the title and the nonce of the content
+    if (staging.nbReceived < staging.titleLength) {
+        uint16_t nbTitleBytes = staging.titleLength - staging.nbReceived;
 
-    // If the NVRAM content is not initialized or of a too old version, let's init it from scratch
-    if (!nvram_is_initalized() || (nvram_get_struct_version() < NVRAM_FIRST_SUPPORTED_VERSION)) {
-        nvram_init();
-        nvm_write((void *) &N_nvram.data, (void *) &storage, sizeof(Nvram_data_t));
+        if (nbTitleBytes > length) {
+            nbTitleBytes = length;
+        }
+        memcpy(&staging.title[staging.nbReceived], bytes, nbTitleBytes);
+        if (!stagingWriteEncrypted(
+                NOTE_CRYPT_NONCE_LEN + staging.nbReceived, bytes, nbTitleBytes)) {
+            staging.isActive = false;
+            return -1;
+        }
+        staging.nbReceived += nbTitleBytes;
+        bytes += nbTitleBytes;
+        length -= nbTitleBytes;
+        if (!stagingEndTitle()) {
+            staging.isActive = false;
+            return -1;
+        }
     }
-    else if (nvram_get_struct_version() < NVRAM_STRUCT_VERSION) {
-        // if the version is supported and not current, let's convert it
+    if (length > 0) {
+        if (!stagingWriteEncrypted(stagingContentPosition() + NOTE_CRYPT_NONCE_LEN
+                                       + (staging.nbReceived - staging.titleLength),
+                                   bytes,
+                                   length)) {
+            staging.isActive = false;
+            return -1;
+        }
+        staging.nbReceived += length;
     }
-
-    currentNote.title      = workingTitle;
-    currentNote.content    = workingContent;
-    currentContact.name    = workingName;
-    currentContact.address = workingAddress;
+    return 0;
 }
 
 /**
- * @brief Get the number of used Notes, and set the given array with all found used notes
+ * @brief Check that the note being received is complete, and matches the given hash, then write
+ * the header of its record (except for the first note, whose header commits all the notes)
  *
- * @param noteArray array of notes to be filled (if NULL, only the number of slots is retrieved)
- * @return number of Notes (number of used elements in noteArray)
+ * @param hash expected SHA-256 of the title then the content (without their final '\0')
+ * @param note structure filled with the title of the note (valid until the next note is started),
+ * its content being only stored encrypted
+ * @return number of announced notes still to be received if OK, -1 if some bytes have not been
+ * received, -2 if the hash does not match (all the notes are then cancelled)
  */
-uint8_t app_notesGetAll(Note_t noteArray[NB_MAX_NOTES])
+int app_notesStagingFinish(const uint8_t *hash, Note_t *note)
 {
-    uint8_t i;
-    uint8_t nbUsedSlots = 0;
-    // try to parse all slots
-    for (i = 0; i < NB_MAX_NOTES; i++) {
-        if (N_nvram.data.usedNotes & (1 << i)) {
-            if (noteArray != NULL) {
-                noteArray[nbUsedSlots].index   = i;
-                noteArray[nbUsedSlots].title   = (char *) N_nvram.data.notes[i].title;
-                noteArray[nbUsedSlots].content = (char *) N_nvram.data.notes[i].content;
-            }
-            nbUsedSlots++;
-        }
+    NvramNoteRecord_t record;
+    uint8_t           digest[CX_SHA256_SIZE];
+    uint8_t          *data = heapData(activeBank, staging.offset);
+    uint16_t length = staging.titleLength + 1 + staging.contentLength + 1 + 2 * NOTE_CRYPT_OVERHEAD;
+
+    if (!staging.isActive || !staging.isReceiving
+        || (staging.nbReceived != (staging.titleLength + staging.contentLength))) {
+        return -1;
     }
-    return nbUsedSlots;
+    cx_hash_no_throw(&staging.hash.header, CX_LAST, NULL, 0, digest, sizeof(digest));
+    if (memcmp(digest, hash, sizeof(digest)) != 0) {
+        staging.isActive = false;
+        explicit_bzero(&staging.crypt, sizeof(staging.crypt));
+        return -2;
+    }
+    if (!stagingFinishField(stagingContentPosition() + NOTE_CRYPT_NONCE_LEN
+                            + staging.contentLength)) {
+        staging.isActive = false;
+        return -1;
+    }
+    memset(&record, 0, sizeof(record));
+    record.seq           = staging.firstSeq + staging.nbStaged;
+    record.generation    = (uint16_t) N_nvram.data.notesBanks[activeBank].generation;
+    record.index         = staging.index;
+    record.type          = NOTES_HEAP_RECORD_UPDATE;
+    record.titleLength   = staging.titleLength + 1 + NOTE_CRYPT_OVERHEAD;
+    record.contentLength = staging.contentLength + 1 + NOTE_CRYPT_OVERHEAD;
+    record.flags         = NOTES_HEAP_FLAG_ENCRYPTED_TITLE | NOTES_HEAP_FLAG_ENCRYPTED_CONTENT;
+    // the CRC is the one of what has actually been written
+    record.dataCrc   = cx_crc16(data, length);
+    record.headerCrc = heapHeaderCrc(&record);
+    if (staging.nbStaged == 0) {
+        memcpy(&staging.firstRecord, &record, sizeof(record));
+    }
+    else {
+        nvram_write((void *) heapRecord(activeBank, staging.offset), &record, sizeof(record), NULL);
+        heapCountWrites(staging.offset, sizeof(record));
+    }
+    staging.offset += RECORD_SIZE(length);
+    staging.nbStaged++;
+    staging.nbBytes += staging.titleLength + staging.contentLength;
+    staging.isReceiving                = false;
+    staging.title[staging.titleLength] = '\0';
+    note->title                        = staging.title;
+    note->content                      = NULL;
+    return staging.nbNotes - staging.nbStaged;
 }
 
 /**
- * @brief Get note Title and Content at the given index
+ * @brief Get the number of notes received and checked, waiting to be committed
  *
- * @param index index to the note to be retrieved
- * @param note structure to fill with info
- * @return >= 0 if OK
+ * @param nbBytes total length of their titles and contents, without final '\0'
+ * @return number of notes
  */
-int app_notesGetNote(uint8_t index, Note_t *note)
+uint16_t app_notesStagingGetSummary(uint16_t *nbBytes)
 {
-    if (N_nvram.data.usedNotes & (1 << index)) {
-        note->index   = index;
-        note->title   = (char *) N_nvram.data.notes[index].title;
-        note->content = (char *) N_nvram.data.notes[index].content;
+    if (!staging.isActive) {
+        *nbBytes = 0;
         return 0;
     }
-    return -1;
+    *nbBytes = staging.nbBytes;
+    return staging.nbStaged;
 }
 
 /**
- * @brief Add the new note in any available slot
+ * @brief Save all the received notes at once, by writing the header of the first record (the
+ * other records are already written)
  *
- * @param title title to be applied (max @ref NOTE_TITLE_MAX_LEN bytes)
- * @param content content to be applied (max @ref NOTE_CONTENT_MAX_LEN bytes
- * @return index of the added note, or <0 if error
+ * @return index of the first added note, or < 0 if the announced notes have not all been received,
+ * or have been cancelled
  */
-int app_notesAddNote(const char *title, const char *content)
+int app_notesStagingCommit(void)
 {
-    uint8_t i;
-    // try to find an unused slot
-    for (i = 0; i < NB_MAX_NOTES; i++) {
-        if ((N_nvram.data.usedNotes & (1 << i)) == 0) {
-            uint32_t mask = N_nvram.data.usedNotes | (1 << i);
-            nvm_write((void *) &N_nvram.data.usedNotes, (void *) &mask, sizeof(uint32_t));
-            nvm_write((void *) &N_nvram.data.notes[i].title, (void *) title, strlen(title) + 1);
-            nvm_write(
-                (void *) &N_nvram.data.notes[i].content, (void *) content, strlen(content) + 1);
-            return i;
-        }
+    uint16_t offset;
+
+    memset(&writeStats, 0, sizeof(writeStats));
+    if (!staging.isActive || staging.isReceiving || (staging.nbStaged != staging.nbNotes)) {
+        return -1;
     }
-    return -1;
+    staging.isActive = false;
+    heapClearStaleRecord(staging.offset);
+    nvram_write((void *) heapRecord(activeBank, staging.start),
+                &staging.firstRecord,
+                sizeof(NvramNoteRecord_t),
+                &writeStats);
+    heapCountWrites(staging.start, sizeof(NvramNoteRecord_t));
+    for (offset = staging.start; offset < staging.offset; offset += heapRecordSize(offset)) {
+        uint16_t index = heapRecord(activeBank, offset)->index;
+
+        // the metadata of the content are computed when it is first decrypted
+        heapApplyRecord(offset);
+        memset(&noteInfos[index], 0, sizeof(NoteInfo_t));
+        noteInfos[index].titleLength = getNoteTitleLength(index) - 1;
+    }
+    heapTop = staging.offset;
+    return staging.firstRecord.index;
 }
 
 /**
- * @brief Modify the note at the given index
+ * @brief Cancel the notes being received (if any), their data being overwritten by next records
  *
- * @param index index of the note to modify
- * @param title title to be applied (max @ref NOTE_TITLE_MAX_LEN bytes)
- * @param content content to be applied (max @ref NOTE_CONTENT_MAX_LEN bytes
- * @return >= 0 if OK
  */
-int app_notesModifyNote(uint8_t index, const char *title, const char *content)
+void app_notesStagingDiscard(void)
 {
-    nvm_write((void *) &N_nvram.data.notes[index].title, (void *) title, strlen(title) + 1);
-    nvm_write((void *) &N_nvram.data.notes[index].content, (void *) content, strlen(content) + 1);
-    return 0;
+    staging.isActive = false;
+    explicit_bzero(&staging.crypt, sizeof(staging.crypt));
 }
 
 /**
- * @brief Delete the note at the given slot
+ * @brief Get the note whose last modifications have been lost, because it was still being edited
+ * when the app was stopped, and forget it
  *
- * @param index index of the note to delete
- * @return >= 0 if OK
+ * @return index of the note, or < 0 if none
  */
-int app_notesDeleteNote(uint8_t index)
+int app_notesGetLostDraft(void)
 {
-    uint32_t mask = N_nvram.data.usedNotes & ~(1 << index);
-    nvm_write((void *) &N_nvram.data.usedNotes, (void *) &mask, sizeof(uint32_t));
-    return 0;
+    int index = (lostDraftIndex == NO_DRAFT) ? -1 : lostDraftIndex;
+
+    lostDraftIndex = NO_DRAFT;
+    return index;
+}
+
+/**
+ * @brief Get what has actually been written in NVRAM by the latest modification of a note or a
+ * contact
+ *
+ * @param nbBytes number of written bytes
+ * @param nbPages number of written flash pages
+ */
+void app_notesGetLastWriteStats(uint32_t *nbBytes, uint32_t *nbPages)
+{
+    *nbBytes = writeStats.nbBytes;
+    *nbPages = writeStats.nbPages;
 }
 
 /**
@@ -200,9 +2168,40 @@ bool app_notesIsSessionUnlocked(void)
     return isUnlocked;
 }
 
+/**
+ * @brief Lock the session, when the application is quit or the device is locked: the note being
+ * edited is saved, then the passcode, the export permission and the keys derived in this session
+ * are needed again
+ *
+ */
 void app_notesSessionLock(void)
 {
-    isUnlocked = false;
+    // the note being edited is saved before its buffers can be left
+    app_notesFlushNote();
+    isUnlocked      = false;
+    isExportAllowed = false;
+    // as well as the keys derived in this session
+    key_cache_clear();
+    note_crypt_lock();
+}
+
+/**
+ * @brief Check whether the user has allowed the export of all notes and contacts in this session
+ *
+ * @return true if allowed
+ */
+bool app_notesIsExportAllowed(void)
+{
+    return isExportAllowed;
+}
+
+/**
+ * @brief Allow the export of all notes and contacts until it is complete or the session is locked
+ *
+ */
+void app_notesAllowExport(void)
+{
+    isExportAllowed = true;
 }
 
 /**
@@ -212,62 +2211,74 @@ void app_notesSessionLock(void)
  * retrieved)
  * @return number of Notes (number of used elements in noteArray)
  */
-uint8_t app_notesGetContacts(Contact_t contactsArray[NB_MAX_CONTACTS])
+uint16_t app_notesGetContacts(Contact_t contactsArray[NB_MAX_CONTACTS])
 {
-    uint8_t i;
-    uint8_t nbUsedSlots = 0;
-    // try to parse all slots
-    for (i = 0; i < NB_MAX_CONTACTS; i++) {
-        if (N_nvram.data.usedContacts & (1 << i)) {
-            if (contactsArray != NULL) {
-                contactsArray[nbUsedSlots].index   = i;
-                contactsArray[nbUsedSlots].name    = (char *) N_nvram.data.contacts[i].name;
-                contactsArray[nbUsedSlots].address = (char *) N_nvram.data.contacts[i].address;
-            }
-            nbUsedSlots++;
-        }
+    uint16_t i;
+    uint16_t nbUsedSlots = 0;
+
+    if (contactsArray == NULL) {
+        return nbUsedContacts;
+    }
+    for (i = bitmap_next_set(usedContacts, NB_MAX_CONTACTS, 0); i < NB_MAX_CONTACTS;
+         i = bitmap_next_set(usedContacts, NB_MAX_CONTACTS, i + 1)) {
+        volatile NvramContact_t *contact = &N_nvram.data.contacts[i][contactCopies[i]].contact;
+
+        contactsArray[nbUsedSlots].index   = i;
+        contactsArray[nbUsedSlots].name    = (char *) contact->name;
+        contactsArray[nbUsedSlots].address = (char *) contact->address;
+        nbUsedSlots++;
     }
     return nbUsedSlots;
 }
 
 /**
- * @brief Add the new address in any available slot
+ * @brief Add the new address in the least written available slot (the contact is written before
+ * being marked as used)
  *
  * @param name name to be applied (max @ref NOTE_TITLE_MAX_LEN bytes)
  * @param address address to be applied (max @ref NOTE_CONTENT_MAX_LEN bytes
+ * @param publicKey compressed public key of the contact (@ref CONTACT_PUBLIC_KEY_LEN bytes), or
+ * NULL if unknown
  * @return index of the added address, or <0 if error
  */
-int app_notesAddContact(const char *name, const char *address)
+int app_notesAddContact(const char *name, const char *address, const uint8_t *publicKey)
 {
-    uint8_t i;
-    // try to find an unused slot
-    for (i = 0; i < NB_MAX_NOTES; i++) {
-        if ((N_nvram.data.usedContacts & (1 << i)) == 0) {
-            uint32_t mask = N_nvram.data.usedContacts | (1 << i);
-            nvm_write((void *) &N_nvram.data.usedContacts, (void *) &mask, sizeof(uint32_t));
-            nvm_write((void *) &N_nvram.data.contacts[i].name, (void *) name, strlen(name) + 1);
-            nvm_write(
-                (void *) &N_nvram.data.contacts[i].address, (void *) address, strlen(address) + 1);
-            return i;
+    uint16_t i;
+    uint16_t slot = NB_MAX_CONTACTS;
+
+    memset(&writeStats, 0, sizeof(writeStats));
+    // find the unused slot with the least writes, to spread the wear of the slots
+    for (i = bitmap_next_clear(usedContacts, NB_MAX_CONTACTS, 0); i < NB_MAX_CONTACTS;
+         i = bitmap_next_clear(usedContacts, NB_MAX_CONTACTS, i + 1)) {
+        if ((slot == NB_MAX_CONTACTS) || (contactGetWrites(i) < contactGetWrites(slot))) {
+            slot = i;
         }
     }
-    return -1;
+    if (slot == NB_MAX_CONTACTS) {
+        return -1;
+    }
+    contactWrite(slot, name, address, publicKey);
+    setContactUsed(slot, true);
+    return slot;
 }
 
 /**
- * @brief Modify the contact at the given index
+ * @brief Modify the contact at the given index, by writing its other copy (only modified bytes
+ * are written), its public key being kept
  *
  * @param index index of the contact to modify
  * @param name name to be applied (max @ref ADDRESS_NAME_MAX_LEN bytes)
  * @param address address to be applied (max @ref NOTE_CONTENT_MAX_LEN bytes
- * @return >= 0 if OK
+ * @return number of bytes actually written in NVRAM (>= 0) if OK
  */
-int app_notesModifyContact(uint8_t index, const char *name, const char *address)
+int app_notesModifyContact(uint16_t index, const char *name, const char *address)
 {
-    nvm_write((void *) &N_nvram.data.contacts[index].name, (void *) name, strlen(name) + 1);
-    nvm_write(
-        (void *) &N_nvram.data.contacts[index].address, (void *) address, strlen(address) + 1);
-    return 0;
+    uint8_t publicKey[CONTACT_PUBLIC_KEY_LEN];
+    bool    hasKey = (app_notesGetContactPublicKey(index, publicKey) == 0);
+
+    memset(&writeStats, 0, sizeof(writeStats));
+    contactWrite(index, name, address, hasKey ? publicKey : NULL);
+    return writeStats.nbBytes;
 }
 
 /**
@@ -276,9 +2287,291 @@ int app_notesModifyContact(uint8_t index, const char *name, const char *address)
  * @param index index of the address to delete
  * @return >= 0 if OK
  */
-int app_notesDeleteContact(uint8_t index)
+int app_notesDeleteContact(uint16_t index)
+{
+    memset(&writeStats, 0, sizeof(writeStats));
+    if (bitmap_test(usedContacts, index)) {
+        contactStamp(index, contactCopies[index]);
+    }
+    setContactUsed(index, false);
+    return 0;
+}
+
+/**
+ * @brief Get the public key of the contact at the given index
+ *
+ * @param index index of the contact
+ * @param publicKey buffer to be filled with the compressed public key
+ * @return 0 if OK, -1 if the contact is not used or its public key is unknown
+ */
+int app_notesGetContactPublicKey(uint16_t index, uint8_t publicKey[CONTACT_PUBLIC_KEY_LEN])
+{
+    if ((index >= NB_MAX_CONTACTS) || !bitmap_test(usedContacts, index)) {
+        return -1;
+    }
+    memcpy(publicKey,
+           (const void *) N_nvram.data.contactKeys[index][contactCopies[index]],
+           CONTACT_PUBLIC_KEY_LEN);
+    if (publicKey[0] == 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Get the symmetric key shared with the contact at the given index, for encrypted sharing
+ * (the ECDH is only computed once per contact and per session)
+ *
+ * @param index index of the contact
+ * @param key buffer to be filled with the shared key
+ * @return 0 if OK, -1 if the contact has no public key or the derivation failed
+ */
+int app_notesGetContactSharingKey(uint16_t index, uint8_t key[SHARING_KEY_LEN])
+{
+    uint8_t publicKey[CONTACT_PUBLIC_KEY_LEN];
+
+    if (app_notesGetContactPublicKey(index, publicKey) != 0) {
+        return -1;
+    }
+    if (key_cache_get_sharing_key(index, publicKey, key) != CX_OK) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Get the symmetric key shared with the sender of a received note, which may not be a
+ * contact (the ECDH of an unknown sender is cached under the index @ref NB_MAX_CONTACTS)
+ *
+ * @param publicKey compressed public key of the sharing key of the sender
+ * @param key buffer to be filled with the shared key
+ * @return 0 if OK, -1 if the public key is not valid or the derivation failed
+ */
+int app_notesGetSenderSharingKey(const uint8_t publicKey[CONTACT_PUBLIC_KEY_LEN],
+                                 uint8_t       key[SHARING_KEY_LEN])
+{
+    uint8_t  contactKey[CONTACT_PUBLIC_KEY_LEN];
+    uint16_t index = NB_MAX_CONTACTS;
+    int      i;
+
+    for (i = bitmap_next_set(usedContacts, NB_MAX_CONTACTS, 0); i < NB_MAX_CONTACTS;
+         i = bitmap_next_set(usedContacts, NB_MAX_CONTACTS, i + 1)) {
+        if ((app_notesGetContactPublicKey(i, contactKey) == 0)
+            && (memcmp(contactKey, publicKey, CONTACT_PUBLIC_KEY_LEN) == 0)) {
+            index = i;
+            break;
+        }
+    }
+    if (key_cache_get_sharing_key(index, publicKey, key) != CX_OK) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Get the public key of the sharing key of the device, sent with the shared notes so that
+ * the contacts can compute the key they share with it
+ *
+ * @param publicKey buffer to be filled with the compressed public key
+ * @return 0 if OK, -1 if the derivation failed
+ */
+int app_notesGetSharingPublicKey(uint8_t publicKey[CONTACT_PUBLIC_KEY_LEN])
 {
-    uint32_t mask = N_nvram.data.usedContacts & ~(1 << index);
-    nvm_write((void *) &N_nvram.data.usedContacts, (void *) &mask, sizeof(uint32_t));
+    if (key_cache_get_sharing_public_key(publicKey) != CX_OK) {
+        return -1;
+    }
     return 0;
 }
+
+/**
+ * @brief Get the number of writes of the given contact slot
+ *
+ * @param index index of the contact slot
+ * @return number of writes of the slot
+ */
+uint32_t app_notesGetContactWrites(uint16_t index)
+{
+    return contactGetWrites(index);
+}
+
+/**
+ * @brief Get the number of flash pages of each bank of the notes heap
+ *
+ * @return number of pages per bank
+ */
+uint16_t app_notesGetHeapNbPages(void)
+{
+    return NOTES_HEAP_BANK_PAGES;
+}
+
+/**
+ * @brief Get the number of writes of the given page of the given bank of the notes heap
+ *
+ * @param bank index of the bank (0 or 1)
+ * @param page index of the page in the bank
+ * @return number of writes of the page
+ */
+uint32_t app_notesGetHeapPageWrites(uint8_t bank, uint16_t page)
+{
+    uint32_t nbWrites = N_nvram.data.notesBanks[activeBank].pageWrites[bank][page];
+
+    // writes in the active bank since it was packed are not stored yet
+    if (bank == activeBank) {
+        nbWrites += heapPageWrites[page];
+    }
+    return nbWrites;
+}
+
+/**
+ * @brief Check the data of all notes against their CRCs, and compute the root of the Merkle tree
+ * of the saved notes and contacts, so that a host can check them all at once
+ *
+ * @note the leaves are the used notes, then the used contacts, in the order of their indexes (see
+ * doc/APDU.md for their format)
+ *
+ * @param root buffer of @ref MERKLE_HASH_LEN bytes, filled with the root
+ * @return number of corrupted notes
+ */
+uint16_t app_notesGetStoreRoot(uint8_t *root)
+{
+    // the tree is too large for the stack, and the data area of the pending record is used as
+    // buffer, as nothing is pending between modifications
+    static merkle_ctx_t tree;
+    cx_sha256_t         leaf;
+    char               *content     = (char *) &pendingRecord.bytes[sizeof(NvramNoteRecord_t)];
+    uint16_t            nbCorrupted = 0;
+    uint16_t            i;
+
+    merkle_init(&tree);
+    for (i = bitmap_next_set(usedNotes, NB_MAX_NOTES, 0); i < NB_MAX_NOTES;
+         i = bitmap_next_set(usedNotes, NB_MAX_NOTES, i + 1)) {
+        if (!noteIsIntact(i)) {
+            nbCorrupted++;
+        }
+        storeLeafBuild(&leaf, i, content);
+        merkle_add_leaf(&tree, &leaf);
+    }
+    for (i = bitmap_next_set(usedContacts, NB_MAX_CONTACTS, 0); i < NB_MAX_CONTACTS;
+         i = bitmap_next_set(usedContacts, NB_MAX_CONTACTS, i + 1)) {
+        storeLeafBuild(&leaf, NB_MAX_NOTES + i, content);
+        merkle_add_leaf(&tree, &leaf);
+    }
+    merkle_get_root(&tree, root);
+    heapClearPendingRecord();
+    return nbCorrupted;
+}
+
+/**
+ * @brief Get the sequence number of the next mutation of the notes or the contacts, to be given to
+ * @ref app_notesGetChanges() to only get the slots modified from now on
+ *
+ * @return sequence number
+ */
+uint32_t app_notesGetNextSeq(void)
+{
+    return nextSeq;
+}
+
+/**
+ * @brief Get the slots modified since the given sequence number, from the given slot, as tuples of
+ * @ref STORE_CHANGE_LEN bytes: slot (2) || sequence number of its last mutation (4) || hash of its
+ * leaf in the Merkle tree of the store (32, zeros if the slot is not used anymore)
+ *
+ * @note with a sequence number of 0, the unused slots are not returned, as the host has none of
+ * them yet
+ *
+ * @param cursor first sequence number of the mutations to return
+ * @param slot first slot to check (notes, then contacts from @ref NB_MAX_NOTES), updated with the
+ * next one (NB_MAX_NOTES + NB_MAX_CONTACTS once all are checked)
+ * @param buffer buffer filled with the tuples
+ * @param size size of the buffer
+ * @return number of bytes written in buffer
+ */
+uint16_t app_notesGetChanges(uint32_t cursor, uint16_t *slot, uint8_t *buffer, uint16_t size)
+{
+    // the data area of the pending record is used as buffer, as nothing is pending between
+    // modifications
+    char       *content = (char *) &pendingRecord.bytes[sizeof(NvramNoteRecord_t)];
+    cx_sha256_t leaf;
+    uint16_t    length = 0;
+
+    for (; *slot < (NB_MAX_NOTES + NB_MAX_CONTACTS); (*slot)++) {
+        uint32_t seq  = storeGetSlotSeq(*slot);
+        bool     used = storeIsSlotUsed(*slot);
+
+        if ((seq < cursor) || (!used && (cursor == 0))) {
+            continue;
+        }
+        if ((length + STORE_CHANGE_LEN) > size) {
+            break;
+        }
+        buffer[length++] = *slot >> 8;
+        buffer[length++] = *slot & 0xFF;
+        buffer[length++] = seq >> 24;
+        buffer[length++] = (seq >> 16) & 0xFF;
+        buffer[length++] = (seq >> 8) & 0xFF;
+        buffer[length++] = seq & 0xFF;
+        if (used) {
+            storeLeafBuild(&leaf, *slot, content);
+            cx_hash_no_throw(&leaf.header, CX_LAST, NULL, 0, &buffer[length], MERKLE_HASH_LEN);
+        }
+        else {
+            memset(&buffer[length], 0, MERKLE_HASH_LEN);
+        }
+        length += MERKLE_HASH_LEN;
+    }
+    heapClearPendingRecord();
+    return length;
+}
+
+/**
+ * @brief Export the used notes then the used contacts, as a stream of records (see doc/APDU.md for
+ * their format), from the given cursor
+ *
+ * @note if the slot of the cursor is not used anymore, the export continues at the next used slot
+ * @note once all the records are exported, the export must be allowed again by the user
+ *
+ * @param slot slot of the first record to export (notes, then contacts from @ref NB_MAX_NOTES),
+ * updated with the slot of the next one (NB_MAX_NOTES + NB_MAX_CONTACTS once all are exported)
+ * @param offset offset of the first byte to export in this record, updated with the next one
+ * @param buffer buffer to fill with the exported bytes
+ * @param size size of the buffer
+ * @return number of bytes written in buffer (0 once all are exported)
+ */
+uint16_t app_notesExport(uint16_t *slot, uint16_t *offset, uint8_t *buffer, uint16_t size)
+{
+    // the records are built in the pending record, as nothing is pending between modifications
+    uint8_t *record = pendingRecord.bytes;
+    uint16_t length = 0;
+
+    while ((length < size) && (*slot < EXPORT_NB_SLOTS)) {
+        uint16_t nextSlot = exportNextSlot(*slot);
+        uint16_t recordLength;
+        uint16_t nbBytes;
+
+        if (nextSlot != *slot) {
+            *slot   = nextSlot;
+            *offset = 0;
+            continue;
+        }
+        recordLength = exportRecord(*slot, record);
+        if (*offset < recordLength) {
+            nbBytes = recordLength - *offset;
+            if (nbBytes > (size - length)) {
+                nbBytes = size - length;
+            }
+            memcpy(&buffer[length], &record[*offset], nbBytes);
+            length += nbBytes;
+            *offset += nbBytes;
+        }
+        if (*offset >= recordLength) {
+            (*slot)++;
+            *offset = 0;
+        }
+    }
+    heapClearPendingRecord();
+    if (*slot >= EXPORT_NB_SLOTS) {
+        isExportAllowed = false;
+    }
+    return length;
+}
@@ -0,0 +1,146 @@
+/**
+ * @file bitmap.c
+ * @brief helpers to handle bitmaps of any size, stored as arrays of 32-bit words
+ */
+
+#include "bitmap.h"
+
+// get the number of set bits of the given word
+static uint8_t word_count(uint32_t word)
+{
+    word = word - ((word >> 1) & 0x55555555);
+    word = (word & 0x33333333) + ((word >> 2) & 0x33333333);
+    word = (word + (word >> 4)) & 0x0F0F0F0F;
+    return (word * 0x01010101) >> 24;
+}
+
+// get the index of the first set bit (or cleared bit if invert is true) of the given bitmap, at
+// or after the given index
+static uint16_t find_next(const uint32_t *bitmap, uint16_t nbBits, uint16_t from, bool invert)
+{
+    uint16_t wordIndex = from / 32;
+    uint32_t word;
+
+    if (from >= nbBits) {
+        return nbBits;
+    }
+    // ignore the bits before the given one in its word
+    word = (invert ? ~bitmap[wordIndex] : bitmap[wordIndex]) & (0xFFFFFFFF << (from % 32));
+    while (word == 0) {
+        wordIndex++;
+        if (wordIndex >= BITMAP_NB_WORDS(nbBits)) {
+            return nbBits;
+        }
+        word = invert ? ~bitmap[wordIndex] : bitmap[wordIndex];
+    }
+    from = wordIndex * 32 + __builtin_ctz(word);
+    return (from < nbBits) ? from : nbBits;
+}
+
+/**
+ * @brief check whether the given bit of the given bitmap is set
+ *
+ * @param bitmap bitmap to check
+ * @param index index of the bit
+ * @return true if set
+ */
+bool bitmap_test(const uint32_t *bitmap, uint16_t index)
+{
+    return (bitmap[index / 32] & (1UL << (index % 32))) != 0;
+}
+
+/**
+ * @brief set the given bit of the given bitmap
+ *
+ * @param bitmap bitmap to modify
+ * @param index index of the bit
+ */
+void bitmap_set(uint32_t *bitmap, uint16_t index)
+{
+    bitmap[index / 32] |= (1UL << (index % 32));
+}
+
+/**
+ * @brief clear the given bit of the given bitmap
+ *
+ * @param bitmap bitmap to modify
+ * @param index index of the bit
+ */
+void bitmap_clear(uint32_t *bitmap, uint16_t index)
+{
+    bitmap[index / 32] &= ~(1UL << (index % 32));
+}
+
+/**
+ * @brief get the number of set bits of the given bitmap
+ *
+ * @param bitmap bitmap to count (bits after nbBits must be cleared)
+ * @param nbBits number of bits of the bitmap
+ * @return number of set bits
+ */
+uint16_t bitmap_count(const uint32_t *bitmap, uint16_t nbBits)
+{
+    uint16_t count = 0;
+    uint16_t i;
+
+    for (i = 0; i < BITMAP_NB_WORDS(nbBits); i++) {
+        count += word_count(bitmap[i]);
+    }
+    return count;
+}
+
+/**
+ * @brief get the index of the first set bit at or after the given index, skipping empty words
+ *
+ * @param bitmap bitmap to parse
+ * @param nbBits number of bits of the bitmap
+ * @param from index of the first bit to consider
+ * @return index of the found bit, or nbBits if none
+ */
+uint16_t bitmap_next_set(const uint32_t *bitmap, uint16_t nbBits, uint16_t from)
+{
+    return find_next(bitmap, nbBits, from, false);
+}
+
+/**
+ * @brief get the index of the first cleared bit at or after the given index, skipping full words
+ *
+ * @param bitmap bitmap to parse
+ * @param nbBits number of bits of the bitmap
+ * @param from index of the first bit to consider
+ * @return index of the found bit, or nbBits if none
+ */
+uint16_t bitmap_next_clear(const uint32_t *bitmap, uint16_t nbBits, uint16_t from)
+{
+    return find_next(bitmap, nbBits, from, true);
+}
+
+/**
+ * @brief get the index of the set bit of the given rank (the first set bit has rank 0), by
+ * counting set bits a word at a time
+ *
+ * @param bitmap bitmap to parse (bits after nbBits must be cleared)
+ * @param nbBits number of bits of the bitmap
+ * @param rank rank of the set bit to find
+ * @return index of the found bit, or nbBits if there are not enough set bits
+ */
+uint16_t bitmap_select(const uint32_t *bitmap, uint16_t nbBits, uint16_t rank)
+{
+    uint16_t i;
+
+    for (i = 0; i < BITMAP_NB_WORDS(nbBits); i++) {
+        uint32_t word  = bitmap[i];
+        uint8_t  count = word_count(word);
+
+        if (rank < count) {
+            // clear the lowest set bits until the searched one is the lowest
+            while (rank > 0) {
+                word &= word - 1;
+                rank--;
+            }
+            return i * 32 + __builtin_ctz(word);
+        }
+        rank -= count;
+    }
+    return nbBits;
+}
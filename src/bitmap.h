@@ -0,0 +1,22 @@
+/**
+ * @file bitmap.h
+ * @brief helpers to handle bitmaps of any size, stored as arrays of 32-bit words
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Number of 32-bit words of a bitmap of the given number of bits
+ *
+ */
+#define BITMAP_NB_WORDS(_nbBits) (((_nbBits) + 31) / 32)
+
+extern bool     bitmap_test(const uint32_t *bitmap, uint16_t index);
+extern void     bitmap_set(uint32_t *bitmap, uint16_t index);
+extern void     bitmap_clear(uint32_t *bitmap, uint16_t index);
+extern uint16_t bitmap_count(const uint32_t *bitmap, uint16_t nbBits);
+extern uint16_t bitmap_next_set(const uint32_t *bitmap, uint16_t nbBits, uint16_t from);
+extern uint16_t bitmap_next_clear(const uint32_t *bitmap, uint16_t nbBits, uint16_t from);
+extern uint16_t bitmap_select(const uint32_t *bitmap, uint16_t nbBits, uint16_t rank);
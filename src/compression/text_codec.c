@@ -0,0 +1,187 @@
+/*****************************************************************************
+ *   Ledger App Secure-Notes.
+ *   (c) 2024 Ledger SAS.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint*_t
+#include <stdbool.h>  // bool
+#include <string.h>   // memcmp
+
+#include "text_codec.h"
+
+/*
+ * Compressed data is a sequence of tokens:
+ * - 0x00..0x7F: ASCII character, as is
+ * - 0x80..0xDF: fragment of the static dictionary
+ * - 0xE0..0xFE: reference to previous text, length is (token - 0xE0 + MIN_MATCH_LEN), followed by
+ *               one byte with (distance - 1)
+ * - 0xFF:       followed by a non-ASCII character
+ */
+#define DICT_TOKEN      0x80
+#define MATCH_TOKEN     0xE0
+#define ESCAPE_TOKEN    0xFF
+#define DICT_SIZE       (MATCH_TOKEN - DICT_TOKEN)
+#define MIN_MATCH_LEN   3
+#define MAX_MATCH_LEN   (ESCAPE_TOKEN - MATCH_TOKEN - 1 + MIN_MATCH_LEN)
+#define MAX_DISTANCE    256
+#define DICT_ENTRY_SIZE 7
+
+// frequent fragments of English text, longest ones first
+static const char DICTIONARY[DICT_SIZE][DICT_ENTRY_SIZE] = {
+    " that ", " with ", " have ", " this ", " from ", " will ", " your ", " the ", " and ",
+    " for ",  " you ",  " are ",  " not ",  " was ",  " can ",  " all ",  " but ", "ould ",
+    "tion",   "ment",   "ight",   "ough",   "ther",   "ing ",   " to ",   " of ",  " in ",
+    " is ",   " on ",   " be ",   " at ",   " it ",   " or ",   " an ",   " my ",  " as ",
+    " by ",   " we ",   "the ",   "ing",    "ed ",    "es ",    "er ",    "ly ",   "s ",
+    "e ",     "d ",     "t ",     "y ",     "n ",     ", ",     ". ",     "th",    "he",
+    "in",     "er",     "an",     "re",     "on",     "at",     "en",     "nd",    "ti",
+    "es",     "or",     "te",     "of",     "ed",     "is",     "it",     "al",    "ar",
+    "st",     "to",     "nt",     "ng",     "se",     "ha",     "as",     "ou",    "io",
+    "le",     "ve",     "co",     "me",     "de",     "hi",     "ri",     "ro",    "ic",
+    "ne",     "ea",     "ra",     "ce",     "li",     "ch"};
+
+// gets the length of the longest dictionary fragment at the start of text, and its index
+static size_t find_dict_match(const char *text, size_t text_len, uint8_t *index) {
+    size_t best_len = 0;
+
+    for (uint8_t i = 0; i < DICT_SIZE; i++) {
+        size_t len = strlen(DICTIONARY[i]);
+
+        if ((len > best_len) && (len <= text_len) && (text[0] == DICTIONARY[i][0]) &&
+            (memcmp(text, DICTIONARY[i], len) == 0)) {
+            best_len = len;
+            *index = i;
+        }
+    }
+    return best_len;
+}
+
+// gets the length of the longest previous occurrence of the text at pos, and its distance
+static size_t find_back_match(const char *text, size_t text_len, size_t pos, size_t *distance) {
+    size_t best_len = 0;
+    size_t max_len = text_len - pos;
+    size_t start = (pos > MAX_DISTANCE) ? (pos - MAX_DISTANCE) : 0;
+
+    if (max_len > MAX_MATCH_LEN) {
+        max_len = MAX_MATCH_LEN;
+    }
+    for (size_t i = start; i < pos; i++) {
+        size_t len = 0;
+
+        while ((len < max_len) && (text[i + len] == text[pos + len])) {
+            len++;
+        }
+        if (len > best_len) {
+            best_len = len;
+            *distance = pos - i;
+        }
+    }
+    return best_len;
+}
+
+int text_codec_compress(const char *text, size_t text_len, uint8_t *out, size_t out_len) {
+    size_t pos = 0;
+    size_t offset = 0;
+
+    while (pos < text_len) {
+        uint8_t dict_index = 0;
+        size_t distance = 0;
+        size_t dict_len = find_dict_match(&text[pos], text_len - pos, &dict_index);
+        size_t back_len = find_back_match(text, text_len, pos, &distance);
+
+        if (back_len < MIN_MATCH_LEN) {
+            back_len = 0;
+        }
+        // choose the token saving the most bytes
+        if ((back_len > 0) && ((back_len - 2) > ((dict_len > 0) ? (dict_len - 1) : 0))) {
+            if (offset + 2 > out_len) {
+                return -1;
+            }
+            out[offset++] = MATCH_TOKEN + back_len - MIN_MATCH_LEN;
+            out[offset++] = distance - 1;
+            pos += back_len;
+        } else if (dict_len > 0) {
+            if (offset + 1 > out_len) {
+                return -1;
+            }
+            out[offset++] = DICT_TOKEN + dict_index;
+            pos += dict_len;
+        } else if ((uint8_t) text[pos] < DICT_TOKEN) {
+            if (offset + 1 > out_len) {
+                return -1;
+            }
+            out[offset++] = text[pos++];
+        } else {
+            if (offset + 2 > out_len) {
+                return -1;
+            }
+            out[offset++] = ESCAPE_TOKEN;
+            out[offset++] = text[pos++];
+        }
+    }
+    return (int) offset;
+}
+
+int text_codec_decompress(const uint8_t *in, size_t in_len, char *out, size_t out_len) {
+    size_t offset = 0;
+    size_t pos = 0;
+
+    if (out_len == 0) {
+        return -1;
+    }
+    while (offset < in_len) {
+        uint8_t token = in[offset++];
+
+        if (token < DICT_TOKEN) {
+            if (pos + 1 >= out_len) {
+                return -1;
+            }
+            out[pos++] = token;
+        } else if (token < MATCH_TOKEN) {
+            const char *fragment = DICTIONARY[token - DICT_TOKEN];
+            size_t len = strlen(fragment);
+
+            if (pos + len >= out_len) {
+                return -1;
+            }
+            memcpy(&out[pos], fragment, len);
+            pos += len;
+        } else if (token < ESCAPE_TOKEN) {
+            size_t len = token - MATCH_TOKEN + MIN_MATCH_LEN;
+            size_t distance;
+
+            if (offset >= in_len) {
+                return -1;
+            }
+            distance = in[offset++] + 1;
+            if ((distance > pos) || (pos + len >= out_len)) {
+                return -1;
+            }
+            // byte per byte, since source and destination may overlap
+            for (size_t i = 0; i < len; i++) {
+                out[pos + i] = out[pos - distance + i];
+            }
+            pos += len;
+        } else {
+            if ((offset >= in_len) || (pos + 1 >= out_len)) {
+                return -1;
+            }
+            out[pos++] = in[offset++];
+        }
+    }
+    out[pos] = '\0';
+    return (int) pos;
+}
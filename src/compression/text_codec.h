@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stddef.h>  // size_t
+#include <stdint.h>  // uint*_t
+
+/**
+ * Compress ASCII text, using a static dictionary of frequent English fragments and references
+ * to previous occurrences in the text itself.
+ *
+ * @param[in]  text
+ *   Pointer to input text.
+ * @param[in]  text_len
+ *   Length of input text (without final '\0').
+ * @param[out] out
+ *   Pointer to output byte buffer.
+ * @param[in]  out_len
+ *   Length of output byte buffer.
+ *
+ * @return length of compressed data if success, -1 if output buffer is too small.
+ *
+ */
+int text_codec_compress(const char *text, size_t text_len, uint8_t *out, size_t out_len);
+
+/**
+ * Decompress data produced by text_codec_compress() in a '\0' terminated string.
+ *
+ * @param[in]  in
+ *   Pointer to compressed data.
+ * @param[in]  in_len
+ *   Length of compressed data.
+ * @param[out] out
+ *   Pointer to output string.
+ * @param[in]  out_len
+ *   Length of output string buffer (including final '\0').
+ *
+ * @return length of decompressed text (without final '\0') if success, -1 otherwise.
+ *
+ */
+int text_codec_decompress(const uint8_t *in, size_t in_len, char *out, size_t out_len);
@@ -30,9 +30,39 @@
  */
 #define MAX_DER_SIG_LEN 72
 
+/**
+ * Maximum number of transactions signed with one approval.
+ */
+#define MAX_BATCH_TX 16
+
+/**
+ * Maximum number of signatures of a batch sent by a response (3 of up to 74 bytes).
+ */
+#define BATCH_SIGS_PER_RESPONSE 3
+
+/**
+ * Length of a compressed public key: parity of y-coordinate (1) || x-coordinate (32).
+ */
+#define COMPRESSED_PUBKEY_LEN 33
+
+/**
+ * Maximum number of public keys sent by a GET_PUBLIC_KEYS response (4 of 53 bytes).
+ */
+#define PUBKEYS_PER_RESPONSE 4
+
 /**
  * Exponent used to convert mBOL to BOL unit (N BOL = N * 10^3 mBOL).
  */
 #define EXPONENT_SMALLEST_UNIT 3
 
+/**
+ * Number of bytes of the export payload sent by each response to EXPORT_NOTES.
+ */
+#define EXPORT_CHUNK_LEN 250
+
+/**
+ * Maximum length of the modified slots sent by GET_CHANGES (6 slots of 38 bytes).
+ */
+#define CHANGES_CHUNK_LEN 228
+
 #define UNUSED(x) (void) x
\ No newline at end of file
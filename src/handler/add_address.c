@@ -26,6 +26,7 @@
 
 #include "notes_handlers.h"
 #include "sign_tx.h"
+#include "../key_cache.h"
 #include "../sw.h"
 #include "../globals.h"
 #include "../app_notes.h"
@@ -38,8 +39,20 @@ int handler_add_address(buffer_t *cdata) {
     G_context.req_type = CONFIRM_ADD_ADDRESS;
     G_context.state = STATE_NONE;
 
-    // 32 bytes for address
-    buffer_copy(cdata, (uint8_t *)sharedBuffer, 32);
-    app_notesAddAddress((const char*)sharedBuffer);
+    // 32 bytes for address, optionally followed by the compressed public key of the contact
+    if (cdata->size != CONTACT_ADDRESS_MAX_LEN &&
+        cdata->size != CONTACT_ADDRESS_MAX_LEN + CONTACT_PUBLIC_KEY_LEN) {
+        return io_send_sw(SW_WRONG_DATA_LENGTH);
+    }
+    buffer_move(cdata, (uint8_t *) sharedBuffer, CONTACT_ADDRESS_MAX_LEN);
+    if (cdata->size == CONTACT_ADDRESS_MAX_LEN + CONTACT_PUBLIC_KEY_LEN) {
+        // the key is used for ECDH when sharing notes, so it must be a point of the curve
+        if (!key_cache_check_public_key(cdata->ptr + cdata->offset)) {
+            return io_send_sw(SW_WRONG_DATA);
+        }
+        app_notesAddAddress((const char *) sharedBuffer, cdata->ptr + cdata->offset);
+    } else {
+        app_notesAddAddress((const char *) sharedBuffer, NULL);
+    }
     return io_send_sw(SW_OK);
 }
@@ -0,0 +1,51 @@
+/*****************************************************************************
+ *   Ledger App Secure-Notes.
+ *   (c) 2024 Ledger SAS.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+#include <stdint.h>  // uint*_t
+#include <string.h>  // explicit_bzero
+
+#include "io.h"
+#include "buffer.h"
+
+#include "notes_handlers.h"
+#include "../globals.h"
+#include "../app_notes.h"
+#include "../types.h"
+#include "../sw.h"
+#include "../ui/display.h"
+#include "../helper/send_response.h"
+
+int handler_export_notes(buffer_t *cdata) {
+    explicit_bzero(&G_context, sizeof(G_context));
+    G_context.req_type = CONFIRM_EXPORT;
+    G_context.state = STATE_NONE;
+
+    // cursor = slot of the next record (2) || offset of the next byte in this record (2)
+    if (!buffer_read_u16(cdata, &G_context.export_info.slot, BE) ||
+        !buffer_read_u16(cdata, &G_context.export_info.offset, BE) ||
+        cdata->offset != cdata->size) {
+        return io_send_sw(SW_WRONG_DATA_LENGTH);
+    }
+    if (app_notesSettingsIsLocked() && !app_notesIsSessionUnlocked()) {
+        return io_send_sw(SW_DENY);
+    }
+    // the user is only asked once per export, the response being sent once allowed
+    if (!app_notesIsExportAllowed()) {
+        return ui_display_export();
+    }
+    return helper_send_response_export();
+}
@@ -0,0 +1,52 @@
+/*****************************************************************************
+ *   Ledger App Secure-Notes.
+ *   (c) 2024 Ledger SAS.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+#include <stdint.h>  // uint*_t
+#include <stddef.h>  // size_t
+
+#include "io.h"
+#include "buffer.h"
+#include "write.h"
+
+#include "notes_handlers.h"
+#include "../app_notes.h"
+#include "../constants.h"
+#include "../sw.h"
+
+int handler_get_changes(buffer_t *cdata) {
+    uint8_t resp[6 + CHANGES_CHUNK_LEN] = {0};
+    uint32_t cursor = 0;
+    uint16_t slot = 0;
+    size_t offset = 6;
+
+    // cursor = sequence number of the first mutation to send (4) || slot of the next change (2)
+    if (!buffer_read_u32(cdata, &cursor, BE) || !buffer_read_u16(cdata, &slot, BE) ||
+        cdata->offset != cdata->size) {
+        return io_send_sw(SW_WRONG_DATA_LENGTH);
+    }
+    // the hashes could be used to confirm guesses of the notes, so they are only given once
+    // unlocked
+    if (app_notesSettingsIsLocked() && !app_notesIsSessionUnlocked()) {
+        return io_send_sw(SW_DENY);
+    }
+    // response = next sequence number (4) || slot of the next change (2) || changes
+    offset += app_notesGetChanges(cursor, &slot, resp + offset, CHANGES_CHUNK_LEN);
+    write_u32_be(resp, 0, app_notesGetNextSeq());
+    write_u16_be(resp, 4, slot);
+
+    return io_send_response_pointer(resp, offset, SW_OK);
+}
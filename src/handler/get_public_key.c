@@ -18,7 +18,7 @@
 #include <stdint.h>   // uint*_t
 #include <stdbool.h>  // bool
 #include <stddef.h>   // size_t
-#include <string.h>   // memset, explicit_bzero
+#include <string.h>   // memmove, explicit_bzero
 
 #include "os.h"
 #include "cx.h"
@@ -32,6 +32,7 @@
 #include "../sw.h"
 #include "../ui/display.h"
 #include "../helper/send_response.h"
+#include "../key_cache.h"
 
 int handler_get_public_key(buffer_t *cdata, bool display) {
     explicit_bzero(&G_context, sizeof(G_context));
@@ -42,17 +43,23 @@ int handler_get_public_key(buffer_t *cdata, bool display) {
         !buffer_read_bip32_path(cdata, G_context.bip32_path, (size_t) G_context.bip32_path_len)) {
         return io_send_sw(SW_WRONG_DATA_LENGTH);
     }
+    // of the keys of the app, only the public key of the sharing key is given
+    if (key_cache_is_app_path(G_context.bip32_path, G_context.bip32_path_len) &&
+        !key_cache_is_sharing_path(G_context.bip32_path, G_context.bip32_path_len)) {
+        return io_send_sw(SW_WRONG_DATA);
+    }
 
-    cx_err_t error = bip32_derive_get_pubkey_256(CX_CURVE_256K1,
-                                                 G_context.bip32_path,
-                                                 G_context.bip32_path_len,
-                                                 G_context.pk_info.raw_public_key,
-                                                 G_context.pk_info.chain_code,
-                                                 CX_SHA512);
+    // the key is only derived by the first request of the session on this path
+    const key_cache_entry_t *key = NULL;
+    cx_err_t error = key_cache_get(G_context.bip32_path, G_context.bip32_path_len, &key);
 
     if (error != CX_OK) {
-        return io_send_sw(error);
+        return io_send_sw(SW_KEY_DERIVATION_FAIL);
     }
+    memmove(G_context.pk_info.raw_public_key,
+            key->raw_public_key,
+            sizeof(G_context.pk_info.raw_public_key));
+    memmove(G_context.pk_info.chain_code, key->chain_code, sizeof(G_context.pk_info.chain_code));
 
     if (display) {
         return ui_display_address();
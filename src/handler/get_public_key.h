@@ -24,3 +24,17 @@
  *
  */
 int handler_get_public_key(buffer_t *cdata, bool display);
+
+/**
+ * Handler for GET_PUBLIC_KEYS command. Send APDU response with the
+ * compressed public keys and the addresses of the next children of a
+ * BIP32 path, derived from the cached key of this path.
+ *
+ * @param[in,out] cdata
+ *   Command data with base BIP32 path, index of the first child and
+ *   number of children.
+ *
+ * @return zero or positive integer if success, negative integer otherwise.
+ *
+ */
+int handler_get_public_keys(buffer_t *cdata);
@@ -0,0 +1,86 @@
+/*****************************************************************************
+ *   Ledger App Secure-Notes.
+ *   (c) 2024 Ledger SAS.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+#include <stdint.h>  // uint*_t
+#include <stddef.h>  // size_t
+#include <string.h>  // memmove
+
+#include "os.h"
+#include "cx.h"
+#include "io.h"
+#include "buffer.h"
+#include "bip32.h"
+
+#include "get_public_key.h"
+#include "../constants.h"
+#include "../sw.h"
+#include "../address.h"
+#include "../key_cache.h"
+#include "../transaction/types.h"
+
+int handler_get_public_keys(buffer_t *cdata) {
+    uint8_t resp[1 + PUBKEYS_PER_RESPONSE * (COMPRESSED_PUBKEY_LEN + ADDRESS_LEN)] = {0};
+    uint32_t bip32_path[MAX_BIP32_PATH] = {0};
+    uint8_t bip32_path_len = 0;
+    uint32_t first = 0;
+    uint8_t count = 0;
+    uint8_t raw_public_key[65];
+    const key_cache_entry_t *parent = NULL;
+    size_t offset = 1;
+
+    // base path, leaving room for the index || index of the first child (4) || number of
+    // children (1)
+    if (!buffer_read_u8(cdata, &bip32_path_len) || bip32_path_len == 0 ||
+        bip32_path_len >= MAX_BIP32_PATH ||
+        !buffer_read_bip32_path(cdata, bip32_path, (size_t) bip32_path_len) ||
+        !buffer_read_u32(cdata, &first, BE) || !buffer_read_u8(cdata, &count) ||
+        cdata->offset != cdata->size || count == 0 || first + (uint32_t) (count - 1) < first) {
+        return io_send_sw(SW_WRONG_DATA_LENGTH);
+    }
+    // the keys of the app are not exported
+    if (key_cache_is_app_path(bip32_path, bip32_path_len)) {
+        return io_send_sw(SW_WRONG_DATA);
+    }
+
+    // the base path is only derived by the first request of the session, each child then only
+    // costs one step of derivation
+    cx_err_t error = key_cache_get(bip32_path, bip32_path_len, &parent);
+    if (error != CX_OK) {
+        return io_send_sw(SW_KEY_DERIVATION_FAIL);
+    }
+
+    // response = number of keys (1) || (compressed public key (33) || address (20)) * number
+    if (count > PUBKEYS_PER_RESPONSE) {
+        count = PUBKEYS_PER_RESPONSE;
+    }
+    resp[0] = count;
+    for (uint8_t i = 0; i < count; i++) {
+        error = key_cache_derive_child(parent, first + i, raw_public_key);
+        if (error != CX_OK) {
+            return io_send_sw(SW_KEY_DERIVATION_FAIL);
+        }
+        resp[offset++] = (raw_public_key[64] & 1) ? 0x03 : 0x02;
+        memmove(resp + offset, raw_public_key + 1, COMPRESSED_PUBKEY_LEN - 1);
+        offset += COMPRESSED_PUBKEY_LEN - 1;
+        if (!address_from_pubkey(raw_public_key, resp + offset, ADDRESS_LEN)) {
+            return io_send_sw(SW_DISPLAY_ADDRESS_FAIL);
+        }
+        offset += ADDRESS_LEN;
+    }
+
+    return io_send_response_pointer(resp, offset, SW_OK);
+}
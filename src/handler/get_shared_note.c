@@ -19,12 +19,14 @@
 #include <stdbool.h>  // bool
 #include <stddef.h>   // size_t
 #include <string.h>   // memset, explicit_bzero
+#include <assert.h>   // _Static_assert
 
 #include "os.h"
 #include "cx.h"
 #include "io.h"
 #include "buffer.h"
 #include "crypto_helpers.h"
+#include "write.h"
 
 #include "notes_handlers.h"
 #include "../globals.h"
@@ -34,30 +36,49 @@
 #include "../ui/display.h"
 #include "../helper/send_response.h"
 
+/**
+ * Max number of bytes of the payload in the response to a GET_NOTE command.
+ */
+#define NOTE_CHUNK_LEN 250
+
 uint8_t sharedBuffer[256];
 
-int handler_get_shared_note(void) {
+int handler_get_shared_note(uint8_t chunk) {
     explicit_bzero(&G_context, sizeof(G_context));
     G_context.req_type = CONFIRM_GET_NOTE;
     G_context.state = STATE_NONE;
 
-    Note_t *note = app_notesGetSharedNote();
-    if (note == NULL) {
+    uint16_t total_len = 0;
+    const uint8_t *payload = app_notesGetSharedPayload(&total_len);
+    if (payload == NULL) {
         PRINTF("Nothing to share\n");
         return io_send_sw(SW_NO_SHARED_NOTE);
     }
-    else {
-        uint8_t *ptr = sharedBuffer;
-        uint8_t title_len = strlen(note->title);
-        uint8_t content_len = strlen(note->content);
-
-        // convert note title+content in a buffer
-        // TODO: encrypt with public key of contact here
-        *ptr++ = title_len;
-        memcpy(ptr, note->title, title_len);
-        ptr += title_len;
-        *ptr++ = content_len;
-        memcpy(ptr, note->content, content_len);
-        return io_send_response_pointer(sharedBuffer, title_len+content_len+2, SW_OK);
+
+    size_t start = chunk * NOTE_CHUNK_LEN;
+    size_t end = start + NOTE_CHUNK_LEN;
+    uint8_t header[4];
+    // the chunk is sent directly from the payload, encrypted once for all the contacts
+    buffer_t rdata[2] = {{.ptr = header, .size = sizeof(header), .offset = 0},
+                         {.ptr = payload, .size = 0, .offset = 0}};
+
+    _Static_assert(sizeof(header) + NOTE_CHUNK_LEN <= IO_APDU_BUFFER_SIZE - 2,
+                   "Note chunk too large");
+    if (start >= total_len) {
+        return io_send_sw(SW_WRONG_P1P2);
+    }
+    if (end > total_len) {
+        end = total_len;
+    }
+    // response = total length of the payload (2) || offset of the chunk (2) ||
+    //            bytes of the chunk
+    write_u16_be(header, 0, total_len);
+    write_u16_be(header, 2, start);
+    rdata[1].ptr += start;
+    rdata[1].size = end - start;
+    // the sharing is complete once the last chunk is sent
+    if (end == total_len) {
+        app_notesSharedNoteSent();
     }
+    return io_send_response_buffers(rdata, 2, SW_OK);
 }
@@ -0,0 +1,45 @@
+/*****************************************************************************
+ *   Ledger App Secure-Notes.
+ *   (c) 2024 Ledger SAS.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+#include <stdint.h>  // uint*_t
+#include <stddef.h>  // size_t
+
+#include "io.h"
+#include "write.h"
+
+#include "notes_handlers.h"
+#include "../app_notes.h"
+#include "../merkle.h"
+#include "../sw.h"
+
+int handler_get_store_root(void) {
+    size_t offset = 0;
+
+    // the root could be used to confirm guesses of the notes, so it is only given once unlocked
+    if (app_notesSettingsIsLocked() && !app_notesIsSessionUnlocked()) {
+        return io_send_sw(SW_DENY);
+    }
+    // response = number of notes (2) || number of contacts (2) ||
+    //            number of corrupted notes (2) || root (32)
+    write_u16_be(sharedBuffer, offset, app_notesGetAll(NULL));
+    offset += 2;
+    write_u16_be(sharedBuffer, offset, app_notesGetContacts(NULL));
+    offset += 2;
+    write_u16_be(sharedBuffer, offset, app_notesGetStoreRoot(&sharedBuffer[offset + 2]));
+    offset += 2 + MERKLE_HASH_LEN;
+    return io_send_response_pointer(sharedBuffer, offset, SW_OK);
+}
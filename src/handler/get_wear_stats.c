@@ -0,0 +1,69 @@
+/*****************************************************************************
+ *   Ledger App Secure-Notes.
+ *   (c) 2024 Ledger SAS.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+#include <stdint.h>  // uint*_t
+#include <stddef.h>  // size_t
+#include <assert.h>  // _Static_assert
+
+#include "io.h"
+#include "write.h"
+
+#include "notes_handlers.h"
+#include "../app_notes.h"
+#include "../sw.h"
+
+/**
+ * Max number of counters in the response to a GET_WEAR_STATS command.
+ */
+#define WEAR_STATS_CHUNK_LEN 60
+
+int handler_get_wear_stats(uint8_t chunk) {
+    uint16_t nb_pages = app_notesGetHeapNbPages();
+    uint32_t nb_counters = NB_MAX_CONTACTS + 2 * nb_pages;
+    uint32_t counter = chunk * WEAR_STATS_CHUNK_LEN;
+    size_t offset = 0;
+
+    _Static_assert(5 + 4 * WEAR_STATS_CHUNK_LEN <= sizeof(sharedBuffer),
+                   "Wear stats chunk too large");
+    // the write counters tell which contacts and notes were modified, and how often, so they
+    // are only given once unlocked
+    if (app_notesSettingsIsLocked() && !app_notesIsSessionUnlocked()) {
+        return io_send_sw(SW_DENY);
+    }
+    // response = number of contact slots (2) || number of banks (1) ||
+    //            number of pages per bank (2) ||
+    //            counters of the chunk (4 each), in the list of the writes of each contact slot,
+    //            then of each page of bank 0, then of each page of bank 1
+    write_u16_be(sharedBuffer, offset, NB_MAX_CONTACTS);
+    offset += 2;
+    sharedBuffer[offset++] = 2;
+    write_u16_be(sharedBuffer, offset, nb_pages);
+    offset += 2;
+    for (uint8_t i = 0; (i < WEAR_STATS_CHUNK_LEN) && (counter < nb_counters); i++, counter++) {
+        uint32_t nb_writes;
+
+        if (counter < NB_MAX_CONTACTS) {
+            nb_writes = app_notesGetContactWrites(counter);
+        } else {
+            uint32_t page = counter - NB_MAX_CONTACTS;
+            nb_writes = app_notesGetHeapPageWrites(page / nb_pages, page % nb_pages);
+        }
+        write_u32_be(sharedBuffer, offset, nb_writes);
+        offset += 4;
+    }
+    return io_send_response_pointer(sharedBuffer, offset, SW_OK);
+}
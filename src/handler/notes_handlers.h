@@ -17,21 +17,77 @@ extern uint8_t sharedBuffer[256];
 int handler_add_address(buffer_t *cdata);
 
 /**
- * Handler for GET_NOTE command. Send APDU response with version
- * of the application.
+ * Handler for GET_NOTE command. Send APDU response with a chunk of the
+ * note being shared.
  *
+ * @param[in] chunk
+ *   Index of the chunk of the note to send.
  *
  * @return zero or positive integer if success, negative integer otherwise.
  *
  */
-int handler_get_shared_note(void);
+int handler_get_shared_note(uint8_t chunk);
 
 /**
- * Handler for PUT_NOTE command. Send APDU response with version
- * of the application.
+ * Handler for PUT_NOTE command. Receive a shared note in several APDUs, in
+ * plaintext or as the encrypted payload sent by GET_NOTE, writing it directly
+ * in NVRAM, then ask the user to accept it.
+ *
+ * @param[in] phase
+ *   Phase of the reception (P1_NOTE_START, P1_NOTE_CONTINUE, P1_NOTE_FINISH,
+ *   P1_NOTE_BATCH, P1_NOTE_ENCRYPTED_START or P1_NOTE_ENCRYPTED_CONTINUE).
+ * @param[in,out] cdata
+ *   Command data with the lengths, the next bytes or the hash of the note, or
+ *   the length or the next bytes of the payload.
+ *
+ * @return zero or positive integer if success, negative integer otherwise.
+ *
+ */
+int handler_put_shared_note(uint8_t phase, buffer_t *cdata);
+
+/**
+ * Handler for GET_WEAR_STATS command. Send APDU response with the number of
+ * writes of each contact slot and of each flash page of the notes heap.
+ *
+ * @param[in] chunk
+ *   Index of the chunk of counters to send.
+ *
+ * @return zero or positive integer if success, negative integer otherwise.
+ *
+ */
+int handler_get_wear_stats(uint8_t chunk);
+
+/**
+ * Handler for GET_STORE_ROOT command. Check the CRCs of all notes, and send APDU
+ * response with the Merkle root of the saved notes and contacts.
+ *
+ * @return zero or positive integer if success, negative integer otherwise.
+ *
+ */
+int handler_get_store_root(void);
+
+/**
+ * Handler for EXPORT_NOTES command. Send APDU response with the next
+ * records of the export of all notes and contacts, from the given cursor,
+ * once the user has allowed it for this session.
+ *
+ * @param[in,out] cdata
+ *   Command data with the cursor.
+ *
+ * @return zero or positive integer if success, negative integer otherwise.
+ *
+ */
+int handler_export_notes(buffer_t *cdata);
+
+/**
+ * Handler for GET_CHANGES command. Send APDU response with the next
+ * notes and contacts modified since the given sequence number, from the
+ * given slot.
  *
+ * @param[in,out] cdata
+ *   Command data with the sequence number and the slot.
  *
  * @return zero or positive integer if success, negative integer otherwise.
  *
  */
-int handler_put_shared_note(buffer_t *cdata);
+int handler_get_changes(buffer_t *cdata);
@@ -33,30 +33,140 @@
 #include "../sw.h"
 #include "../ui/display.h"
 #include "../helper/send_response.h"
+#include "../apdu/dispatcher.h"
 
-int handler_put_shared_note(buffer_t *cdata) {
+// once a note has been staged, ask the user to accept it, or all the announced notes
+static int finish_note(int status, Note_t *note) {
+    uint16_t total_len = 0;
+    uint16_t nb_notes;
+
+    if (status == -2) {
+        PRINTF("Wrong note hash\n");
+        return io_send_sw(SW_WRONG_NOTE_HASH);
+    } else if (status < 0) {
+        PRINTF("Note not complete\n");
+        return io_send_sw(SW_BAD_STATE);
+    }
+    if (status > 0) {
+        // other announced notes are still to be received
+        return io_send_sw(SW_OK);
+    }
+    nb_notes = app_notesStagingGetSummary(&total_len);
+    if (nb_notes > 1) {
+        app_notesReceiveSharedNotes(nb_notes, total_len);
+    } else {
+        app_notesReceiveSharedNote(note->title, note->content);
+    }
+    return io_send_sw(SW_OK);
+}
+
+// stage the note of the whole encrypted payload, only decrypted once found authentic
+static int receive_encrypted_note(void) {
+    uint8_t hash[CX_SHA256_SIZE];
+    uint8_t title_len = 0;
+    uint16_t content_len = 0;
+    const uint8_t *plaintext = app_notesSharedPayloadOpen(&title_len, &content_len);
+    Note_t note;
+    int status;
+
+    if (plaintext == NULL) {
+        PRINTF("Note not for this device or not authentic\n");
+        return io_send_sw(SW_WRONG_SHARED_NOTE);
+    }
+    if (cx_hash_sha256(plaintext, title_len + content_len, hash, sizeof(hash)) != CX_SHA256_SIZE) {
+        app_notesSharedPayloadClose();
+        return io_send_sw(SW_BAD_STATE);
+    }
+    if (app_notesStagingStart(title_len, content_len) < 0) {
+        app_notesSharedPayloadClose();
+        return io_send_sw(SW_NOT_ENOUGH_SPACE);
+    }
+    status = app_notesStagingAppend(plaintext, title_len + content_len);
+    // the plaintext is wiped as soon as it is stored encrypted
+    app_notesSharedPayloadClose();
+    if (status < 0) {
+        return io_send_sw(SW_BAD_STATE);
+    }
+    return finish_note(app_notesStagingFinish(hash, &note), &note);
+}
+
+int handler_put_shared_note(uint8_t phase, buffer_t *cdata) {
     uint8_t title_len = 0;
-    uint8_t content_len;
+    uint8_t nb_notes = 0;
+    uint16_t content_len = 0;
+    uint16_t total_len = 0;
+    Note_t note;
+    int status;
 
     explicit_bzero(&G_context, sizeof(G_context));
     G_context.req_type = CONFIRM_PUT_NOTE;
     G_context.state = STATE_NONE;
-            PRINTF("LC = %d\n", cdata->size);
-
-     // get content and title from shared buffer
-    // TODO: should be a decryption with private key
-   if (!buffer_read_u8(cdata, &title_len) ||
-        !buffer_read_nu8(cdata, sharedBuffer, (size_t) title_len)) {
-            PRINTF("Wrong title len %d\n", title_len);
-        return io_send_sw(SW_WRONG_DATA_LENGTH);
-    }
-    sharedBuffer[title_len] = 0;
-    if (!buffer_read_u8(cdata, &content_len) ||
-        !buffer_read_nu8(cdata, &sharedBuffer[title_len+1], (size_t) content_len)) {
-            PRINTF("Wrong content len\n");
-        return io_send_sw(SW_WRONG_DATA_LENGTH);
-    }
-    sharedBuffer[title_len+content_len+1] = 0;
-    app_notesReceiveSharedNote((const char*)&sharedBuffer[0], (const char*)&sharedBuffer[title_len+1]);
-    return io_send_sw(SW_OK);
+
+    // the note is received either in plaintext (P1_NOTE_START to P1_NOTE_FINISH), or as the
+    // encrypted payload sent by GET_NOTE (P1_NOTE_ENCRYPTED_START and P1_NOTE_ENCRYPTED_CONTINUE)
+    switch (phase) {
+        case P1_NOTE_BATCH:
+            // number of notes, and total length of their titles and contents
+            if (!buffer_read_u8(cdata, &nb_notes) || !buffer_read_u16(cdata, &total_len, BE) ||
+                cdata->offset != cdata->size) {
+                PRINTF("Wrong lengths\n");
+                return io_send_sw(SW_WRONG_DATA_LENGTH);
+            }
+            if (app_notesStagingBegin(nb_notes, total_len) < 0) {
+                return io_send_sw(SW_NOT_ENOUGH_SPACE);
+            }
+            return io_send_sw(SW_OK);
+        case P1_NOTE_START:
+            // lengths of the title and the content, without their final '\0'
+            if (!buffer_read_u8(cdata, &title_len) || !buffer_read_u16(cdata, &content_len, BE) ||
+                cdata->offset != cdata->size) {
+                PRINTF("Wrong lengths\n");
+                return io_send_sw(SW_WRONG_DATA_LENGTH);
+            }
+            if (title_len >= NOTE_TITLE_MAX_LEN || content_len >= NOTE_CONTENT_MAX_LEN) {
+                PRINTF("Wrong title len %d or content len %d\n", title_len, content_len);
+                return io_send_sw(SW_WRONG_DATA_LENGTH);
+            }
+            if (app_notesStagingStart(title_len, content_len) < 0) {
+                return io_send_sw(SW_NOT_ENOUGH_SPACE);
+            }
+            return io_send_sw(SW_OK);
+        case P1_NOTE_CONTINUE:
+            // next bytes of the title then the content, written directly in NVRAM
+            if (app_notesStagingAppend(cdata->ptr, cdata->size) < 0) {
+                PRINTF("Too many bytes\n");
+                return io_send_sw(SW_WRONG_DATA_LENGTH);
+            }
+            return io_send_sw(SW_OK);
+        case P1_NOTE_FINISH:
+            // SHA-256 of the title then the content
+            if (cdata->size != CX_SHA256_SIZE) {
+                return io_send_sw(SW_WRONG_DATA_LENGTH);
+            }
+            return finish_note(app_notesStagingFinish(cdata->ptr, &note), &note);
+        case P1_NOTE_ENCRYPTED_START:
+            // length of the whole payload
+            if (!buffer_read_u16(cdata, &total_len, BE) || cdata->offset != cdata->size) {
+                PRINTF("Wrong length\n");
+                return io_send_sw(SW_WRONG_DATA_LENGTH);
+            }
+            if (!app_notesSharedPayloadBegin(total_len)) {
+                PRINTF("Wrong payload len %d\n", total_len);
+                return io_send_sw(SW_WRONG_DATA_LENGTH);
+            }
+            return io_send_sw(SW_OK);
+        case P1_NOTE_ENCRYPTED_CONTINUE:
+            // next bytes of the payload, the note being opened with the last ones
+            status = app_notesSharedPayloadReceive(cdata->ptr, cdata->size);
+            if (status < 0) {
+                PRINTF("Too many bytes\n");
+                return io_send_sw(SW_WRONG_DATA_LENGTH);
+            }
+            if (status > 0) {
+                return io_send_sw(SW_OK);
+            }
+            return receive_encrypted_note();
+        default:
+            return io_send_sw(SW_WRONG_P1P2);
+    }
 }
@@ -27,6 +27,7 @@
 #include "sign_tx.h"
 #include "../sw.h"
 #include "../globals.h"
+#include "../key_cache.h"
 #include "../ui/display.h"
 #include "../transaction/types.h"
 #include "../transaction/deserialize.h"
@@ -43,6 +44,16 @@ int handler_sign_tx(buffer_t *cdata, uint8_t chunk, bool more) {
                                     (size_t) G_context.bip32_path_len)) {
             return io_send_sw(SW_WRONG_DATA_LENGTH);
         }
+        // the keys of the app (sharing, storage) never sign
+        if (key_cache_is_app_path(G_context.bip32_path, G_context.bip32_path_len)) {
+            return io_send_sw(SW_WRONG_DATA);
+        }
+        // the transaction is hashed chunk by chunk, so that the last one is answered sooner
+        if (cx_keccak_init_no_throw(&G_context.tx_info.hash_ctx, 256) != CX_OK) {
+            return io_send_sw(SW_TX_HASH_FAIL);
+        }
+        // and parsed chunk by chunk, so that an invalid field is rejected with its chunk
+        transaction_parser_init(&G_context.tx_info.parser, &G_context.tx_info.transaction);
 
         return io_send_sw(SW_OK);
 
@@ -51,15 +62,23 @@ int handler_sign_tx(buffer_t *cdata, uint8_t chunk, bool more) {
         if (G_context.req_type != CONFIRM_TRANSACTION) {
             return io_send_sw(SW_BAD_STATE);
         }
-        if (G_context.tx_info.raw_tx_len + cdata->size > sizeof(G_context.tx_info.raw_tx)) {
+        if (G_context.tx_info.parser.length + cdata->size > MAX_TRANSACTION_LEN) {
             return io_send_sw(SW_WRONG_TX_LENGTH);
         }
-        if (!buffer_move(cdata,
-                         G_context.tx_info.raw_tx + G_context.tx_info.raw_tx_len,
-                         cdata->size)) {
+        if (cx_hash_no_throw(&G_context.tx_info.hash_ctx.header,
+                             more ? 0 : CX_LAST,
+                             cdata->ptr + cdata->offset,
+                             cdata->size - cdata->offset,
+                             G_context.tx_info.m_hash,
+                             sizeof(G_context.tx_info.m_hash)) != CX_OK) {
+            return io_send_sw(SW_TX_HASH_FAIL);
+        }
+
+        parser_status_e status = transaction_parser_update(&G_context.tx_info.parser, cdata);
+        if (status != PARSING_OK) {
+            PRINTF("Parsing status: %d.\n", status);
             return io_send_sw(SW_TX_PARSING_FAIL);
         }
-        G_context.tx_info.raw_tx_len += cdata->size;
 
         if (more) {
             // more APDUs with transaction part are expected.
@@ -67,13 +86,9 @@ int handler_sign_tx(buffer_t *cdata, uint8_t chunk, bool more) {
             return io_send_sw(SW_OK);
 
         } else {
-            // last APDU for this transaction, let's parse, display and request a sign confirmation
-
-            buffer_t buf = {.ptr = G_context.tx_info.raw_tx,
-                            .size = G_context.tx_info.raw_tx_len,
-                            .offset = 0};
-
-            parser_status_e status = transaction_deserialize(&buf, &G_context.tx_info.transaction);
+            // last APDU for this transaction, let's check it is complete, display and request a
+            // sign confirmation
+            status = transaction_parser_finish(&G_context.tx_info.parser);
             PRINTF("Parsing status: %d.\n", status);
             if (status != PARSING_OK) {
                 return io_send_sw(SW_TX_PARSING_FAIL);
@@ -81,12 +96,6 @@ int handler_sign_tx(buffer_t *cdata, uint8_t chunk, bool more) {
 
             G_context.state = STATE_PARSED;
 
-            if (cx_keccak_256_hash(G_context.tx_info.raw_tx,
-                                   G_context.tx_info.raw_tx_len,
-                                   G_context.tx_info.m_hash) != CX_OK) {
-                return io_send_sw(SW_TX_HASH_FAIL);
-            }
-
             PRINTF("Hash: %.*H\n", sizeof(G_context.tx_info.m_hash), G_context.tx_info.m_hash);
 
             return ui_display_transaction();
@@ -23,3 +23,23 @@
  *
  */
 int handler_sign_tx(buffer_t *cdata, uint8_t chunk, bool more);
+
+/**
+ * Handler for SIGN_TX_BATCH command. Receive several transactions signed
+ * with the same BIP32 path, ask the user to approve their summary, then
+ * send APDU responses with their signatures.
+ *
+ * @see G_context.batch_info.
+ *
+ * @param[in,out] cdata
+ *   Command data with BIP32 path and number of transactions, a chunk of a
+ *   transaction, or the index of the next signature to send.
+ * @param[in]     phase
+ *   P1_BATCH_START, P1_BATCH_TX or P1_BATCH_SIGNATURES.
+ * @param[in]     more
+ *   Whether more APDU chunk of the transaction to be received or not.
+ *
+ * @return zero or positive integer if success, negative integer otherwise.
+ *
+ */
+int handler_sign_tx_batch(buffer_t *cdata, uint8_t phase, bool more);
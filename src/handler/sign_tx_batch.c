@@ -0,0 +1,165 @@
+/*****************************************************************************
+ *   Ledger App Secure-Notes.
+ *   (c) 2024 Ledger SAS.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+#include <stdint.h>   // uint*_t
+#include <stdbool.h>  // bool
+#include <string.h>   // memcmp, memmove, explicit_bzero
+
+#include "os.h"
+#include "cx.h"
+#include "io.h"
+#include "buffer.h"
+
+#include "sign_tx.h"
+#include "../sw.h"
+#include "../globals.h"
+#include "../key_cache.h"
+#include "../apdu/dispatcher.h"
+#include "../ui/display.h"
+#include "../helper/send_response.h"
+#include "../transaction/types.h"
+#include "../transaction/deserialize.h"
+
+// the batch is dropped on the first error, so that the next APDUs are rejected
+static int batch_reject(uint16_t sw) {
+    explicit_bzero(&G_context, sizeof(G_context));
+    return io_send_sw(sw);
+}
+
+// add the transaction just received to the summary of the batch
+static bool batch_add_transaction(batch_ctx_t *batch) {
+    const transaction_t *tx = &batch->transaction;
+    uint8_t i;
+
+    if (tx->value > UINT64_MAX - batch->total_value) {
+        return false;
+    }
+    batch->total_value += tx->value;
+
+    for (i = 0; i < batch->nb_destinations; i++) {
+        if (memcmp(batch->destinations[i], tx->to, ADDRESS_LEN) == 0) {
+            return true;
+        }
+    }
+    memmove(batch->destinations[batch->nb_destinations++], tx->to, ADDRESS_LEN);
+    return true;
+}
+
+static int batch_start(buffer_t *cdata) {
+    batch_ctx_t *batch = &G_context.batch_info;
+
+    explicit_bzero(&G_context, sizeof(G_context));
+    G_context.req_type = CONFIRM_TRANSACTION_BATCH;
+    G_context.state = STATE_NONE;
+
+    // BIP32 path of the key signing all the transactions || number of transactions (1)
+    if (!buffer_read_u8(cdata, &G_context.bip32_path_len) ||
+        !buffer_read_bip32_path(cdata, G_context.bip32_path, (size_t) G_context.bip32_path_len) ||
+        !buffer_read_u8(cdata, &batch->nb_tx) || cdata->offset != cdata->size ||
+        batch->nb_tx == 0 || batch->nb_tx > MAX_BATCH_TX) {
+        return batch_reject(SW_WRONG_DATA_LENGTH);
+    }
+    // the keys of the app (sharing, storage) never sign
+    if (key_cache_is_app_path(G_context.bip32_path, G_context.bip32_path_len)) {
+        return batch_reject(SW_WRONG_DATA);
+    }
+    // first transaction
+    if (cx_keccak_init_no_throw(&batch->hash_ctx, 256) != CX_OK) {
+        return batch_reject(SW_TX_HASH_FAIL);
+    }
+    transaction_parser_init(&batch->parser, &batch->transaction);
+
+    return io_send_sw(SW_OK);
+}
+
+static int batch_receive(buffer_t *cdata, bool more) {
+    batch_ctx_t *batch = &G_context.batch_info;
+
+    if (G_context.req_type != CONFIRM_TRANSACTION_BATCH || G_context.state != STATE_NONE ||
+        batch->nb_received >= batch->nb_tx) {
+        return io_send_sw(SW_BAD_STATE);
+    }
+    if (batch->parser.length + cdata->size > MAX_TRANSACTION_LEN) {
+        return batch_reject(SW_WRONG_TX_LENGTH);
+    }
+    // each transaction is hashed and parsed chunk by chunk, as for SIGN_TX
+    if (cx_hash_no_throw(&batch->hash_ctx.header,
+                         more ? 0 : CX_LAST,
+                         cdata->ptr + cdata->offset,
+                         cdata->size - cdata->offset,
+                         batch->m_hash[batch->nb_received],
+                         sizeof(batch->m_hash[batch->nb_received])) != CX_OK) {
+        return batch_reject(SW_TX_HASH_FAIL);
+    }
+    if (transaction_parser_update(&batch->parser, cdata) != PARSING_OK) {
+        return batch_reject(SW_TX_PARSING_FAIL);
+    }
+    if (more) {
+        return io_send_sw(SW_OK);
+    }
+
+    // last chunk of this transaction
+    if (transaction_parser_finish(&batch->parser) != PARSING_OK ||
+        !batch_add_transaction(batch)) {
+        return batch_reject(SW_TX_PARSING_FAIL);
+    }
+    PRINTF("Hash %d: %.*H\n",
+           batch->nb_received,
+           sizeof(batch->m_hash[batch->nb_received]),
+           batch->m_hash[batch->nb_received]);
+    batch->nb_received++;
+
+    if (batch->nb_received < batch->nb_tx) {
+        if (cx_keccak_init_no_throw(&batch->hash_ctx, 256) != CX_OK) {
+            return batch_reject(SW_TX_HASH_FAIL);
+        }
+        transaction_parser_init(&batch->parser, &batch->transaction);
+        return io_send_sw(SW_OK);
+    }
+
+    // all the transactions are received, their summary is reviewed at once
+    G_context.state = STATE_PARSED;
+    return ui_display_transaction_batch();
+}
+
+static int batch_get_signatures(buffer_t *cdata) {
+    uint8_t index = 0;
+
+    if (G_context.req_type != CONFIRM_TRANSACTION_BATCH || G_context.state != STATE_APPROVED) {
+        return io_send_sw(SW_BAD_STATE);
+    }
+    // index of the first signature to send (1)
+    if (!buffer_read_u8(cdata, &index) || cdata->offset != cdata->size ||
+        index >= G_context.batch_info.nb_tx) {
+        return io_send_sw(SW_WRONG_DATA_LENGTH);
+    }
+
+    return helper_send_response_batch_sigs(index);
+}
+
+int handler_sign_tx_batch(buffer_t *cdata, uint8_t phase, bool more) {
+    switch (phase) {
+        case P1_BATCH_START:
+            return batch_start(cdata);
+        case P1_BATCH_TX:
+            return batch_receive(cdata, more);
+        case P1_BATCH_SIGNATURES:
+            return batch_get_signatures(cdata);
+        default:
+            return io_send_sw(SW_WRONG_P1P2);
+    }
+}
@@ -20,11 +20,13 @@
 #include <string.h>  // memmove
 
 #include "buffer.h"
+#include "write.h"
 
 #include "send_response.h"
 #include "../constants.h"
 #include "../globals.h"
 #include "../sw.h"
+#include "../app_notes.h"
 
 int helper_send_response_pubkey() {
     uint8_t resp[1 + PUBKEY_LEN + 1 + CHAINCODE_LEN] = {0};
@@ -51,3 +53,38 @@ int helper_send_response_sig() {
 
     return io_send_response_pointer(resp, offset, SW_OK);
 }
+
+int helper_send_response_batch_sigs(uint8_t index) {
+    const batch_ctx_t *batch = &G_context.batch_info;
+    uint8_t resp[1 + BATCH_SIGS_PER_RESPONSE * (1 + MAX_DER_SIG_LEN + 1)] = {0};
+    size_t offset = 1;
+    uint8_t nb_sigs = 0;
+
+    // number of signatures (1) || for each one, as for SIGN_TX: length (1) || signature || v (1)
+    while (nb_sigs < BATCH_SIGS_PER_RESPONSE && index + nb_sigs < batch->nb_tx) {
+        uint8_t i = index + nb_sigs;
+
+        resp[offset++] = batch->signature_len[i];
+        memmove(resp + offset, batch->signature[i], batch->signature_len[i]);
+        offset += batch->signature_len[i];
+        resp[offset++] = batch->v[i];
+        nb_sigs++;
+    }
+    resp[0] = nb_sigs;
+
+    return io_send_response_pointer(resp, offset, SW_OK);
+}
+
+int helper_send_response_export() {
+    uint8_t resp[4 + EXPORT_CHUNK_LEN] = {0};
+    size_t offset = 4;
+
+    offset += app_notesExport(&G_context.export_info.slot,
+                              &G_context.export_info.offset,
+                              resp + offset,
+                              EXPORT_CHUNK_LEN);
+    write_u16_be(resp, 0, G_context.export_info.slot);
+    write_u16_be(resp, 2, G_context.export_info.offset);
+
+    return io_send_response_pointer(resp, offset, SW_OK);
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <stdint.h>  // uint*_t
+
 #include "os.h"
 #include "macros.h"
 
@@ -37,3 +39,31 @@ int helper_send_response_pubkey(void);
  *
  */
 int helper_send_response_sig(void);
+
+/**
+ * Helper to send APDU response with the signatures of a transaction batch,
+ * from the given one.
+ *
+ * response = nb_sigs (1) ||
+ *            (sig_len (1) || sig (sig_len) || v (1)) * nb_sigs
+ *
+ * @param[in] index
+ *   Index of the first signature to send.
+ *
+ * @return zero or positive integer if success, -1 otherwise.
+ *
+ */
+int helper_send_response_batch_sigs(uint8_t index);
+
+/**
+ * Helper to send APDU response with the next records of the export of
+ * all notes and contacts.
+ *
+ * response = slot of next record (2) ||
+ *            offset of next byte in this record (2) ||
+ *            bytes of the records (EXPORT_CHUNK_LEN max)
+ *
+ * @return zero or positive integer if success, -1 otherwise.
+ *
+ */
+int helper_send_response_export(void);
@@ -0,0 +1,322 @@
+/*****************************************************************************
+ *   Ledger App Boilerplate.
+ *   (c) 2020 Ledger SAS.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+#include <stdint.h>   // uint*_t
+#include <stdbool.h>  // bool
+#include <string.h>   // memcmp, memmove, explicit_bzero
+
+#include "os.h"
+#include "cx.h"
+#include "crypto_helpers.h"
+#include "ledger_assert.h"
+
+#include "key_cache.h"
+
+static key_cache_entry_t key_cache[KEY_CACHE_SIZE];
+static uint32_t key_cache_uses;
+static sharing_key_cache_entry_t sharing_key_cache[SHARING_KEY_CACHE_SIZE];
+static uint32_t sharing_key_cache_uses;
+
+// (p + 1) / 4 for the secp256k1 field, p = 3 mod 4 so that a square root of a is a^((p + 1) / 4)
+static const uint8_t SQRT_EXPONENT[32] = {
+    0x3f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xbf, 0xff, 0xff, 0x0c};
+
+static bool key_cache_match(const key_cache_entry_t *entry,
+                            const uint32_t *bip32_path,
+                            uint8_t bip32_path_len) {
+    return entry->bip32_path_len == bip32_path_len &&
+           memcmp(entry->bip32_path, bip32_path, bip32_path_len * sizeof(uint32_t)) == 0;
+}
+
+cx_err_t key_cache_get(const uint32_t *bip32_path,
+                       uint8_t bip32_path_len,
+                       const key_cache_entry_t **entry) {
+    key_cache_entry_t *oldest = &key_cache[0];
+    cx_ecfp_256_public_key_t public_key;
+    cx_err_t error;
+
+    LEDGER_ASSERT(bip32_path != NULL, "NULL bip32_path");
+    LEDGER_ASSERT(entry != NULL, "NULL entry");
+
+    if (bip32_path_len == 0 || bip32_path_len > MAX_BIP32_PATH) {
+        return CX_INVALID_PARAMETER;
+    }
+
+    for (uint8_t i = 0; i < KEY_CACHE_SIZE; i++) {
+        if (key_cache_match(&key_cache[i], bip32_path, bip32_path_len)) {
+            key_cache[i].last_use = ++key_cache_uses;
+            *entry = &key_cache[i];
+            return CX_OK;
+        }
+        // a free entry has never been used, so it is older than all the others
+        if (key_cache[i].last_use < oldest->last_use) {
+            oldest = &key_cache[i];
+        }
+    }
+
+    // not derived yet in this session
+    explicit_bzero(oldest, sizeof(*oldest));
+    error = bip32_derive_init_privkey_256(CX_CURVE_256K1,
+                                          bip32_path,
+                                          bip32_path_len,
+                                          &oldest->private_key,
+                                          oldest->chain_code);
+    if (error == CX_OK) {
+        error = cx_ecfp_generate_pair_no_throw(CX_CURVE_256K1,
+                                               &public_key,
+                                               &oldest->private_key,
+                                               true);
+    }
+    if (error != CX_OK) {
+        explicit_bzero(oldest, sizeof(*oldest));
+        return error;
+    }
+    memmove(oldest->raw_public_key, public_key.W, sizeof(oldest->raw_public_key));
+    memmove(oldest->bip32_path, bip32_path, bip32_path_len * sizeof(uint32_t));
+    oldest->bip32_path_len = bip32_path_len;
+    oldest->last_use = ++key_cache_uses;
+
+    *entry = oldest;
+    return CX_OK;
+}
+
+cx_err_t key_cache_derive_child(const key_cache_entry_t *parent,
+                                uint32_t index,
+                                uint8_t raw_public_key[static 65]) {
+    cx_hmac_sha512_t hmac;
+    uint8_t data[1 + 32 + 4];
+    uint8_t tweak[CX_SHA512_SIZE];
+    uint8_t order[32];
+    uint8_t child[32];
+    cx_ecfp_256_private_key_t private_key;
+    cx_ecfp_256_public_key_t public_key;
+    int diff = 0;
+    cx_err_t error;
+
+    LEDGER_ASSERT(parent != NULL, "NULL parent");
+
+    // I = HMAC-SHA512(chain code, 0x00 || k_par || index) if hardened,
+    //     HMAC-SHA512(chain code, compressed K_par || index) otherwise
+    if (index & 0x80000000) {
+        data[0] = 0x00;
+        memmove(data + 1, parent->private_key.d, 32);
+    } else {
+        data[0] = (parent->raw_public_key[64] & 1) ? 0x03 : 0x02;
+        memmove(data + 1, parent->raw_public_key + 1, 32);
+    }
+    U4BE_ENCODE(data, 33, index);
+
+    error = cx_hmac_sha512_init_no_throw(&hmac, parent->chain_code, sizeof(parent->chain_code));
+    if (error == CX_OK) {
+        error = cx_hmac_no_throw((cx_hmac_t *) &hmac,
+                                 CX_LAST,
+                                 data,
+                                 sizeof(data),
+                                 tweak,
+                                 sizeof(tweak));
+    }
+    // k_child = I[0:32] + k_par (mod n), the child being invalid if I[0:32] >= n or k_child = 0
+    if (error == CX_OK) {
+        error = cx_ecdomain_parameter(CX_CURVE_256K1, CX_CURVE_PARAM_Order, order, sizeof(order));
+    }
+    if (error == CX_OK) {
+        error = cx_math_cmp_no_throw(tweak, order, sizeof(order), &diff);
+    }
+    if (error == CX_OK && diff >= 0) {
+        error = CX_INVALID_PARAMETER;
+    }
+    if (error == CX_OK) {
+        error = cx_math_addm_no_throw(child, tweak, parent->private_key.d, order, sizeof(child));
+    }
+    if (error == CX_OK && cx_math_is_zero(child, sizeof(child))) {
+        error = CX_INVALID_PARAMETER;
+    }
+    if (error == CX_OK) {
+        error = cx_ecfp_init_private_key_no_throw(CX_CURVE_256K1,
+                                                  child,
+                                                  sizeof(child),
+                                                  &private_key);
+    }
+    if (error == CX_OK) {
+        error = cx_ecfp_generate_pair_no_throw(CX_CURVE_256K1, &public_key, &private_key, true);
+    }
+    if (error == CX_OK) {
+        memmove(raw_public_key, public_key.W, 65);
+    }
+
+    explicit_bzero(&hmac, sizeof(hmac));
+    explicit_bzero(data, sizeof(data));
+    explicit_bzero(tweak, sizeof(tweak));
+    explicit_bzero(child, sizeof(child));
+    explicit_bzero(&private_key, sizeof(private_key));
+
+    return error;
+}
+
+/**
+ * Decompress a public key: y = sqrt(x^3 + 7) mod p, with the parity given by the prefix.
+ */
+static cx_err_t decompress_public_key(const uint8_t public_key[static 33],
+                                      uint8_t raw_public_key[static 65]) {
+    uint8_t field[32];
+    uint8_t seven[32] = {0};
+    uint8_t x2[32];
+    uint8_t rhs[32];
+    uint8_t y[32];
+    uint8_t y2[32];
+    int diff = 0;
+    cx_err_t error;
+
+    if (public_key[0] != 0x02 && public_key[0] != 0x03) {
+        return CX_INVALID_PARAMETER;
+    }
+    seven[31] = 7;
+
+    error = cx_ecdomain_parameter(CX_CURVE_256K1, CX_CURVE_PARAM_Field, field, sizeof(field));
+    // x must be reduced modulo p
+    if (error == CX_OK) {
+        error = cx_math_cmp_no_throw(public_key + 1, field, sizeof(field), &diff);
+    }
+    if (error == CX_OK && diff >= 0) {
+        error = CX_INVALID_PARAMETER;
+    }
+    if (error == CX_OK) {
+        error = cx_math_multm_no_throw(x2, public_key + 1, public_key + 1, field, sizeof(x2));
+    }
+    if (error == CX_OK) {
+        error = cx_math_multm_no_throw(rhs, x2, public_key + 1, field, sizeof(rhs));
+    }
+    if (error == CX_OK) {
+        error = cx_math_addm_no_throw(rhs, rhs, seven, field, sizeof(rhs));
+    }
+    if (error == CX_OK) {
+        error = cx_math_powm_no_throw(y,
+                                      rhs,
+                                      SQRT_EXPONENT,
+                                      sizeof(SQRT_EXPONENT),
+                                      field,
+                                      sizeof(y));
+    }
+    // x^3 + 7 may not be a square, in which case x is not on the curve
+    if (error == CX_OK) {
+        error = cx_math_multm_no_throw(y2, y, y, field, sizeof(y2));
+    }
+    if (error == CX_OK && memcmp(y2, rhs, sizeof(y2)) != 0) {
+        error = CX_INVALID_PARAMETER;
+    }
+    if (error == CX_OK && (y[31] & 1) != (public_key[0] & 1)) {
+        error = cx_math_sub_no_throw(y, field, y, sizeof(y));
+    }
+    if (error == CX_OK) {
+        raw_public_key[0] = 0x04;
+        memmove(raw_public_key + 1, public_key + 1, 32);
+        memmove(raw_public_key + 33, y, 32);
+    }
+
+    return error;
+}
+
+bool key_cache_check_public_key(const uint8_t public_key[static 33]) {
+    uint8_t raw_public_key[65];
+
+    return decompress_public_key(public_key, raw_public_key) == CX_OK;
+}
+
+bool key_cache_is_app_path(const uint32_t *bip32_path, uint8_t bip32_path_len) {
+    return bip32_path_len > 0 && bip32_path[0] == NOTES_BIP32_PURPOSE;
+}
+
+bool key_cache_is_sharing_path(const uint32_t *bip32_path, uint8_t bip32_path_len) {
+    const uint32_t sharing_path[] = SHARING_BIP32_PATH;
+
+    return bip32_path_len == SHARING_BIP32_PATH_LEN &&
+           memcmp(bip32_path, sharing_path, sizeof(sharing_path)) == 0;
+}
+
+cx_err_t key_cache_get_sharing_public_key(uint8_t public_key[static 33]) {
+    const uint32_t bip32_path[] = SHARING_BIP32_PATH;
+    const key_cache_entry_t *own = NULL;
+    cx_err_t error = key_cache_get(bip32_path, SHARING_BIP32_PATH_LEN, &own);
+
+    if (error == CX_OK) {
+        public_key[0] = (own->raw_public_key[64] & 1) ? 0x03 : 0x02;
+        memmove(public_key + 1, own->raw_public_key + 1, 32);
+    }
+    return error;
+}
+
+cx_err_t key_cache_get_sharing_key(uint16_t contact,
+                                   const uint8_t public_key[static 33],
+                                   uint8_t key[static 32]) {
+    const uint32_t bip32_path[] = SHARING_BIP32_PATH;
+    sharing_key_cache_entry_t *oldest = &sharing_key_cache[0];
+    const key_cache_entry_t *own = NULL;
+    uint8_t raw_public_key[65];
+    uint8_t secret[32];
+    cx_err_t error;
+
+    for (uint8_t i = 0; i < SHARING_KEY_CACHE_SIZE; i++) {
+        // the public key is compared too, as the contact may have been replaced
+        if (sharing_key_cache[i].public_key[0] != 0 && sharing_key_cache[i].contact == contact &&
+            memcmp(sharing_key_cache[i].public_key, public_key, 33) == 0) {
+            sharing_key_cache[i].last_use = ++sharing_key_cache_uses;
+            memmove(key, sharing_key_cache[i].key, 32);
+            return CX_OK;
+        }
+        if (sharing_key_cache[i].last_use < oldest->last_use) {
+            oldest = &sharing_key_cache[i];
+        }
+    }
+
+    // first share with this contact in this session
+    error = decompress_public_key(public_key, raw_public_key);
+    if (error == CX_OK) {
+        error = key_cache_get(bip32_path, SHARING_BIP32_PATH_LEN, &own);
+    }
+    if (error == CX_OK) {
+        error = cx_ecdh_no_throw(&own->private_key,
+                                 CX_ECDH_X,
+                                 raw_public_key,
+                                 sizeof(raw_public_key),
+                                 secret,
+                                 sizeof(secret));
+    }
+    if (error == CX_OK && cx_hash_sha256(secret, sizeof(secret), key, 32) != 32) {
+        error = CX_INTERNAL_ERROR;
+    }
+    explicit_bzero(secret, sizeof(secret));
+    if (error != CX_OK) {
+        explicit_bzero(key, 32);
+        return error;
+    }
+
+    explicit_bzero(oldest, sizeof(*oldest));
+    oldest->contact = contact;
+    memmove(oldest->public_key, public_key, sizeof(oldest->public_key));
+    memmove(oldest->key, key, sizeof(oldest->key));
+    oldest->last_use = ++sharing_key_cache_uses;
+
+    return CX_OK;
+}
+
+void key_cache_clear(void) {
+    explicit_bzero(key_cache, sizeof(key_cache));
+    key_cache_uses = 0;
+    explicit_bzero(sharing_key_cache, sizeof(sharing_key_cache));
+    sharing_key_cache_uses = 0;
+}
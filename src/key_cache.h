@@ -0,0 +1,168 @@
+#pragma once
+
+#include <stdint.h>   // uint*_t
+#include <stdbool.h>  // bool
+
+#include "bip32.h"
+#include "cx.h"
+
+/**
+ * Number of keys kept by the cache.
+ */
+#define KEY_CACHE_SIZE 4
+
+/**
+ * Number of contact sharing keys kept by the cache.
+ */
+#define SHARING_KEY_CACHE_SIZE 8
+
+/**
+ * Hardened BIP32 purpose of the keys of the app ("NOTE" = 1313821765'), so they are
+ * never under the signing purpose: the signing handlers reject the paths under it.
+ */
+#define NOTES_BIP32_PURPOSE 0xCE4F5445
+
+/**
+ * BIP32 path of the key used for ECDH with the contacts (m/1313821765'/0'), distinct
+ * from the signing keys.
+ */
+#define SHARING_BIP32_PATH \
+    { NOTES_BIP32_PURPOSE, 0x80000000 }
+#define SHARING_BIP32_PATH_LEN 2
+
+/**
+ * Structure for a key derived in this session.
+ */
+typedef struct {
+    uint32_t bip32_path[MAX_BIP32_PATH];    /// BIP32 path
+    uint8_t bip32_path_len;                 /// length of BIP32 path, 0 if the entry is free
+    uint32_t last_use;                      /// age of the last use, to evict the oldest one
+    uint8_t raw_public_key[65];             /// format (1), x-coordinate (32), y-coodinate (32)
+    uint8_t chain_code[32];                 /// for public key derivation
+    cx_ecfp_256_private_key_t private_key;  /// private key
+} key_cache_entry_t;
+
+/**
+ * Get the keys of a BIP32 path, only deriving them from the seed if they are
+ * not in the cache. The least recently used entry is replaced.
+ *
+ * @param[in]  bip32_path
+ *   Pointer to BIP32 path.
+ * @param[in]  bip32_path_len
+ *   Length of BIP32 path.
+ * @param[out] entry
+ *   Pointer to the entry of the cache, valid until the next call.
+ *
+ * @return CX_OK if success, error of the derivation otherwise.
+ *
+ */
+cx_err_t key_cache_get(const uint32_t *bip32_path,
+                       uint8_t bip32_path_len,
+                       const key_cache_entry_t **entry);
+
+/**
+ * Derive the public key of a child of a cached key (BIP32 CKDpriv), without
+ * deriving the whole path from the seed again.
+ *
+ * @param[in]  parent
+ *   Pointer to the entry of the parent key.
+ * @param[in]  index
+ *   Index of the child, hardened if it has its highest bit set.
+ * @param[out] raw_public_key
+ *   Public key of the child: format (1), x-coordinate (32), y-coordinate (32).
+ *
+ * @return CX_OK if success, error of the derivation otherwise.
+ *
+ */
+cx_err_t key_cache_derive_child(const key_cache_entry_t *parent,
+                                uint32_t index,
+                                uint8_t raw_public_key[static 65]);
+
+/**
+ * Structure for the symmetric key shared with a contact, derived in this session.
+ */
+typedef struct {
+    uint16_t contact;            /// index of the contact
+    uint8_t public_key[33];      /// compressed public key of the contact, 0 if the entry is free
+    uint8_t key[32];             /// SHA-256 of the x-coordinate of the ECDH shared point
+    uint32_t last_use;           /// age of the last use, to evict the oldest one
+} sharing_key_cache_entry_t;
+
+/**
+ * Get the symmetric key shared with a contact, only computing the ECDH between
+ * the sharing key of the app and the public key of the contact if it is not in
+ * the cache. The least recently used entry is replaced.
+ *
+ * @param[in]  contact
+ *   Index of the contact.
+ * @param[in]  public_key
+ *   Compressed public key of the contact: prefix (1), x-coordinate (32).
+ * @param[out] key
+ *   Shared symmetric key.
+ *
+ * @return CX_OK if success, CX_INVALID_PARAMETER if the public key is not on the
+ *   curve, error of the derivation otherwise.
+ *
+ */
+cx_err_t key_cache_get_sharing_key(uint16_t contact,
+                                   const uint8_t public_key[static 33],
+                                   uint8_t key[static 32]);
+
+/**
+ * Get the public key of the sharing key of the app, only deriving it from the seed
+ * if it is not in the cache.
+ *
+ * @param[out] public_key
+ *   Compressed public key: prefix (1), x-coordinate (32).
+ *
+ * @return CX_OK if success, error of the derivation otherwise.
+ *
+ */
+cx_err_t key_cache_get_sharing_public_key(uint8_t public_key[static 33]);
+
+/**
+ * Check that a compressed public key is a point of the curve.
+ *
+ * @param[in]  public_key
+ *   Compressed public key: prefix (1), x-coordinate (32).
+ *
+ * @return true if valid, false otherwise.
+ *
+ */
+bool key_cache_check_public_key(const uint8_t public_key[static 33]);
+
+/**
+ * Check whether a BIP32 path is under the purpose of the keys of the app, which
+ * must neither sign nor be exported.
+ *
+ * @param[in]  bip32_path
+ *   Pointer to BIP32 path.
+ * @param[in]  bip32_path_len
+ *   Length of BIP32 path.
+ *
+ * @return true if the path is under NOTES_BIP32_PURPOSE, false otherwise.
+ *
+ */
+bool key_cache_is_app_path(const uint32_t *bip32_path, uint8_t bip32_path_len);
+
+/**
+ * Check whether a BIP32 path is the one of the sharing key, whose public key is
+ * given to the contacts.
+ *
+ * @param[in]  bip32_path
+ *   Pointer to BIP32 path.
+ * @param[in]  bip32_path_len
+ *   Length of BIP32 path.
+ *
+ * @return true if the path is SHARING_BIP32_PATH, false otherwise.
+ *
+ */
+bool key_cache_is_sharing_path(const uint32_t *bip32_path, uint8_t bip32_path_len);
+
+/**
+ * Wipe all the keys of the cache. It is called when the session is locked, that is
+ * when the app is quit and when the device is locked (see app_notesSessionLock()),
+ * so the keys are derived from the seed again in the next session.
+ *
+ */
+void key_cache_clear(void);
@@ -0,0 +1,107 @@
+/**
+ * @file merkle.c
+ * @brief helpers to compute the root of a Merkle tree of SHA-256 hashes, one leaf at a time
+ *
+ * The tree is the one of RFC 6962: a leaf is hashed with a 0x00 prefix, a node with a 0x01
+ * prefix, the left subtree of a node being the largest complete subtree (the root of an empty
+ * tree is the hash of nothing).
+ */
+
+#include <string.h>
+#include "merkle.h"
+
+#define LEAF_PREFIX 0x00
+#define NODE_PREFIX 0x01
+
+// hash the given left and right subtrees, as the root of their node, in the given buffer (which
+// may be one of them)
+static void hash_node(const uint8_t *left, const uint8_t *right, uint8_t *node)
+{
+    cx_sha256_t hash;
+    uint8_t     prefix = NODE_PREFIX;
+
+    cx_sha256_init_no_throw(&hash);
+    cx_hash_no_throw(&hash.header, 0, &prefix, 1, NULL, 0);
+    cx_hash_no_throw(&hash.header, 0, left, MERKLE_HASH_LEN, NULL, 0);
+    cx_hash_no_throw(&hash.header, CX_LAST, right, MERKLE_HASH_LEN, node, MERKLE_HASH_LEN);
+}
+
+/**
+ * @brief initialize the given tree, without any leaf
+ *
+ * @param ctx tree to initialize
+ */
+void merkle_init(merkle_ctx_t *ctx)
+{
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+/**
+ * @brief start the hash of a leaf, whose data are then added with merkle_leaf_update()
+ *
+ * @param leaf hash to initialize
+ */
+void merkle_leaf_init(cx_sha256_t *leaf)
+{
+    uint8_t prefix = LEAF_PREFIX;
+
+    cx_sha256_init_no_throw(leaf);
+    cx_hash_no_throw(&leaf->header, 0, &prefix, 1, NULL, 0);
+}
+
+/**
+ * @brief add the given data to the hash of a leaf
+ *
+ * @param leaf hash of the leaf, started by merkle_leaf_init()
+ * @param data data to add
+ * @param length length of the data
+ */
+void merkle_leaf_update(cx_sha256_t *leaf, const void *data, size_t length)
+{
+    cx_hash_no_throw(&leaf->header, 0, data, length, NULL, 0);
+}
+
+/**
+ * @brief finish the hash of the given leaf and add it to the given tree, merging the complete
+ * subtrees of the same size
+ *
+ * @param ctx tree to modify (must have less than 2^MERKLE_MAX_DEPTH - 1 leaves)
+ * @param leaf hash of the leaf, started by merkle_leaf_init()
+ */
+void merkle_add_leaf(merkle_ctx_t *ctx, cx_sha256_t *leaf)
+{
+    uint16_t nbLeaves;
+
+    cx_hash_no_throw(
+        &leaf->header, CX_LAST, NULL, 0, ctx->subtrees[ctx->nbSubtrees], MERKLE_HASH_LEN);
+    ctx->nbSubtrees++;
+    ctx->nbLeaves++;
+    // each trailing zero bit of the number of leaves is a pair of subtrees of the same size
+    for (nbLeaves = ctx->nbLeaves; (nbLeaves & 1) == 0; nbLeaves >>= 1) {
+        ctx->nbSubtrees--;
+        hash_node(ctx->subtrees[ctx->nbSubtrees - 1],
+                  ctx->subtrees[ctx->nbSubtrees],
+                  ctx->subtrees[ctx->nbSubtrees - 1]);
+    }
+}
+
+/**
+ * @brief get the root of the given tree, by merging its complete subtrees from the smallest one
+ *
+ * @param ctx tree to finish (it cannot be modified anymore)
+ * @param root buffer filled with the root
+ */
+void merkle_get_root(merkle_ctx_t *ctx, uint8_t root[MERKLE_HASH_LEN])
+{
+    if (ctx->nbSubtrees == 0) {
+        cx_hash_sha256(NULL, 0, root, MERKLE_HASH_LEN);
+        return;
+    }
+    while (ctx->nbSubtrees > 1) {
+        ctx->nbSubtrees--;
+        hash_node(ctx->subtrees[ctx->nbSubtrees - 1],
+                  ctx->subtrees[ctx->nbSubtrees],
+                  ctx->subtrees[ctx->nbSubtrees - 1]);
+    }
+    memcpy(root, ctx->subtrees[0], MERKLE_HASH_LEN);
+}
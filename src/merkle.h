@@ -0,0 +1,38 @@
+/**
+ * @file merkle.h
+ * @brief helpers to compute the root of a Merkle tree of SHA-256 hashes, one leaf at a time
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cx.h"
+
+/**
+ * @brief Length of a hash of the tree
+ *
+ */
+#define MERKLE_HASH_LEN CX_SHA256_SIZE
+
+/**
+ * @brief Max depth of the tree, giving the max number of leaves (2^MERKLE_MAX_DEPTH - 1)
+ *
+ */
+#define MERKLE_MAX_DEPTH 16
+
+/**
+ * @brief Tree being computed, as the roots of its complete subtrees, from the largest one, so
+ * that leaves do not have to be kept
+ *
+ */
+typedef struct {
+    uint8_t  subtrees[MERKLE_MAX_DEPTH][MERKLE_HASH_LEN];
+    uint8_t  nbSubtrees;
+    uint16_t nbLeaves;
+} merkle_ctx_t;
+
+extern void merkle_init(merkle_ctx_t *ctx);
+extern void merkle_leaf_init(cx_sha256_t *leaf);
+extern void merkle_leaf_update(cx_sha256_t *leaf, const void *data, size_t length);
+extern void merkle_add_leaf(merkle_ctx_t *ctx, cx_sha256_t *leaf);
+extern void merkle_get_root(merkle_ctx_t *ctx, uint8_t root[MERKLE_HASH_LEN]);
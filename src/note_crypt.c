@@ -0,0 +1,413 @@
+/**
+ * @file note_crypt.c
+ * @brief authenticated encryption of the titles and contents of the notes stored in NVRAM, with a
+ * key derived from the seed once per session
+ *
+ * An encrypted field is stored as nonce (8) || ciphertext || tag (8). The ciphertext is AES-256 in
+ * CTR mode, with nonce || field || 0 (3) || block number (4) as counter block, and the tag is the
+ * truncated HMAC-SHA256 of index (2) || field (1) || nonce || ciphertext (encrypt-then-MAC). Both
+ * keys are derived from a secret, as HMAC-SHA256(secret, label): to store the notes, it is the
+ * private key of a dedicated BIP32 path, used at the first use of a session, and the keys are
+ * wiped when the session is locked.
+ */
+
+#include <string.h>
+#include "os.h"
+#include "key_cache.h"
+#include "note_crypt.h"
+
+// BIP32 path of the key from which the storage keys are derived (m/1313821765'/1'), under the
+// purpose of the app, which the signing and export commands reject
+#define STORAGE_BIP32_PATH \
+    { NOTES_BIP32_PURPOSE, 0x80000001 }
+#define STORAGE_BIP32_PATH_LEN 2
+
+// offsets of the field and of the block number in the counter block
+#define COUNTER_FIELD_OFFSET NOTE_CRYPT_NONCE_LEN
+#define COUNTER_BLOCK_OFFSET 12
+
+#define AES_BLOCK_LEN 16
+
+static const char ENCRYPTION_LABEL[]     = "Notes encryption";
+static const char AUTHENTICATION_LABEL[] = "Notes authentication";
+
+// keys of the session, derived at the first use since the session was last locked
+static note_crypt_keys_t sessionKeys;
+static bool              isUnlocked = false;
+
+// derive one key from the given secret with the given label
+static bool derive_key(const uint8_t *secret, const char *label, uint8_t key[CX_SHA256_SIZE])
+{
+    cx_hmac_sha256_t hmac;
+    bool             ok;
+
+    ok = (cx_hmac_sha256_init_no_throw(&hmac, secret, NOTE_CRYPT_SECRET_LEN) == CX_OK)
+         && (cx_hmac_no_throw((cx_hmac_t *) &hmac,
+                              CX_LAST,
+                              (const uint8_t *) label,
+                              strlen(label),
+                              key,
+                              CX_SHA256_SIZE)
+             == CX_OK);
+    explicit_bzero(&hmac, sizeof(hmac));
+    return ok;
+}
+
+/**
+ * @brief derive the encryption and authentication keys of the given secret
+ *
+ * @param keys keys to initialize (wiped on failure)
+ * @param secret secret of @ref NOTE_CRYPT_SECRET_LEN bytes
+ * @return true if OK
+ */
+bool note_crypt_keys_init(note_crypt_keys_t *keys, const uint8_t secret[NOTE_CRYPT_SECRET_LEN])
+{
+    uint8_t key[CX_SHA256_SIZE];
+    bool    ok;
+
+    ok = derive_key(secret, ENCRYPTION_LABEL, key)
+         && (cx_aes_init_key_no_throw(key, sizeof(key), &keys->encryption) == CX_OK)
+         && derive_key(secret, AUTHENTICATION_LABEL, keys->authentication);
+    explicit_bzero(key, sizeof(key));
+    if (!ok) {
+        explicit_bzero(keys, sizeof(*keys));
+    }
+    return ok;
+}
+
+/**
+ * @brief derive the keys of the session from the seed, if not done yet
+ *
+ * @return true if OK, false if the keys cannot be derived
+ */
+bool note_crypt_unlock(void)
+{
+    const uint32_t           path[] = STORAGE_BIP32_PATH;
+    const key_cache_entry_t *entry  = NULL;
+
+    if (!isUnlocked) {
+        isUnlocked = (key_cache_get(path, STORAGE_BIP32_PATH_LEN, &entry) == CX_OK)
+                     && note_crypt_keys_init(&sessionKeys, entry->private_key.d);
+    }
+    return isUnlocked;
+}
+
+// encrypt or decrypt the given bytes with the keystream of the given field
+static bool apply_keystream(note_crypt_ctx_t *ctx, const uint8_t *in, uint8_t *out, size_t length)
+{
+    size_t i;
+
+    for (i = 0; i < length; i++) {
+        if ((ctx->position % AES_BLOCK_LEN) == 0) {
+            uint32_t block = ctx->position / AES_BLOCK_LEN;
+
+            ctx->counter[COUNTER_BLOCK_OFFSET]     = block >> 24;
+            ctx->counter[COUNTER_BLOCK_OFFSET + 1] = (block >> 16) & 0xFF;
+            ctx->counter[COUNTER_BLOCK_OFFSET + 2] = (block >> 8) & 0xFF;
+            ctx->counter[COUNTER_BLOCK_OFFSET + 3] = block & 0xFF;
+            if (cx_aes_enc_block(&ctx->keys->encryption, ctx->counter, ctx->keystream)
+                != CX_OK) {
+                return false;
+            }
+        }
+        out[i] = in[i] ^ ctx->keystream[ctx->position % AES_BLOCK_LEN];
+        ctx->position++;
+    }
+    return true;
+}
+
+/**
+ * @brief wipe the keys of the session, which are derived again at their next use: called by
+ * app_notesSessionLock() when the app is quit and when the device is locked
+ *
+ */
+void note_crypt_lock(void)
+{
+    explicit_bzero(&sessionKeys, sizeof(sessionKeys));
+    isUnlocked = false;
+}
+
+/**
+ * @brief start the encryption or the decryption of a field with the given keys
+ *
+ * @param ctx context to initialize
+ * @param keys keys to use, kept until the context is finished
+ * @param index index of the note
+ * @param field field of the note (NOTE_CRYPT_FIELD_xxx)
+ * @param nonce nonce of the field
+ * @return true if OK
+ */
+bool note_crypt_start_keys(note_crypt_ctx_t        *ctx,
+                           const note_crypt_keys_t *keys,
+                           uint16_t                 index,
+                           uint8_t                  field,
+                           const uint8_t            nonce[NOTE_CRYPT_NONCE_LEN])
+{
+    uint8_t header[3] = {index >> 8, index & 0xFF, field};
+
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->keys = keys;
+    memcpy(ctx->counter, nonce, NOTE_CRYPT_NONCE_LEN);
+    ctx->counter[COUNTER_FIELD_OFFSET] = field;
+    return (cx_hmac_sha256_init_no_throw(
+                &ctx->mac, keys->authentication, sizeof(keys->authentication))
+            == CX_OK)
+           && (cx_hmac_no_throw((cx_hmac_t *) &ctx->mac, 0, header, sizeof(header), NULL, 0)
+               == CX_OK)
+           && (cx_hmac_no_throw((cx_hmac_t *) &ctx->mac, 0, nonce, NOTE_CRYPT_NONCE_LEN, NULL, 0)
+               == CX_OK);
+}
+
+/**
+ * @brief start the encryption or the decryption of a field with the keys of the session, deriving
+ * them if needed
+ *
+ * @param ctx context to initialize
+ * @param index index of the note
+ * @param field field of the note (NOTE_CRYPT_FIELD_xxx)
+ * @param nonce nonce of the field
+ * @return true if OK, false if the keys cannot be derived
+ */
+bool note_crypt_start(note_crypt_ctx_t *ctx,
+                      uint16_t          index,
+                      uint8_t           field,
+                      const uint8_t     nonce[NOTE_CRYPT_NONCE_LEN])
+{
+    if (!note_crypt_unlock()) {
+        memset(ctx, 0, sizeof(*ctx));
+        return false;
+    }
+    return note_crypt_start_keys(ctx, &sessionKeys, index, field, nonce);
+}
+
+/**
+ * @brief generate a random nonce for a new encryption of a field
+ *
+ * @param nonce buffer filled with the nonce
+ */
+void note_crypt_new_nonce(uint8_t nonce[NOTE_CRYPT_NONCE_LEN])
+{
+    cx_rng_no_throw(nonce, NOTE_CRYPT_NONCE_LEN);
+}
+
+/**
+ * @brief encrypt the next bytes of a field
+ *
+ * @param ctx context started by note_crypt_start()
+ * @param in plaintext
+ * @param out buffer filled with the ciphertext (may be the plaintext)
+ * @param length number of bytes
+ * @return true if OK
+ */
+bool note_crypt_encrypt(note_crypt_ctx_t *ctx, const uint8_t *in, uint8_t *out, size_t length)
+{
+    return apply_keystream(ctx, in, out, length)
+           && (cx_hmac_no_throw((cx_hmac_t *) &ctx->mac, 0, out, length, NULL, 0) == CX_OK);
+}
+
+/**
+ * @brief authenticate data sent in plaintext with a field, such as the header of a shared note:
+ * it must be given before the first bytes of the field are encrypted or decrypted
+ *
+ * @param ctx context started by note_crypt_start()
+ * @param data data to authenticate
+ * @param length number of bytes
+ * @return true if OK
+ */
+bool note_crypt_authenticate(note_crypt_ctx_t *ctx, const uint8_t *data, size_t length)
+{
+    return cx_hmac_no_throw((cx_hmac_t *) &ctx->mac, 0, data, length, NULL, 0) == CX_OK;
+}
+
+/**
+ * @brief decrypt the next bytes of a field (they are only authentic once checked by
+ * note_crypt_check())
+ *
+ * @param ctx context started by note_crypt_start()
+ * @param in ciphertext
+ * @param out buffer filled with the plaintext (may be the ciphertext)
+ * @param length number of bytes
+ * @return true if OK
+ */
+bool note_crypt_decrypt(note_crypt_ctx_t *ctx, const uint8_t *in, uint8_t *out, size_t length)
+{
+    return (cx_hmac_no_throw((cx_hmac_t *) &ctx->mac, 0, in, length, NULL, 0) == CX_OK)
+           && apply_keystream(ctx, in, out, length);
+}
+
+/**
+ * @brief finish the encryption of a field, and get its tag
+ *
+ * @param ctx context started by note_crypt_start(), wiped
+ * @param tag buffer filled with the tag
+ */
+void note_crypt_finish(note_crypt_ctx_t *ctx, uint8_t tag[NOTE_CRYPT_TAG_LEN])
+{
+    uint8_t mac[CX_SHA256_SIZE];
+
+    cx_hmac_no_throw((cx_hmac_t *) &ctx->mac, CX_LAST, NULL, 0, mac, sizeof(mac));
+    memcpy(tag, mac, NOTE_CRYPT_TAG_LEN);
+    explicit_bzero(mac, sizeof(mac));
+    explicit_bzero(ctx, sizeof(*ctx));
+}
+
+/**
+ * @brief finish the decryption of a field, and check its tag
+ *
+ * @param ctx context started by note_crypt_start(), wiped
+ * @param tag tag stored with the field
+ * @return true if the field is authentic
+ */
+bool note_crypt_check(note_crypt_ctx_t *ctx, const uint8_t tag[NOTE_CRYPT_TAG_LEN])
+{
+    uint8_t expected[NOTE_CRYPT_TAG_LEN];
+    uint8_t diff = 0;
+    uint8_t i;
+
+    note_crypt_finish(ctx, expected);
+    // constant time comparison
+    for (i = 0; i < NOTE_CRYPT_TAG_LEN; i++) {
+        diff |= expected[i] ^ tag[i];
+    }
+    return diff == 0;
+}
+
+/**
+ * @brief encrypt a field in place with the given keys, with a new nonce
+ *
+ * @param keys keys to use
+ * @param index index of the note
+ * @param field field of the note (NOTE_CRYPT_FIELD_xxx)
+ * @param header data sent in plaintext with the field, only authenticated (may be NULL)
+ * @param headerLength length of the header
+ * @param envelope buffer of length + @ref NOTE_CRYPT_OVERHEAD bytes, holding the plaintext after
+ * room for the nonce, filled with nonce || ciphertext || tag
+ * @param length length of the plaintext
+ * @return true if OK
+ */
+bool note_crypt_seal_keys(const note_crypt_keys_t *keys,
+                          uint16_t                 index,
+                          uint8_t                  field,
+                          const uint8_t           *header,
+                          size_t                   headerLength,
+                          uint8_t                 *envelope,
+                          size_t                   length)
+{
+    note_crypt_ctx_t ctx;
+    uint8_t         *data = &envelope[NOTE_CRYPT_NONCE_LEN];
+
+    note_crypt_new_nonce(envelope);
+    if (!note_crypt_start_keys(&ctx, keys, index, field, envelope)
+        || ((headerLength > 0) && !note_crypt_authenticate(&ctx, header, headerLength))
+        || !note_crypt_encrypt(&ctx, data, data, length)) {
+        explicit_bzero(&ctx, sizeof(ctx));
+        return false;
+    }
+    note_crypt_finish(&ctx, &data[length]);
+    return true;
+}
+
+/**
+ * @brief encrypt a field in place with the keys of the session, with a new nonce
+ *
+ * @param index index of the note
+ * @param field field of the note (NOTE_CRYPT_FIELD_xxx)
+ * @param envelope buffer of length + @ref NOTE_CRYPT_OVERHEAD bytes, holding the plaintext after
+ * room for the nonce, filled with nonce || ciphertext || tag
+ * @param length length of the plaintext
+ * @return true if OK, false if the keys cannot be derived
+ */
+bool note_crypt_seal(uint16_t index, uint8_t field, uint8_t *envelope, size_t length)
+{
+    return note_crypt_unlock()
+           && note_crypt_seal_keys(&sessionKeys, index, field, NULL, 0, envelope, length);
+}
+
+/**
+ * @brief check the tag of a field encrypted with the given keys, then only decrypt it
+ *
+ * @param keys keys to use
+ * @param index index of the note
+ * @param field field of the note (NOTE_CRYPT_FIELD_xxx)
+ * @param header data sent in plaintext with the field, only authenticated (may be NULL)
+ * @param headerLength length of the header
+ * @param envelope nonce || ciphertext || tag
+ * @param length length of the envelope
+ * @param out buffer of at least length - @ref NOTE_CRYPT_OVERHEAD bytes, filled with the
+ * plaintext if authentic (may be the ciphertext)
+ * @return length of the plaintext, or -1 if the field is not authentic
+ */
+int note_crypt_open_keys(const note_crypt_keys_t *keys,
+                         uint16_t                 index,
+                         uint8_t                  field,
+                         const uint8_t           *header,
+                         size_t                   headerLength,
+                         const uint8_t           *envelope,
+                         size_t                   length,
+                         uint8_t                 *out)
+{
+    note_crypt_ctx_t ctx;
+    const uint8_t   *data = &envelope[NOTE_CRYPT_NONCE_LEN];
+    size_t           plainLength;
+    bool             ok;
+
+    if (length < NOTE_CRYPT_OVERHEAD) {
+        return -1;
+    }
+    plainLength = length - NOTE_CRYPT_OVERHEAD;
+    // nothing is decrypted before the whole field is authenticated
+    if (!note_crypt_start_keys(&ctx, keys, index, field, envelope)
+        || ((headerLength > 0) && !note_crypt_authenticate(&ctx, header, headerLength))
+        || !note_crypt_authenticate(&ctx, data, plainLength)) {
+        explicit_bzero(&ctx, sizeof(ctx));
+        return -1;
+    }
+    if (!note_crypt_check(&ctx, &data[plainLength])) {
+        return -1;
+    }
+    ok = note_crypt_start_keys(&ctx, keys, index, field, envelope)
+         && apply_keystream(&ctx, data, out, plainLength);
+    explicit_bzero(&ctx, sizeof(ctx));
+    if (!ok) {
+        explicit_bzero(out, plainLength);
+        return -1;
+    }
+    return (int) plainLength;
+}
+
+/**
+ * @brief authenticate and decrypt a field
+ *
+ * @param index index of the note
+ * @param field field of the note (NOTE_CRYPT_FIELD_xxx)
+ * @param envelope nonce || ciphertext || tag
+ * @param length length of the envelope
+ * @param out buffer of at least length - @ref NOTE_CRYPT_OVERHEAD bytes, filled with the
+ * plaintext (wiped if not authentic)
+ * @return length of the plaintext, or -1 if the field is not authentic
+ */
+int note_crypt_open(uint16_t       index,
+                    uint8_t        field,
+                    const uint8_t *envelope,
+                    size_t         length,
+                    uint8_t       *out)
+{
+    note_crypt_ctx_t ctx;
+    size_t           plainLength;
+
+    if (length < NOTE_CRYPT_OVERHEAD) {
+        return -1;
+    }
+    plainLength = length - NOTE_CRYPT_OVERHEAD;
+    if (!note_crypt_start(&ctx, index, field, envelope)
+        || !note_crypt_decrypt(&ctx, &envelope[NOTE_CRYPT_NONCE_LEN], out, plainLength)) {
+        explicit_bzero(&ctx, sizeof(ctx));
+        explicit_bzero(out, plainLength);
+        return -1;
+    }
+    if (!note_crypt_check(&ctx, &envelope[NOTE_CRYPT_NONCE_LEN + plainLength])) {
+        explicit_bzero(out, plainLength);
+        return -1;
+    }
+    return (int) plainLength;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file note_crypt.h
+ * @brief authenticated encryption of the titles and contents of the notes stored in NVRAM, with a
+ * key derived from the seed once per session
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "cx.h"
+
+/**
+ * @brief Length of the random nonce stored before an encrypted field
+ *
+ */
+#define NOTE_CRYPT_NONCE_LEN 8
+
+/**
+ * @brief Length of the authentication tag stored after an encrypted field
+ *
+ */
+#define NOTE_CRYPT_TAG_LEN 8
+
+/**
+ * @brief Number of bytes added to a field by its encryption: nonce || ciphertext || tag
+ *
+ */
+#define NOTE_CRYPT_OVERHEAD (NOTE_CRYPT_NONCE_LEN + NOTE_CRYPT_TAG_LEN)
+
+/**
+ * @brief Length of the secret from which a pair of keys is derived
+ *
+ */
+#define NOTE_CRYPT_SECRET_LEN 32
+
+/**
+ * @brief Possible fields of a note, authenticated with their note index so that an encrypted
+ * field cannot be moved to another note or field
+ *
+ */
+#define NOTE_CRYPT_FIELD_TITLE              0x01
+#define NOTE_CRYPT_FIELD_CONTENT            0x02
+#define NOTE_CRYPT_FIELD_COMPRESSED_CONTENT 0x03
+#define NOTE_CRYPT_FIELD_CONTENT_KEY        0x04  ///< key of a shared note, wrapped for a contact
+#define NOTE_CRYPT_FIELD_SHARED_NOTE        0x05  ///< shared note, encrypted with its content key
+
+/**
+ * @brief Keys derived from a secret: the ones of the session to store the notes, or the ones of a
+ * shared note
+ *
+ */
+typedef struct {
+    cx_aes_key_t encryption;
+    uint8_t      authentication[CX_SHA256_SIZE];
+} note_crypt_keys_t;
+
+/**
+ * @brief Encryption or decryption of a field in progress, which can be fed in pieces of any size
+ *
+ */
+typedef struct {
+    cx_hmac_sha256_t         mac;
+    const note_crypt_keys_t *keys;
+    uint8_t                  counter[16];    // nonce || field || block counter
+    uint8_t                  keystream[16];  // keystream of the current block
+    uint16_t                 position;       // number of bytes already processed
+} note_crypt_ctx_t;
+
+extern bool note_crypt_keys_init(note_crypt_keys_t *keys,
+                                 const uint8_t      secret[NOTE_CRYPT_SECRET_LEN]);
+extern bool note_crypt_unlock(void);
+extern void note_crypt_lock(void);
+extern bool note_crypt_start_keys(note_crypt_ctx_t        *ctx,
+                                  const note_crypt_keys_t *keys,
+                                  uint16_t                 index,
+                                  uint8_t                  field,
+                                  const uint8_t            nonce[NOTE_CRYPT_NONCE_LEN]);
+extern bool note_crypt_start(note_crypt_ctx_t *ctx,
+                             uint16_t          index,
+                             uint8_t           field,
+                             const uint8_t     nonce[NOTE_CRYPT_NONCE_LEN]);
+extern void note_crypt_new_nonce(uint8_t nonce[NOTE_CRYPT_NONCE_LEN]);
+extern bool note_crypt_encrypt(note_crypt_ctx_t *ctx,
+                               const uint8_t    *in,
+                               uint8_t          *out,
+                               size_t            length);
+extern bool note_crypt_authenticate(note_crypt_ctx_t *ctx, const uint8_t *data, size_t length);
+extern bool note_crypt_decrypt(note_crypt_ctx_t *ctx,
+                               const uint8_t    *in,
+                               uint8_t          *out,
+                               size_t            length);
+extern void note_crypt_finish(note_crypt_ctx_t *ctx, uint8_t tag[NOTE_CRYPT_TAG_LEN]);
+extern bool note_crypt_check(note_crypt_ctx_t *ctx, const uint8_t tag[NOTE_CRYPT_TAG_LEN]);
+extern bool note_crypt_seal_keys(const note_crypt_keys_t *keys,
+                                 uint16_t                 index,
+                                 uint8_t                  field,
+                                 const uint8_t           *header,
+                                 size_t                   headerLength,
+                                 uint8_t                 *envelope,
+                                 size_t                   length);
+extern bool note_crypt_seal(uint16_t index, uint8_t field, uint8_t *envelope, size_t length);
+extern int  note_crypt_open_keys(const note_crypt_keys_t *keys,
+                                 uint16_t                 index,
+                                 uint8_t                  field,
+                                 const uint8_t           *header,
+                                 size_t                   headerLength,
+                                 const uint8_t           *envelope,
+                                 size_t                   length,
+                                 uint8_t                 *out);
+extern int  note_crypt_open(uint16_t       index,
+                            uint8_t        field,
+                            const uint8_t *envelope,
+                            size_t         length,
+                            uint8_t       *out);
@@ -0,0 +1,301 @@
+/**
+ * @file note_share.c
+ * @brief payload of a note shared with several contacts at once: the note is encrypted once with
+ * a random content key, which is wrapped for each of the contacts
+ *
+ * The payload is version (1) || sender public key (33) || nb_recipients (1) || recipients ||
+ * encrypted note, where:
+ * - the sender public key is the compressed public key of the sharing key of the device, from
+ *   which a contact computes the key it shares with the device
+ * - a recipient is the compressed public key of the contact (33) || the content key, encrypted
+ *   with the keys derived from the key shared with the contact (field CONTENT_KEY, index 0), the
+ *   version and the sender public key being authenticated with it
+ * - the encrypted note is title_len (1) || content_len (2) || title || content, encrypted with the
+ *   keys derived from the content key (field SHARED_NOTE, index 0), all the bytes before it being
+ *   authenticated with it
+ * both as nonce (8) || ciphertext || tag (8), see note_crypt.c. So the note is encrypted only once
+ * whatever the number of contacts, each of them unwrapping the content key with its own share.
+ *
+ * A payload is received in the same buffer as the one being sent, which is dropped: the recipient
+ * of the device is found by its public key, and each field is only decrypted once authentic.
+ */
+
+#include <string.h>
+#include "os.h"
+#include "note_share.h"
+
+// offsets in the payload
+#define VERSION_OFFSET       0
+#define SENDER_OFFSET        1
+#define NB_RECIPIENTS_OFFSET (SENDER_OFFSET + CONTACT_PUBLIC_KEY_LEN)
+#define RECIPIENTS_OFFSET    NOTE_SHARE_HEADER_LEN
+
+// the number of recipients is stored on one byte
+_Static_assert(NOTE_SHARE_MAX_RECIPIENTS <= 255, "Too many recipients for the payload");
+
+static uint8_t  payload[NOTE_SHARE_MAX_PAYLOAD_LEN];
+static uint16_t payloadLength  = 0;  // length of the finished payload, 0 if none
+static uint16_t expectedLength = 0;  // length of the payload being received, 0 if none
+static uint16_t receivedLength = 0;  // number of bytes of the payload already received
+static uint8_t  contentKey[NOTE_SHARE_KEY_LEN];
+static bool     isStarted = false;
+
+/**
+ * @brief start a new payload with a new random content key, dropping the previous one
+ *
+ * @param senderPublicKey compressed public key of the sharing key of the device
+ * @return true if OK
+ */
+bool note_share_begin(const uint8_t senderPublicKey[CONTACT_PUBLIC_KEY_LEN])
+{
+    note_share_clear();
+    cx_rng_no_throw(contentKey, sizeof(contentKey));
+    payload[VERSION_OFFSET] = NOTE_SHARE_VERSION;
+    memcpy(&payload[SENDER_OFFSET], senderPublicKey, CONTACT_PUBLIC_KEY_LEN);
+    payload[NB_RECIPIENTS_OFFSET] = 0;
+    isStarted                     = true;
+    return true;
+}
+
+/**
+ * @brief wrap the content key for a contact
+ *
+ * @param publicKey compressed public key of the contact, to let it find its recipient
+ * @param sharingKey symmetric key shared with the contact
+ * @return true if OK, false if not started or already @ref NOTE_SHARE_MAX_RECIPIENTS contacts
+ */
+bool note_share_add_recipient(const uint8_t publicKey[CONTACT_PUBLIC_KEY_LEN],
+                              const uint8_t sharingKey[SHARING_KEY_LEN])
+{
+    note_crypt_keys_t keys;
+    uint8_t           nbRecipients = payload[NB_RECIPIENTS_OFFSET];
+    uint8_t          *recipient;
+    bool              ok;
+
+    if (!isStarted || (nbRecipients >= NOTE_SHARE_MAX_RECIPIENTS)) {
+        return false;
+    }
+    recipient = &payload[RECIPIENTS_OFFSET + (nbRecipients * NOTE_SHARE_RECIPIENT_LEN)];
+    memcpy(recipient, publicKey, CONTACT_PUBLIC_KEY_LEN);
+    recipient += CONTACT_PUBLIC_KEY_LEN;
+    memcpy(&recipient[NOTE_CRYPT_NONCE_LEN], contentKey, sizeof(contentKey));
+    ok = note_crypt_keys_init(&keys, sharingKey)
+         && note_crypt_seal_keys(&keys,
+                                 0,
+                                 NOTE_CRYPT_FIELD_CONTENT_KEY,
+                                 payload,
+                                 NB_RECIPIENTS_OFFSET,
+                                 recipient,
+                                 sizeof(contentKey));
+    explicit_bzero(&keys, sizeof(keys));
+    if (!ok) {
+        explicit_bzero(recipient, NOTE_SHARE_RECIPIENT_LEN - CONTACT_PUBLIC_KEY_LEN);
+        return false;
+    }
+    payload[NB_RECIPIENTS_OFFSET] = nbRecipients + 1;
+    return true;
+}
+
+/**
+ * @brief encrypt the note with the content key after the recipients, authenticating all of them,
+ * and wipe the content key
+ *
+ * @param title title of the note
+ * @param content content of the note
+ * @return length of the payload, or -1 if there is no recipient or the note is too long
+ */
+int note_share_finish(const char *title, const char *content)
+{
+    note_crypt_keys_t keys;
+    size_t            titleLength   = strlen(title);
+    size_t            contentLength = strlen(content);
+    size_t            noteLength    = 3 + titleLength + contentLength;
+    uint8_t          *envelope;
+    uint8_t          *note;
+    bool              ok;
+
+    if (!isStarted || (payload[NB_RECIPIENTS_OFFSET] == 0) || (titleLength >= NOTE_TITLE_MAX_LEN)
+        || (contentLength >= NOTE_CONTENT_MAX_LEN)) {
+        note_share_clear();
+        return -1;
+    }
+    envelope = &payload[RECIPIENTS_OFFSET
+                        + (payload[NB_RECIPIENTS_OFFSET] * NOTE_SHARE_RECIPIENT_LEN)];
+    note     = &envelope[NOTE_CRYPT_NONCE_LEN];
+    note[0]  = titleLength;
+    note[1]  = contentLength >> 8;
+    note[2]  = contentLength & 0xFF;
+    memcpy(&note[3], title, titleLength);
+    memcpy(&note[3 + titleLength], content, contentLength);
+    ok = note_crypt_keys_init(&keys, contentKey)
+         && note_crypt_seal_keys(&keys,
+                                 0,
+                                 NOTE_CRYPT_FIELD_SHARED_NOTE,
+                                 payload,
+                                 envelope - payload,
+                                 envelope,
+                                 noteLength);
+    explicit_bzero(&keys, sizeof(keys));
+    explicit_bzero(contentKey, sizeof(contentKey));
+    isStarted = false;
+    if (!ok) {
+        note_share_clear();
+        return -1;
+    }
+    payloadLength = (envelope - payload) + NOTE_CRYPT_OVERHEAD + noteLength;
+    return payloadLength;
+}
+
+/**
+ * @brief get the finished payload
+ *
+ * @param length filled with the length of the payload
+ * @return the payload, or NULL if none is finished
+ */
+const uint8_t *note_share_get_payload(uint16_t *length)
+{
+    if (payloadLength == 0) {
+        return NULL;
+    }
+    *length = payloadLength;
+    return payload;
+}
+
+/**
+ * @brief start receiving a payload, dropping the one being sent or received
+ *
+ * @param length length of the whole payload
+ * @return true if OK, false if the length cannot be the one of a payload for at most
+ * @ref NOTE_SHARE_MAX_RECIPIENTS contacts
+ */
+bool note_share_receive_begin(uint16_t length)
+{
+    note_share_clear();
+    if ((length < (NOTE_SHARE_HEADER_LEN + NOTE_SHARE_RECIPIENT_LEN + NOTE_CRYPT_OVERHEAD + 3))
+        || (length > NOTE_SHARE_MAX_PAYLOAD_LEN)) {
+        return false;
+    }
+    expectedLength = length;
+    return true;
+}
+
+/**
+ * @brief receive the next bytes of the payload
+ *
+ * @param bytes next bytes of the payload
+ * @param length number of bytes
+ * @return number of bytes still to be received, or -1 if no payload is being received or if
+ * there are too many bytes (the payload is then dropped)
+ */
+int note_share_receive(const uint8_t *bytes, uint16_t length)
+{
+    if ((expectedLength == 0) || (length > (expectedLength - receivedLength))) {
+        note_share_clear();
+        return -1;
+    }
+    memcpy(&payload[receivedLength], bytes, length);
+    receivedLength += length;
+    return expectedLength - receivedLength;
+}
+
+/**
+ * @brief get the public key of the sender of the received payload
+ *
+ * @return the compressed public key of the sender, or NULL if the payload is not complete or of
+ * another version
+ */
+const uint8_t *note_share_get_sender(void)
+{
+    if ((expectedLength == 0) || (receivedLength != expectedLength)
+        || (payload[VERSION_OFFSET] != NOTE_SHARE_VERSION)) {
+        return NULL;
+    }
+    return &payload[SENDER_OFFSET];
+}
+
+/**
+ * @brief find the recipient of the device in the received payload, unwrap the content key and
+ * decrypt the note in place, each of them being only decrypted once authentic
+ *
+ * @param publicKey compressed public key of the sharing key of the device
+ * @param sharingKey symmetric key shared with the sender
+ * @param titleLength filled with the length of the title
+ * @param contentLength filled with the length of the content
+ * @return the title followed by the content (without final '\0'), valid until the payload is
+ * dropped, or NULL if the device is not a recipient or the payload is not authentic
+ */
+const uint8_t *note_share_open(const uint8_t publicKey[CONTACT_PUBLIC_KEY_LEN],
+                               const uint8_t sharingKey[SHARING_KEY_LEN],
+                               uint8_t      *titleLength,
+                               uint16_t     *contentLength)
+{
+    note_crypt_keys_t keys;
+    uint8_t           nbRecipients = payload[NB_RECIPIENTS_OFFSET];
+    uint16_t          envelopeOffset;
+    const uint8_t    *recipient  = NULL;
+    uint8_t          *note;
+    int               noteLength = -1;
+    uint8_t           i;
+
+    if ((note_share_get_sender() == NULL) || (nbRecipients == 0)
+        || (nbRecipients > NOTE_SHARE_MAX_RECIPIENTS)) {
+        return NULL;
+    }
+    envelopeOffset = RECIPIENTS_OFFSET + (nbRecipients * NOTE_SHARE_RECIPIENT_LEN);
+    if ((envelopeOffset + NOTE_CRYPT_OVERHEAD + 3) > expectedLength) {
+        return NULL;
+    }
+    note = &payload[envelopeOffset + NOTE_CRYPT_NONCE_LEN];
+    for (i = 0; (i < nbRecipients) && (recipient == NULL); i++) {
+        const uint8_t *entry = &payload[RECIPIENTS_OFFSET + (i * NOTE_SHARE_RECIPIENT_LEN)];
+
+        if (memcmp(entry, publicKey, CONTACT_PUBLIC_KEY_LEN) == 0) {
+            recipient = &entry[CONTACT_PUBLIC_KEY_LEN];
+        }
+    }
+    if ((recipient != NULL) && note_crypt_keys_init(&keys, sharingKey)
+        && (note_crypt_open_keys(&keys,
+                                 0,
+                                 NOTE_CRYPT_FIELD_CONTENT_KEY,
+                                 payload,
+                                 NB_RECIPIENTS_OFFSET,
+                                 recipient,
+                                 NOTE_SHARE_RECIPIENT_LEN - CONTACT_PUBLIC_KEY_LEN,
+                                 contentKey)
+            == sizeof(contentKey))
+        && note_crypt_keys_init(&keys, contentKey)) {
+        noteLength = note_crypt_open_keys(&keys,
+                                          0,
+                                          NOTE_CRYPT_FIELD_SHARED_NOTE,
+                                          payload,
+                                          envelopeOffset,
+                                          &payload[envelopeOffset],
+                                          expectedLength - envelopeOffset,
+                                          note);
+    }
+    explicit_bzero(&keys, sizeof(keys));
+    explicit_bzero(contentKey, sizeof(contentKey));
+    // the authentic note must still have consistent lengths
+    if ((noteLength < 3) || (note[0] >= NOTE_TITLE_MAX_LEN)
+        || (((note[1] << 8) | note[2]) >= NOTE_CONTENT_MAX_LEN)
+        || (noteLength != (3 + note[0] + ((note[1] << 8) | note[2])))) {
+        return NULL;
+    }
+    *titleLength   = note[0];
+    *contentLength = (note[1] << 8) | note[2];
+    return &note[3];
+}
+
+/**
+ * @brief drop the payload, sent or received, in progress or finished
+ *
+ */
+void note_share_clear(void)
+{
+    explicit_bzero(payload, sizeof(payload));
+    explicit_bzero(contentKey, sizeof(contentKey));
+    payloadLength  = 0;
+    expectedLength = 0;
+    receivedLength = 0;
+    isStarted      = false;
+}
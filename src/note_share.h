@@ -0,0 +1,73 @@
+/**
+ * @file note_share.h
+ * @brief payload of a note shared with several contacts at once: the note is encrypted once with
+ * a random content key, which is wrapped for each of the contacts
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "app_notes.h"
+#include "note_crypt.h"
+
+/**
+ * @brief Version of the format of the payload, as its first byte
+ *
+ */
+#define NOTE_SHARE_VERSION 0x02
+
+/**
+ * @brief Max number of contacts receiving a note at once, bounded by the RAM of the payload (the
+ * format allows up to 255): the keys shared with the contacts not in the cache are computed again
+ *
+ */
+#define NOTE_SHARE_MAX_RECIPIENTS 16
+
+/**
+ * @brief Length of the random content key of a shared note
+ *
+ */
+#define NOTE_SHARE_KEY_LEN NOTE_CRYPT_SECRET_LEN
+
+/**
+ * @brief Length of a recipient in the payload: compressed public key || wrapped content key
+ *
+ */
+#define NOTE_SHARE_RECIPIENT_LEN \
+    (CONTACT_PUBLIC_KEY_LEN + NOTE_CRYPT_NONCE_LEN + NOTE_SHARE_KEY_LEN + NOTE_CRYPT_TAG_LEN)
+
+/**
+ * @brief Max length of the plaintext of a shared note: title_len (1) || content_len (2) || title
+ * || content
+ *
+ */
+#define NOTE_SHARE_MAX_NOTE_LEN (3 + (NOTE_TITLE_MAX_LEN - 1) + (NOTE_CONTENT_MAX_LEN - 1))
+
+/**
+ * @brief Length of the header of the payload: version (1) || sender public key (33) ||
+ * nb_recipients (1)
+ *
+ */
+#define NOTE_SHARE_HEADER_LEN (2 + CONTACT_PUBLIC_KEY_LEN)
+
+/**
+ * @brief Max length of the payload: header || recipients || encrypted note
+ *
+ */
+#define NOTE_SHARE_MAX_PAYLOAD_LEN                                                     \
+    (NOTE_SHARE_HEADER_LEN + (NOTE_SHARE_MAX_RECIPIENTS * NOTE_SHARE_RECIPIENT_LEN) \
+     + NOTE_CRYPT_OVERHEAD + NOTE_SHARE_MAX_NOTE_LEN)
+
+extern bool           note_share_begin(const uint8_t senderPublicKey[CONTACT_PUBLIC_KEY_LEN]);
+extern bool           note_share_add_recipient(const uint8_t publicKey[CONTACT_PUBLIC_KEY_LEN],
+                                               const uint8_t sharingKey[SHARING_KEY_LEN]);
+extern int            note_share_finish(const char *title, const char *content);
+extern const uint8_t *note_share_get_payload(uint16_t *length);
+extern bool           note_share_receive_begin(uint16_t length);
+extern int            note_share_receive(const uint8_t *bytes, uint16_t length);
+extern const uint8_t *note_share_get_sender(void);
+extern const uint8_t *note_share_open(const uint8_t publicKey[CONTACT_PUBLIC_KEY_LEN],
+                                      const uint8_t sharingKey[SHARING_KEY_LEN],
+                                      uint8_t      *titleLength,
+                                      uint16_t     *contentLength);
+extern void           note_share_clear(void);
@@ -6,6 +6,7 @@
 
 #include <stdint.h>
 #include "app_notes.h"
+#include "bitmap.h"
 
 typedef struct {
     bool    locked;
@@ -14,30 +15,171 @@ typedef struct {
     uint8_t digits[8];
 } NvramSettings_t;
 
+typedef struct {
+    const char name[CONTACT_NAME_LEN];
+    const char address[CONTACT_ADDRESS_MAX_LEN];
+} NvramContact_t;
+
+/**
+ * @brief One of the two copies of a contact slot. A contact is modified by writing the copy
+ * which is not the current one, the current copy being the valid one with the greatest sequence
+ * number.
+ *
+ */
+typedef struct {
+    uint32_t       seq;      ///< sequence number of the write of this copy, which is also the
+                             ///< number of writes of the slot
+    NvramContact_t contact;  ///< name and address of the contact
+    uint16_t       crc;      ///< CRC-16 of all previous fields (the copy is valid only if correct)
+    uint16_t       unused;
+} NvramContactCopy_t;
+
+/**
+ * @brief Size in bytes of each of the two banks of the notes heap
+ * @note on all targets, a bank holds the 32 notes of version 1 at their maximum length, and the
+ * second bank starts after all the data of version 1, so that it can be converted in place
+ *
+ */
+#if defined(TARGET_STAX) || defined(TARGET_FLEX)
+#define NOTES_HEAP_BANK_SIZE 32768
+#else  // TARGET_STAX || TARGET_FLEX
+#define NOTES_HEAP_BANK_SIZE 24576
+#endif  // TARGET_STAX || TARGET_FLEX
+
+/**
+ * @brief Number of flash pages of each bank of the notes heap, for which writes are counted
+ *
+ */
+#define NOTES_HEAP_BANK_PAGES (NOTES_HEAP_BANK_SIZE / NVRAM_PAGE_SIZE)
+
+/**
+ * @brief Possible types of a note record
+ *
+ */
+#define NOTES_HEAP_RECORD_UPDATE 1  ///< new title and/or content of a note (creating it if unused)
+#define NOTES_HEAP_RECORD_DELETE 2  ///< deletion of a note (without data)
+#define NOTES_HEAP_RECORD_DRAFT  3  ///< start of the edition of a note, whose modifications are
+                                    ///< kept in RAM until saved by its next record (without data)
+
+/**
+ * @brief Possible flags of a note record
+ *
+ */
+#define NOTES_HEAP_FLAG_COMPRESSED 0x0001  ///< content is compressed with text_codec_compress()
+#define NOTES_HEAP_FLAG_CORRUPTED  0x0002  ///< data were already corrupted when the note was packed
+                                           ///< in this record (its CRC is the one of the corrupted
+                                           ///< data)
+#define NOTES_HEAP_FLAG_ENCRYPTED_TITLE   0x0004  ///< title is encrypted (see note_crypt.h)
+#define NOTES_HEAP_FLAG_ENCRYPTED_CONTENT 0x0008  ///< content is encrypted (see note_crypt.h)
+
+/**
+ * @brief Header of a record of the notes heap, immediately followed by its data: the new title
+ * (if any) then the new content (if any), each of them stored as nonce || ciphertext || tag once
+ * encrypted. Each record is a single mutation of a note, written by a single NVRAM write. The size
+ * of a full record is rounded up to a multiple of 4 bytes.
+ *
+ */
+typedef struct {
+    uint32_t seq;            ///< sequence number of the mutation
+    uint16_t generation;     ///< generation of the bank when this record was appended
+    uint16_t index;          ///< index of the note
+    uint8_t  type;           ///< type of record (NOTES_HEAP_RECORD_xxx)
+    uint8_t  unused;
+    uint16_t titleLength;    ///< length of the new title, including final '\0' and encryption
+                             ///< (0 if unchanged)
+    uint16_t contentLength;  ///< length of the new content, including final '\0' if not
+                             ///< compressed, and encryption (0 if unchanged)
+    uint16_t flags;          ///< combination of NOTES_HEAP_FLAG_xxx
+    uint16_t dataCrc;        ///< CRC-16 of the data following this header
+    uint16_t headerCrc;      ///< CRC-16 of all previous fields (the record is valid only if
+                             ///< correct)
+} NvramNoteRecord_t;
+
+/**
+ * @brief Bank of the notes heap. Each mutation of a note is appended as a new record in the
+ * active bank, superseding the previous ones. When the active bank is full, the live notes are
+ * packed in the other bank, which then becomes the active one.
+ *
+ */
+typedef struct {
+    uint32_t generation;  ///< the active bank is the one with the greatest generation (0 if unused)
+    uint32_t seq;         ///< first sequence number not used when the bank was packed
+    uint32_t pageWrites[2][NOTES_HEAP_BANK_PAGES];  ///< number of writes of each page of both
+                                                    ///< banks, before this bank was packed
+    uint32_t noteSeqs[NB_MAX_NOTES];  ///< sequence number of the last mutation of each note when
+                                      ///< this bank was packed (0 if never used), which keeps the
+                                      ///< deletions of the notes whose records were dropped
+    uint8_t records[NOTES_HEAP_BANK_SIZE];
+} NvramNotesBank_t;
+
+/**
+ * @brief One of the two copies of the progress of the conversion of NVRAM from an older version
+ * of its structure. The progress is updated by writing the copy which is not the current one,
+ * the current copy being the valid one with the greatest step.
+ *
+ */
+typedef struct {
+    uint32_t state;  ///< version being converted and index of the next step to run (see
+                     ///< app_notes_utils.c)
+    uint32_t check;  ///< bitwise inverse of state (the copy is valid only if correct)
+} NvramConversionCopy_t;
+
+/**
+ * @brief Progress of the conversion of NVRAM from an older version of its structure, located
+ * after all the data of any older version. It is only meaningful while the header still holds
+ * the older version.
+ *
+ */
+typedef struct {
+    NvramConversionCopy_t copies[2];
+} NvramConversion_t;
+
+/**
+ * @brief Layout of a note in version 1 of the NVRAM structure
+ *
+ */
 typedef struct {
     const char title[NOTE_TITLE_MAX_LEN];
     const char content[NOTE_CONTENT_MAX_LEN];
-} NvramNote_t;
+} NvramNoteV1_t;
+
+/**
+ * @brief Number of notes and contacts in version 1 of the NVRAM structure, as in the released
+ * application (10 notes on all targets)
+ *
+ */
+#define NVRAM_V1_NB_NOTES    10
+#define NVRAM_V1_NB_CONTACTS 16
 
+/**
+ * @brief Layout of version 1 of the NVRAM structure, with fixed slots for notes and contacts
+ *
+ */
 typedef struct {
-    const char name[CONTACT_NAME_LEN];
-    const char address[CONTACT_ADDRESS_MAX_LEN];
-} NvramContact_t;
+    NvramSettings_t settings;
+    uint32_t        usedNotes;     // bit mask of used notes
+    uint32_t        usedContacts;  // bit mask of used contacts
+    NvramNoteV1_t   notes[NVRAM_V1_NB_NOTES];
+    NvramContact_t  contacts[NVRAM_V1_NB_CONTACTS];
+} NvramDataV1_t;
 
 /**
  * @brief Oldest supported version of the NVRAM (for conversion)
+ * @note version 1 is converted in place, all its data being located before the second bank of
+ * the notes heap
  *
  */
 #define NVRAM_FIRST_SUPPORTED_VERSION 1
 
 /**
  * @brief Current version of the NVRAM structure
- * @note Set it to 1 to generate the first version of NVRAM data to fetch after a first launch.
- * Then set it back to 2 to generate the second version, then load fetched NVRAM after a
- * first launch.
+ * @note Version 1 is the fixed-slot layout of the previous release, converted at first start.
+ * Any other older version (only written by development builds) is reset. To test the
+ * conversion, build the previous release to generate NVRAM data in version 1, then load this
+ * version over it (as done on host by unit-tests/test_nvram_convert.c).
  *
  */
-#define NVRAM_STRUCT_VERSION 1
+#define NVRAM_STRUCT_VERSION 2
 
 /**
  * @brief Current version of the NVRAM data
@@ -51,11 +193,16 @@ typedef struct {
  */
 typedef struct Nvram_data_s {
     NvramSettings_t settings;
-    uint32_t usedNotes;     // bit mask to indicate whether or not the notes in above array are used
-                            // (up to 32 notes)
-    uint32_t usedContacts;  // bit mask to indicate whether or not the contacts in above array are
-                            // used (up to 32 contacts)
-    NvramNote_t    notes[NB_MAX_NOTES];
-    NvramContact_t contacts[NB_MAX_CONTACTS];
-
+    // bitmap to indicate whether or not the contacts in below array are used
+    uint32_t usedContacts[BITMAP_NB_WORDS(NB_MAX_CONTACTS)];
+    NvramContactCopy_t contacts[NB_MAX_CONTACTS][2];
+    NvramNotesBank_t   notesBanks[2];  // variable-length heap of notes, whose records also
+                                       // tell which notes are used
+    NvramConversion_t  conversion;     // progress of the conversion from an older version
+    // sequence number of the mutation written in each copy of each contact slot (shared with the
+    // records of the notes heap), written before the copy
+    uint32_t contactSeqs[NB_MAX_CONTACTS][2];
+    // public key of the contact in each copy of each contact slot (first byte 0 if unknown),
+    // written before the copy
+    uint8_t contactKeys[NB_MAX_CONTACTS][2][CONTACT_PUBLIC_KEY_LEN];
 } Nvram_data_t;
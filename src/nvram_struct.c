@@ -64,3 +64,77 @@ bool nvram_is_initalized(void)
     }
     return true;
 }
+
+/**
+ * @brief write the given buffer in NVRAM, counting written bytes and pages
+ *
+ * @param dst destination in NVRAM
+ * @param src source buffer
+ * @param len number of bytes to write
+ * @param stats statistics to update (can be NULL)
+ */
+void nvram_write(void                *dst,
+                 const void          *src,
+                 uint32_t             len,
+                 Nvram_write_stats_t *stats)
+{
+    uint32_t firstPage;
+    uint32_t lastPage;
+
+    if (len == 0) {
+        return;
+    }
+    firstPage = ((uintptr_t) dst) / NVRAM_PAGE_SIZE;
+    lastPage  = ((uintptr_t) dst + len - 1) / NVRAM_PAGE_SIZE;
+    nvm_write((void *) dst, (void *) src, len);
+    if (stats != NULL) {
+        stats->nbBytes += len;
+        stats->nbPages += lastPage - firstPage + 1;
+    }
+}
+
+/**
+ * @brief write the given buffer in NVRAM, but only the ranges differing from the current NVRAM
+ * content. Ranges are split on flash page boundaries, so that at most one write is issued per
+ * modified page.
+ *
+ * @param dst destination in NVRAM
+ * @param src source buffer
+ * @param len number of bytes to compare and write
+ * @param stats statistics to update (can be NULL)
+ */
+void nvram_write_delta(void                *dst,
+                       const void          *src,
+                       uint32_t             len,
+                       Nvram_write_stats_t *stats)
+{
+    volatile uint8_t *current  = (volatile uint8_t *) dst;
+    const uint8_t    *newValue = (const uint8_t *) src;
+    uint32_t          offset   = 0;
+
+    while (offset < len) {
+        // end of the current page, or of the buffer
+        uint32_t pageEnd = NVRAM_PAGE_SIZE - (((uintptr_t) &current[offset]) % NVRAM_PAGE_SIZE);
+        uint32_t end     = (offset + pageEnd < len) ? (offset + pageEnd) : len;
+        uint32_t first   = end;
+        uint32_t last    = offset;
+        uint32_t i;
+
+        for (i = offset; i < end; i++) {
+            if (current[i] != newValue[i]) {
+                if (first == end) {
+                    first = i;
+                }
+                last = i;
+            }
+        }
+        if (first != end) {
+            nvm_write((void *) &current[first], (void *) &newValue[first], last - first + 1);
+            if (stats != NULL) {
+                stats->nbBytes += last - first + 1;
+                stats->nbPages++;
+            }
+        }
+        offset = end;
+    }
+}
@@ -8,6 +8,22 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "os_pic.h"
+#include "os_nvm.h"
+
+/**
+ * @brief Size in bytes of a flash page, which is the granularity of NVRAM writes
+ *
+ * It is taken from the SDK when it provides it, otherwise from the flash of each target.
+ */
+#ifndef NVRAM_PAGE_SIZE
+#if defined(NVM_PAGE_SIZE_B)
+#define NVRAM_PAGE_SIZE NVM_PAGE_SIZE_B
+#elif defined(TARGET_NANOS)
+#define NVRAM_PAGE_SIZE 64
+#else  // NVM_PAGE_SIZE_B
+#define NVRAM_PAGE_SIZE 512
+#endif  // NVM_PAGE_SIZE_B
+#endif  // NVRAM_PAGE_SIZE
 
 /* "nvram_data.h" needs to be created in all apps including this file */
 #include "nvram_data.h"
@@ -25,6 +41,15 @@ typedef struct Nvram_header_s {
                               ///< updated)
 } Nvram_header_t;
 
+/**
+ * @brief Structure used to count what is actually written in NVRAM
+ *
+ */
+typedef struct Nvram_write_stats_s {
+    uint32_t nbBytes;  ///< number of bytes actually written
+    uint32_t nbPages;  ///< number of flash page writes actually issued
+} Nvram_write_stats_t;
+
 /**
  * @brief Structure defining the NVRAM
  *
@@ -52,3 +77,11 @@ extern uint32_t nvram_get_size(void);
 extern uint8_t  nvram_get_struct_version(void);
 extern uint8_t  nvram_get_data_version(void);
 extern bool     nvram_is_initalized(void);
+extern void     nvram_write(void                *dst,
+                            const void          *src,
+                            uint32_t             len,
+                            Nvram_write_stats_t *stats);
+extern void     nvram_write_delta(void                *dst,
+                                  const void          *src,
+                                  uint32_t             len,
+                                  Nvram_write_stats_t *stats);
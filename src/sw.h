@@ -16,6 +16,10 @@
  * Status word for either wrong Lc or length of APDU command less than 5.
  */
 #define SW_WRONG_DATA_LENGTH 0x6A87
+/**
+ * Status word for incorrect data.
+ */
+#define SW_WRONG_DATA 0x6A80
 /**
  * Status word for unknown command with this INS.
  */
@@ -64,3 +68,19 @@
  * Status word for no sared note.
  */
 #define SW_NO_SHARED_NOTE 0xB009
+/**
+ * Status word for no free slot or not enough space for the notes.
+ */
+#define SW_NOT_ENOUGH_SPACE 0xB00A
+/**
+ * Status word for received note not matching its hash.
+ */
+#define SW_WRONG_NOTE_HASH 0xB00B
+/**
+ * Status word for fail of key derivation.
+ */
+#define SW_KEY_DERIVATION_FAIL 0xB00C
+/**
+ * Status word for shared note not for the device or not authentic.
+ */
+#define SW_WRONG_SHARED_NOTE 0xB00D
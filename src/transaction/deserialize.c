@@ -14,7 +14,11 @@
  *  See the License for the specific language governing permissions and
  *  limitations under the License.
  *****************************************************************************/
+#include <string.h>  // memset
+
 #include "buffer.h"
+#include "read.h"
+#include "varint.h"
 
 #include "deserialize.h"
 #include "utils.h"
@@ -53,7 +57,7 @@ parser_status_e transaction_deserialize(buffer_t *buf, transaction_t *tx) {
     }
 
     // length of memo
-    if (!buffer_read_varint(buf, &tx->memo_len) && tx->memo_len > MAX_MEMO_LEN) {
+    if (!buffer_read_varint(buf, &tx->memo_len) || tx->memo_len > MAX_MEMO_LEN) {
         return MEMO_LENGTH_ERROR;
     }
 
@@ -70,3 +74,160 @@ parser_status_e transaction_deserialize(buffer_t *buf, transaction_t *tx) {
 
     return (buf->offset == buf->size) ? PARSING_OK : WRONG_LENGTH_ERROR;
 }
+
+void transaction_parser_init(transaction_parser_t *parser, transaction_t *tx) {
+    LEDGER_ASSERT(parser != NULL, "NULL parser");
+    LEDGER_ASSERT(tx != NULL, "NULL tx");
+
+    memset(parser, 0, sizeof(*parser));
+    memset(tx, 0, sizeof(*tx));
+    parser->tx = tx;
+    parser->state = TX_PARSER_NONCE;
+    parser->status = PARSING_OK;
+    tx->to = parser->to;
+    tx->memo = parser->memo;
+}
+
+// number of bytes of the field being received, as far as it is known
+static size_t parser_field_size(const transaction_parser_t *parser) {
+    switch (parser->state) {
+        case TX_PARSER_NONCE:
+        case TX_PARSER_VALUE:
+            return sizeof(uint64_t);
+        case TX_PARSER_TO:
+            return ADDRESS_LEN;
+        case TX_PARSER_MEMO_LEN:
+            // the first byte of the varint gives its size
+            if (parser->field_len == 0) {
+                return 1;
+            }
+            switch (parser->field[0]) {
+                case 0xFD:
+                    return 3;
+                case 0xFE:
+                    return 5;
+                case 0xFF:
+                    return 9;
+                default:
+                    return 1;
+            }
+        case TX_PARSER_MEMO:
+            return (size_t) parser->tx->memo_len;
+        default:
+            return 0;
+    }
+}
+
+// where the bytes of the field being received are kept
+static uint8_t *parser_field_ptr(transaction_parser_t *parser) {
+    switch (parser->state) {
+        case TX_PARSER_TO:
+            return parser->to;
+        case TX_PARSER_MEMO:
+            return parser->memo;
+        default:
+            return parser->field;
+    }
+}
+
+// decode the fields completely received, and move to the next one
+static parser_status_e parser_end_fields(transaction_parser_t *parser) {
+    transaction_t *tx = parser->tx;
+
+    while (parser->state != TX_PARSER_DONE && parser->field_len == parser_field_size(parser)) {
+        switch (parser->state) {
+            case TX_PARSER_NONCE:
+                tx->nonce = read_u64_be(parser->field, 0);
+                parser->state = TX_PARSER_TO;
+                break;
+            case TX_PARSER_TO:
+                parser->state = TX_PARSER_VALUE;
+                break;
+            case TX_PARSER_VALUE:
+                tx->value = read_u64_be(parser->field, 0);
+                parser->state = TX_PARSER_MEMO_LEN;
+                break;
+            case TX_PARSER_MEMO_LEN:
+                // rejected before any byte of the memo is received
+                if (varint_read(parser->field, parser->field_len, &tx->memo_len) < 0 ||
+                    tx->memo_len > MAX_MEMO_LEN) {
+                    return MEMO_LENGTH_ERROR;
+                }
+                parser->state = TX_PARSER_MEMO;
+                break;
+            default:
+                parser->state = TX_PARSER_DONE;
+                break;
+        }
+        parser->field_len = 0;
+    }
+
+    return PARSING_OK;
+}
+
+parser_status_e transaction_parser_update(transaction_parser_t *parser, buffer_t *buf) {
+    LEDGER_ASSERT(parser != NULL, "NULL parser");
+    LEDGER_ASSERT(buf != NULL, "NULL buf");
+
+    if (parser->status != PARSING_OK) {
+        return parser->status;
+    }
+
+    if (parser->length + (buf->size - buf->offset) > MAX_TX_LEN) {
+        parser->status = WRONG_LENGTH_ERROR;
+        return parser->status;
+    }
+
+    while (parser->status == PARSING_OK && buf->offset < buf->size) {
+        if (parser->state == TX_PARSER_DONE) {
+            // bytes after the memo
+            parser->status = WRONG_LENGTH_ERROR;
+            break;
+        }
+
+        uint8_t *ptr = parser_field_ptr(parser) + parser->field_len;
+        size_t len = parser_field_size(parser) - parser->field_len;
+        if (len > buf->size - buf->offset) {
+            len = buf->size - buf->offset;
+        }
+        if (!buffer_move(buf, ptr, len)) {
+            parser->status = WRONG_LENGTH_ERROR;
+            break;
+        }
+        // the memo is checked as it is received
+        if (parser->state == TX_PARSER_MEMO && !transaction_utils_check_encoding(ptr, len)) {
+            parser->status = MEMO_ENCODING_ERROR;
+            break;
+        }
+        parser->field_len += len;
+        parser->length += len;
+
+        parser->status = parser_end_fields(parser);
+    }
+
+    return parser->status;
+}
+
+parser_status_e transaction_parser_finish(const transaction_parser_t *parser) {
+    LEDGER_ASSERT(parser != NULL, "NULL parser");
+
+    if (parser->status != PARSING_OK) {
+        return parser->status;
+    }
+
+    // error of the field left incomplete
+    switch (parser->state) {
+        case TX_PARSER_NONCE:
+            return NONCE_PARSING_ERROR;
+        case TX_PARSER_TO:
+            return TO_PARSING_ERROR;
+        case TX_PARSER_VALUE:
+            return VALUE_PARSING_ERROR;
+        case TX_PARSER_MEMO_LEN:
+            return MEMO_LENGTH_ERROR;
+        case TX_PARSER_MEMO:
+            return MEMO_PARSING_ERROR;
+        default:
+            return PARSING_OK;
+    }
+}
@@ -16,3 +16,42 @@
  *
  */
 parser_status_e transaction_deserialize(buffer_t *buf, transaction_t *tx);
+
+/**
+ * Start parsing a transaction received in several chunks, whose address
+ * and memo are kept in the parser.
+ *
+ * @param[out] parser
+ *   Pointer to parser to reset.
+ * @param[out] tx
+ *   Pointer to transaction structure, filled as its fields are received.
+ *
+ */
+void transaction_parser_init(transaction_parser_t *parser, transaction_t *tx);
+
+/**
+ * Parse the next chunk of a transaction, rejecting it as soon as a field
+ * is invalid.
+ *
+ * @param[in, out] parser
+ *   Pointer to parser.
+ * @param[in, out] buf
+ *   Pointer to buffer with the next chunk, fully consumed.
+ *
+ * @return PARSING_OK if the transaction is valid so far, error status
+ * otherwise (returned again for the next chunks).
+ *
+ */
+parser_status_e transaction_parser_update(transaction_parser_t *parser, buffer_t *buf);
+
+/**
+ * Check that a transaction has been completely received.
+ *
+ * @param[in] parser
+ *   Pointer to parser.
+ *
+ * @return PARSING_OK if success, error status of the first invalid or
+ * missing field otherwise.
+ *
+ */
+parser_status_e transaction_parser_finish(const transaction_parser_t *parser);
@@ -25,3 +25,23 @@ typedef struct {
     uint8_t *memo;      /// memo (variable length)
     uint64_t memo_len;  /// length of memo (8 bytes)
 } transaction_t;
+
+typedef enum {
+    TX_PARSER_NONCE,     /// receiving the nonce
+    TX_PARSER_TO,        /// receiving the address
+    TX_PARSER_VALUE,     /// receiving the amount value
+    TX_PARSER_MEMO_LEN,  /// receiving the varint of the memo length
+    TX_PARSER_MEMO,      /// receiving the memo
+    TX_PARSER_DONE       /// whole transaction received
+} parser_state_e;
+
+typedef struct {
+    transaction_t *tx;            /// transaction being parsed
+    parser_state_e state;         /// field being received
+    parser_status_e status;       /// PARSING_OK, or first error met (kept until reset)
+    uint8_t field[9];             /// bytes received of the integer or varint being received
+    size_t field_len;             /// number of bytes received of the field being received
+    size_t length;                /// number of bytes of the transaction received
+    uint8_t to[ADDRESS_LEN];      /// address, once received
+    uint8_t memo[MAX_MEMO_LEN];   /// memo, as received
+} transaction_parser_t;
@@ -4,6 +4,7 @@
 #include <stdint.h>  // uint*_t
 
 #include "bip32.h"
+#include "cx.h"
 
 #include "constants.h"
 #include "transaction/types.h"
@@ -18,7 +19,13 @@ typedef enum {
     SIGN_TX = 0x06,         /// sign transaction with BIP32 path
     ADD_ADDRESS = 0x07,     /// add public adddress of contact
     GET_NOTE = 0x08,     /// get encrypted shared note
-    PUT_NOTE = 0x09     /// put encrypted shared note
+    PUT_NOTE = 0x09,     /// put encrypted shared note
+    GET_WEAR_STATS = 0x0A,  /// get number of writes of NVRAM slots and pages
+    GET_STORE_ROOT = 0x0B,  /// get Merkle root of saved notes and contacts
+    EXPORT_NOTES = 0x0C,    /// export all notes and contacts
+    GET_CHANGES = 0x0D,     /// get notes and contacts modified since a cursor
+    SIGN_TX_BATCH = 0x0E,   /// sign several transactions with BIP32 path
+    GET_PUBLIC_KEYS = 0x0F  /// public keys of children of BIP32 path
 } command_e;
 /**
  * Enumeration with parsing state.
@@ -37,7 +44,9 @@ typedef enum {
     CONFIRM_TRANSACTION,  /// confirm transaction information
     CONFIRM_ADD_ADDRESS,
     CONFIRM_GET_NOTE,
-    CONFIRM_PUT_NOTE
+    CONFIRM_PUT_NOTE,
+    CONFIRM_EXPORT,  /// confirm export of all notes and contacts
+    CONFIRM_TRANSACTION_BATCH  /// confirm summary of several transactions
 } request_type_e;
 
 /**
@@ -52,15 +61,41 @@ typedef struct {
  * Structure for transaction information context.
  */
 typedef struct {
-    uint8_t raw_tx[MAX_TRANSACTION_LEN];  /// raw transaction serialized
-    size_t raw_tx_len;                    /// length of raw transaction
+    transaction_parser_t parser;          /// parser of the chunks received so far
     transaction_t transaction;            /// structured transaction
+    cx_sha3_t hash_ctx;                   /// Keccak-256 of the chunks received so far
     uint8_t m_hash[32];                   /// message hash digest
     uint8_t signature[MAX_DER_SIG_LEN];   /// transaction signature encoded in DER
     uint8_t signature_len;                /// length of transaction signature
     uint8_t v;                            /// parity of y-coordinate of R in ECDSA signature
 } transaction_ctx_t;
 
+/**
+ * Structure for transaction batch context information.
+ */
+typedef struct {
+    transaction_parser_t parser;                       /// parser of the transaction received
+    transaction_t transaction;                         /// transaction being received
+    cx_sha3_t hash_ctx;                                /// Keccak-256 of the transaction received
+    uint8_t nb_tx;                                     /// number of transactions of the batch
+    uint8_t nb_received;                               /// number of transactions received
+    uint8_t nb_destinations;                           /// number of distinct addresses
+    uint64_t total_value;                              /// sum of the values of the transactions
+    uint8_t destinations[MAX_BATCH_TX][ADDRESS_LEN];   /// distinct addresses, in order
+    uint8_t m_hash[MAX_BATCH_TX][32];                  /// message hash digest of each transaction
+    uint8_t signature[MAX_BATCH_TX][MAX_DER_SIG_LEN];  /// signature of each transaction, in DER
+    uint8_t signature_len[MAX_BATCH_TX];               /// length of each signature
+    uint8_t v[MAX_BATCH_TX];                           /// parity of y-coordinate of R of each one
+} batch_ctx_t;
+
+/**
+ * Structure for export context information.
+ */
+typedef struct {
+    uint16_t slot;    /// slot of the next record to export
+    uint16_t offset;  /// offset of the next byte to export in this record
+} export_ctx_t;
+
 /**
  * Structure for global context.
  */
@@ -69,6 +104,8 @@ typedef struct {
     union {
         pubkey_ctx_t pk_info;       /// public key context
         transaction_ctx_t tx_info;  /// transaction context
+        batch_ctx_t batch_info;     /// transaction batch context
+        export_ctx_t export_info;   /// export context
     };
     request_type_e req_type;              /// user request
     uint32_t bip32_path[MAX_BIP32_PATH];  /// BIP32 path
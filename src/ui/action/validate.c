@@ -16,14 +16,17 @@
  *****************************************************************************/
 
 #include <stdbool.h>  // bool
+#include <string.h>   // explicit_bzero
 
-#include "crypto_helpers.h"
+#include "os.h"
+#include "cx.h"
 
 #include "validate.h"
 #include "../menu.h"
 #include "../../sw.h"
 #include "../../globals.h"
 #include "../../helper/send_response.h"
+#include "../../key_cache.h"
 
 void validate_pubkey(bool choice) {
     if (choice) {
@@ -34,19 +37,22 @@ void validate_pubkey(bool choice) {
 }
 
 static int crypto_sign_message(void) {
+    const key_cache_entry_t *key = NULL;
     uint32_t info = 0;
     size_t sig_len = sizeof(G_context.tx_info.signature);
 
-    cx_err_t error = bip32_derive_ecdsa_sign_hash_256(CX_CURVE_256K1,
-                                                      G_context.bip32_path,
-                                                      G_context.bip32_path_len,
-                                                      CX_RND_RFC6979 | CX_LAST,
-                                                      CX_SHA256,
-                                                      G_context.tx_info.m_hash,
-                                                      sizeof(G_context.tx_info.m_hash),
-                                                      G_context.tx_info.signature,
-                                                      &sig_len,
-                                                      &info);
+    // the key is only derived by the first request of the session on this path
+    cx_err_t error = key_cache_get(G_context.bip32_path, G_context.bip32_path_len, &key);
+    if (error == CX_OK) {
+        error = cx_ecdsa_sign_no_throw(&key->private_key,
+                                       CX_RND_RFC6979 | CX_LAST,
+                                       CX_SHA256,
+                                       G_context.tx_info.m_hash,
+                                       sizeof(G_context.tx_info.m_hash),
+                                       G_context.tx_info.signature,
+                                       &sig_len,
+                                       &info);
+    }
     if (error != CX_OK) {
         return -1;
     }
@@ -74,3 +80,58 @@ void validate_transaction(bool choice) {
         io_send_sw(SW_DENY);
     }
 }
+
+static int crypto_sign_batch(void) {
+    batch_ctx_t *batch = &G_context.batch_info;
+    const key_cache_entry_t *key = NULL;
+
+    // the key is derived at most once for the whole batch
+    if (key_cache_get(G_context.bip32_path, G_context.bip32_path_len, &key) != CX_OK) {
+        return -1;
+    }
+
+    for (uint8_t i = 0; i < batch->nb_tx; i++) {
+        uint32_t info = 0;
+        size_t sig_len = sizeof(batch->signature[i]);
+
+        if (cx_ecdsa_sign_no_throw(&key->private_key,
+                                   CX_RND_RFC6979 | CX_LAST,
+                                   CX_SHA256,
+                                   batch->m_hash[i],
+                                   sizeof(batch->m_hash[i]),
+                                   batch->signature[i],
+                                   &sig_len,
+                                   &info) != CX_OK) {
+            return -1;
+        }
+        batch->signature_len[i] = sig_len;
+        batch->v[i] = (uint8_t)(info & CX_ECCINFO_PARITY_ODD);
+    }
+
+    return 0;
+}
+
+void validate_transaction_batch(bool choice) {
+    if (choice) {
+        G_context.state = STATE_APPROVED;
+
+        if (crypto_sign_batch() != 0) {
+            explicit_bzero(&G_context, sizeof(G_context));
+            io_send_sw(SW_SIGNATURE_FAIL);
+        } else {
+            // the next signatures are sent with P1_BATCH_SIGNATURES
+            helper_send_response_batch_sigs(0);
+        }
+    } else {
+        G_context.state = STATE_NONE;
+        io_send_sw(SW_DENY);
+    }
+}
+
+void validate_export(bool choice) {
+    if (choice) {
+        helper_send_response_export();
+    } else {
+        io_send_sw(SW_DENY);
+    }
+}
@@ -19,3 +19,21 @@ void validate_pubkey(bool choice);
  *
  */
 void validate_transaction(bool choice);
+
+/**
+ * Action for validation of a transaction batch, signing all of them.
+ *
+ * @param[in] choice
+ *   User choice (either approved or rejected).
+ *
+ */
+void validate_transaction_batch(bool choice);
+
+/**
+ * Action for export of all notes and contacts.
+ *
+ * @param[in] choice
+ *   User choice (either approved or rejected).
+ *
+ */
+void validate_export(bool choice);
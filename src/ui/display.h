@@ -22,3 +22,20 @@ int ui_display_address(void);
  *
  */
 int ui_display_transaction(void);
+
+/**
+ * Ask confirmation to export all notes and contacts, once per export.
+ *
+ * @return 0 if success, negative integer otherwise.
+ *
+ */
+int ui_display_export(void);
+
+/**
+ * Display the summary of a transaction batch on the device and ask
+ * confirmation to sign all of them.
+ *
+ * @return 0 if success, negative integer otherwise.
+ *
+ */
+int ui_display_transaction_batch(void);
@@ -36,7 +36,7 @@ static void onNewNote(void)
 
 static void onPasscodeSuccess(void)
 {
-    uint8_t nbUsedNotes = app_notesGetAll(NULL);
+    uint16_t nbUsedNotes = app_notesGetAll(NULL);
     if (nbUsedNotes == 0) {
         onNewNote();
     }
@@ -55,11 +55,36 @@ static void onActionButton(void)
     }
 }
 
+// whether the device was found locked by the last ticker event
+static bool deviceLocked = false;
+
 void app_quit(void) {
+    // the note being edited is saved, and the keys derived in this session are not left in RAM
+    app_notesSessionLock();
     // exit app here
     os_sched_exit(-1);
 }
 
+/**
+ * Called by the SDK on each ticker event: when the device gets locked, the session is locked as
+ * well, and once the device is unlocked, the screen left (which can show a note) is replaced by
+ * the home page if the passcode is needed again.
+ */
+void app_ticker_event_callback(void) {
+    if (os_global_pin_is_validated() != BOLOS_TRUE) {
+        if (!deviceLocked) {
+            deviceLocked = true;
+            app_notesSessionLock();
+        }
+    }
+    else if (deviceLocked) {
+        deviceLocked = false;
+        if (app_notesSettingsIsLocked()) {
+            ui_menu_main();
+        }
+    }
+}
+
 // home page definition
 void ui_menu_main(void) {
 // This parameter shall be set to false if the settings page contains only information
@@ -67,10 +92,15 @@ void ui_menu_main(void) {
 // true if the settings page also contains user configurable parameters related to the
 // operation of the application.
 #define SETTINGS_BUTTON_ENABLED (true)
-    uint8_t nbUsedNotes;
+    uint16_t nbUsedNotes;
     const nbgl_icon_details_t *icon = NULL;
 
     app_notesInit();
+    // tell once that the app was stopped while a note was being edited
+    if (app_notesGetLostDraft() >= 0) {
+        nbgl_useCaseStatus("Last changes of\na Note were lost", false, ui_menu_main);
+        return;
+    }
 
     nbUsedNotes = app_notesGetAll(NULL);
     if (app_notesSettingsIsLocked()) {
@@ -0,0 +1,141 @@
+/*****************************************************************************
+ *   Ledger App Secure-Notes.
+ *   (c) 2024 Ledger SAS.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+#ifdef HAVE_NBGL
+
+#include <stdbool.h>  // bool
+#include <stdio.h>    // snprintf
+#include <string.h>   // memset
+
+#include "os.h"
+#include "glyphs.h"
+#include "nbgl_use_case.h"
+#include "io.h"
+#include "format.h"
+
+#include "display.h"
+#include "constants.h"
+#include "../globals.h"
+#include "../sw.h"
+#include "action/validate.h"
+#include "../transaction/types.h"
+#include "../menu.h"
+
+// Buffer where the number of transactions is written
+static char g_count[4];
+// Buffer where the total amount string is written
+static char g_total[30];
+// Buffers where the distinct addresses strings are written
+static char g_addresses[MAX_BATCH_TX][43];
+// Title of the review
+static char g_title[40];
+
+static nbgl_layoutTagValue_t pairs[2 + MAX_BATCH_TX];
+static nbgl_layoutTagValueList_t pairList;
+static nbgl_pageInfoLongPress_t infoLongPress;
+
+static void confirm_batch_rejection(void) {
+    // display a status page and go back to main
+    validate_transaction_batch(false);
+    nbgl_useCaseStatus("Transactions rejected", false, ui_menu_main);
+}
+
+static void ask_batch_rejection_confirmation(void) {
+    // display a choice to confirm/cancel rejection
+    nbgl_useCaseConfirm("Reject transactions?",
+                        NULL,
+                        "Yes, Reject",
+                        "Go back to transactions",
+                        confirm_batch_rejection);
+}
+
+static void review_choice(bool confirm) {
+    if (confirm) {
+        // display a status page and go back to main
+        validate_transaction_batch(true);
+        nbgl_useCaseStatus("TRANSACTIONS\nSIGNED", true, ui_menu_main);
+    } else {
+        ask_batch_rejection_confirmation();
+    }
+}
+
+static void review_continue(void) {
+    const batch_ctx_t *batch = &G_context.batch_info;
+    uint8_t nb_pairs = 0;
+
+    // Setup data to display: the summary of the batch, then each destination once
+    pairs[nb_pairs].item = "Transactions";
+    pairs[nb_pairs++].value = g_count;
+    pairs[nb_pairs].item = "Total amount";
+    pairs[nb_pairs++].value = g_total;
+    for (uint8_t i = 0; i < batch->nb_destinations; i++) {
+        pairs[nb_pairs].item = "Address";
+        pairs[nb_pairs++].value = g_addresses[i];
+    }
+
+    // Setup list
+    pairList.nbMaxLinesForValue = 0;
+    pairList.nbPairs = nb_pairs;
+    pairList.pairs = pairs;
+
+    // Info long press
+    infoLongPress.icon = &C_app_securenotes_64px;
+    infoLongPress.text = "Sign all transactions\nto send BOL";
+    infoLongPress.longPressText = "Hold to sign";
+
+    nbgl_useCaseStaticReview(&pairList, &infoLongPress, "Reject transactions", review_choice);
+}
+
+int ui_display_transaction_batch() {
+    const batch_ctx_t *batch = &G_context.batch_info;
+
+    if (G_context.req_type != CONFIRM_TRANSACTION_BATCH || G_context.state != STATE_PARSED) {
+        G_context.state = STATE_NONE;
+        return io_send_sw(SW_BAD_STATE);
+    }
+
+    // Format the number of transactions, the total amount and the addresses
+    snprintf(g_count, sizeof(g_count), "%d", batch->nb_tx);
+    memset(g_total, 0, sizeof(g_total));
+    char amount[30] = {0};
+    if (!format_fpu64(amount, sizeof(amount), batch->total_value, EXPONENT_SMALLEST_UNIT)) {
+        return io_send_sw(SW_DISPLAY_AMOUNT_FAIL);
+    }
+    snprintf(g_total, sizeof(g_total), "BOL %.*s", sizeof(amount), amount);
+
+    memset(g_addresses, 0, sizeof(g_addresses));
+    for (uint8_t i = 0; i < batch->nb_destinations; i++) {
+        if (format_hex(batch->destinations[i],
+                       ADDRESS_LEN,
+                       g_addresses[i],
+                       sizeof(g_addresses[i])) == -1) {
+            return io_send_sw(SW_DISPLAY_ADDRESS_FAIL);
+        }
+    }
+
+    // Start review
+    snprintf(g_title, sizeof(g_title), "Review %d transactions\nto send BOL", batch->nb_tx);
+    nbgl_useCaseReviewStart(&C_app_securenotes_64px,
+                            g_title,
+                            NULL,
+                            "Reject transactions",
+                            review_continue,
+                            ask_batch_rejection_confirmation);
+    return 0;
+}
+
+#endif
@@ -0,0 +1,61 @@
+/*****************************************************************************
+ *   Ledger App Secure-Notes.
+ *   (c) 2024 Ledger SAS.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+#ifdef HAVE_NBGL
+
+#include <stdbool.h>  // bool
+
+#include "os.h"
+#include "glyphs.h"
+#include "nbgl_use_case.h"
+#include "io.h"
+
+#include "display.h"
+#include "../globals.h"
+#include "../sw.h"
+#include "../app_notes.h"
+#include "action/validate.h"
+#include "../menu.h"
+
+static void review_choice(bool confirm) {
+    if (confirm) {
+        // the next commands of this export are not confirmed again
+        app_notesAllowExport();
+        validate_export(true);
+        nbgl_useCaseStatus("EXPORT\nALLOWED", true, ui_menu_main);
+    } else {
+        validate_export(false);
+        nbgl_useCaseStatus("Export cancelled", false, ui_menu_main);
+    }
+}
+
+int ui_display_export() {
+    if (G_context.req_type != CONFIRM_EXPORT || G_context.state != STATE_NONE) {
+        G_context.state = STATE_NONE;
+        return io_send_sw(SW_BAD_STATE);
+    }
+
+    nbgl_useCaseChoice(&C_app_securenotes_64px,
+                       "Export all Notes\nand contacts?",
+                       "They will be sent unencrypted\nuntil the export is done",
+                       "Export",
+                       "Cancel",
+                       review_choice);
+    return 0;
+}
+
+#endif
@@ -1,6 +1,8 @@
 from enum import IntEnum
-from typing import Generator, List, Optional
+from typing import Generator, List, Optional, Tuple
 from contextlib import contextmanager
+from hashlib import sha256
+from struct import pack
 
 from ragger.backend.interface import BackendInterface, RAPDU
 from ragger.bip import pack_derivation_path
@@ -18,6 +20,28 @@ class P1(IntEnum):
     # Parameter 1 for screen confirmation for GET_PUBLIC_KEY.
     P1_CONFIRM = 0x01
 
+class P1Note(IntEnum):
+    # Parameter 1 for first APDU of a note, with its lengths.
+    P1_NOTE_START              = 0x00
+    # Parameter 1 for next APDU of a note, with its next bytes.
+    P1_NOTE_CONTINUE           = 0x01
+    # Parameter 1 for last APDU of a note, with its hash.
+    P1_NOTE_FINISH             = 0x02
+    # Parameter 1 for APDU announcing several notes, with their number and total length.
+    P1_NOTE_BATCH              = 0x03
+    # Parameter 1 for first APDU of an encrypted note, with the length of its payload.
+    P1_NOTE_ENCRYPTED_START    = 0x04
+    # Parameter 1 for next APDU of an encrypted note, with the next bytes of its payload.
+    P1_NOTE_ENCRYPTED_CONTINUE = 0x05
+
+class P1Batch(IntEnum):
+    # Parameter 1 for the BIP32 path and the number of transactions of a batch
+    P1_BATCH_START      = 0x00
+    # Parameter 1 for a chunk of the next transaction of a batch
+    P1_BATCH_TX         = 0x01
+    # Parameter 1 for the next signatures of an approved batch
+    P1_BATCH_SIGNATURES = 0x02
+
 class P2(IntEnum):
     # Parameter 2 for last APDU to receive.
     P2_LAST = 0x00
@@ -25,13 +49,22 @@ class P2(IntEnum):
     P2_MORE = 0x80
 
 class InsType(IntEnum):
-    GET_VERSION    = 0x03
-    GET_APP_NAME   = 0x04
-    GET_PUBLIC_KEY = 0x05
-    SIGN_TX        = 0x06
+    GET_VERSION     = 0x03
+    GET_APP_NAME    = 0x04
+    GET_PUBLIC_KEY  = 0x05
+    SIGN_TX         = 0x06
+    GET_NOTE        = 0x08
+    PUT_NOTE        = 0x09
+    GET_WEAR_STATS  = 0x0A
+    GET_STORE_ROOT  = 0x0B
+    EXPORT_NOTES    = 0x0C
+    GET_CHANGES     = 0x0D
+    SIGN_TX_BATCH   = 0x0E
+    GET_PUBLIC_KEYS = 0x0F
 
 class Errors(IntEnum):
     SW_DENY                    = 0x6985
+    SW_WRONG_DATA              = 0x6A80
     SW_WRONG_P1P2              = 0x6A86
     SW_WRONG_DATA_LENGTH       = 0x6A87
     SW_INS_NOT_SUPPORTED       = 0x6D00
@@ -45,6 +78,11 @@ class Errors(IntEnum):
     SW_TX_HASH_FAIL            = 0xB006
     SW_BAD_STATE               = 0xB007
     SW_SIGNATURE_FAIL          = 0xB008
+    SW_NO_SHARED_NOTE          = 0xB009
+    SW_NOT_ENOUGH_SPACE        = 0xB00A
+    SW_WRONG_NOTE_HASH         = 0xB00B
+    SW_KEY_DERIVATION_FAIL     = 0xB00C
+    SW_WRONG_SHARED_NOTE       = 0xB00D
 
 
 def split_message(message: bytes, max_size: int) -> List[bytes]:
@@ -80,6 +118,105 @@ class BoilerplateCommandSender:
                                      data=b"")
 
 
+    def get_shared_note(self, chunk: int = 0) -> RAPDU:
+        return self.backend.exchange(cla=CLA,
+                                     ins=InsType.GET_NOTE,
+                                     p1=chunk,
+                                     p2=P2.P2_LAST,
+                                     data=b"")
+
+
+    def put_shared_note(self, title: bytes, content: bytes) -> RAPDU:
+        self.backend.exchange(cla=CLA,
+                              ins=InsType.PUT_NOTE,
+                              p1=P1Note.P1_NOTE_START,
+                              p2=P2.P2_LAST,
+                              data=pack(">BH", len(title), len(content)))
+        for chunk in split_message(title + content, MAX_APDU_LEN):
+            self.backend.exchange(cla=CLA,
+                                  ins=InsType.PUT_NOTE,
+                                  p1=P1Note.P1_NOTE_CONTINUE,
+                                  p2=P2.P2_LAST,
+                                  data=chunk)
+        return self.backend.exchange(cla=CLA,
+                                     ins=InsType.PUT_NOTE,
+                                     p1=P1Note.P1_NOTE_FINISH,
+                                     p2=P2.P2_LAST,
+                                     data=sha256(title + content).digest())
+
+
+    def put_shared_notes(self, notes: List[Tuple[bytes, bytes]]) -> RAPDU:
+        self.backend.exchange(cla=CLA,
+                              ins=InsType.PUT_NOTE,
+                              p1=P1Note.P1_NOTE_BATCH,
+                              p2=P2.P2_LAST,
+                              data=pack(">BH",
+                                        len(notes),
+                                        sum(len(title + content) for title, content in notes)))
+        for title, content in notes:
+            response = self.put_shared_note(title, content)
+        return response
+
+
+    def put_encrypted_note(self, payload: bytes) -> RAPDU:
+        response = self.backend.exchange(cla=CLA,
+                                         ins=InsType.PUT_NOTE,
+                                         p1=P1Note.P1_NOTE_ENCRYPTED_START,
+                                         p2=P2.P2_LAST,
+                                         data=pack(">H", len(payload)))
+        for chunk in split_message(payload, MAX_APDU_LEN):
+            response = self.backend.exchange(cla=CLA,
+                                             ins=InsType.PUT_NOTE,
+                                             p1=P1Note.P1_NOTE_ENCRYPTED_CONTINUE,
+                                             p2=P2.P2_LAST,
+                                             data=chunk)
+        return response
+
+
+    def get_wear_stats(self, chunk: int = 0) -> RAPDU:
+        return self.backend.exchange(cla=CLA,
+                                     ins=InsType.GET_WEAR_STATS,
+                                     p1=chunk,
+                                     p2=P2.P2_LAST,
+                                     data=b"")
+
+
+    def get_store_root(self) -> RAPDU:
+        return self.backend.exchange(cla=CLA,
+                                     ins=InsType.GET_STORE_ROOT,
+                                     p1=P1.P1_START,
+                                     p2=P2.P2_LAST,
+                                     data=b"")
+
+
+    def export_notes(self, slot: int = 0, offset: int = 0) -> RAPDU:
+        return self.backend.exchange(cla=CLA,
+                                     ins=InsType.EXPORT_NOTES,
+                                     p1=P1.P1_START,
+                                     p2=P2.P2_LAST,
+                                     data=pack(">HH", slot, offset))
+
+
+    @contextmanager
+    def export_notes_with_confirmation(self,
+                                       slot: int = 0,
+                                       offset: int = 0) -> Generator[None, None, None]:
+        with self.backend.exchange_async(cla=CLA,
+                                         ins=InsType.EXPORT_NOTES,
+                                         p1=P1.P1_START,
+                                         p2=P2.P2_LAST,
+                                         data=pack(">HH", slot, offset)) as response:
+            yield response
+
+
+    def get_changes(self, seq: int = 0, slot: int = 0) -> RAPDU:
+        return self.backend.exchange(cla=CLA,
+                                     ins=InsType.GET_CHANGES,
+                                     p1=P1.P1_START,
+                                     p2=P2.P2_LAST,
+                                     data=pack(">IH", seq, slot))
+
+
     def get_public_key(self, path: str) -> RAPDU:
         return self.backend.exchange(cla=CLA,
                                      ins=InsType.GET_PUBLIC_KEY,
@@ -88,6 +225,14 @@ class BoilerplateCommandSender:
                                      data=pack_derivation_path(path))
 
 
+    def get_public_keys(self, path: str, first: int, count: int) -> RAPDU:
+        return self.backend.exchange(cla=CLA,
+                                     ins=InsType.GET_PUBLIC_KEYS,
+                                     p1=P1.P1_START,
+                                     p2=P2.P2_LAST,
+                                     data=pack_derivation_path(path) + pack(">IB", first, count))
+
+
     @contextmanager
     def get_public_key_with_confirmation(self, path: str) -> Generator[None, None, None]:
         with self.backend.exchange_async(cla=CLA,
@@ -123,5 +268,42 @@ class BoilerplateCommandSender:
                                          data=messages[-1]) as response:
             yield response
 
+    @contextmanager
+    def sign_tx_batch(self,
+                      path: str,
+                      transactions: List[bytes]) -> Generator[None, None, None]:
+        self.backend.exchange(cla=CLA,
+                              ins=InsType.SIGN_TX_BATCH,
+                              p1=P1Batch.P1_BATCH_START,
+                              p2=P2.P2_LAST,
+                              data=pack_derivation_path(path) + pack(">B", len(transactions)))
+        chunks = []
+        for transaction in transactions:
+            messages = split_message(transaction, MAX_APDU_LEN)
+            chunks += [(msg, P2.P2_MORE) for msg in messages[:-1]]
+            chunks.append((messages[-1], P2.P2_LAST))
+
+        for msg, p2 in chunks[:-1]:
+            self.backend.exchange(cla=CLA,
+                                  ins=InsType.SIGN_TX_BATCH,
+                                  p1=P1Batch.P1_BATCH_TX,
+                                  p2=p2,
+                                  data=msg)
+
+        with self.backend.exchange_async(cla=CLA,
+                                         ins=InsType.SIGN_TX_BATCH,
+                                         p1=P1Batch.P1_BATCH_TX,
+                                         p2=P2.P2_LAST,
+                                         data=chunks[-1][0]) as response:
+            yield response
+
+
+    def get_batch_signatures(self, index: int) -> RAPDU:
+        return self.backend.exchange(cla=CLA,
+                                     ins=InsType.SIGN_TX_BATCH,
+                                     p1=P1Batch.P1_BATCH_SIGNATURES,
+                                     p2=P2.P2_LAST,
+                                     data=pack(">B", index))
+
     def get_async_response(self) -> Optional[RAPDU]:
         return self.backend.last_async_response
@@ -1,4 +1,4 @@
-from typing import Tuple
+from typing import List, Tuple
 from struct import unpack
 
 # remainder, data_len, data
@@ -57,6 +57,21 @@ def unpack_get_public_key_response(response: bytes) -> Tuple[int, bytes, int, by
 
     return pub_key_len, pub_key, chain_code_len, chain_code
 
+# Unpack from response:
+# response = nb_keys (1)
+#            (compressed_pub_key (33) || address (20)) * nb_keys
+def unpack_get_public_keys_response(response: bytes) -> List[Tuple[bytes, bytes]]:
+    response, nb_keys = pop_sized_buf_from_buffer(response, 1)
+    keys = []
+    for _ in range(nb_keys[0]):
+        response, public_key = pop_sized_buf_from_buffer(response, 33)
+        response, address = pop_sized_buf_from_buffer(response, 20)
+        keys.append((public_key, address))
+
+    assert len(response) == 0
+
+    return keys
+
 # Unpack from response:
 # response = der_sig_len (1)
 #            der_sig (var)
@@ -68,3 +83,90 @@ def unpack_sign_tx_response(response: bytes) -> Tuple[int, bytes, int]:
     assert len(response) == 0
 
     return der_sig_len, der_sig, int.from_bytes(v, byteorder='big')
+
+# Unpack from response:
+# response = nb_sigs (1)
+#            (der_sig_len (1) || der_sig (var) || v (1)) * nb_sigs
+def unpack_sign_tx_batch_response(response: bytes) -> List[Tuple[int, bytes, int]]:
+    response, nb_sigs = pop_sized_buf_from_buffer(response, 1)
+    signatures = []
+    for _ in range(nb_sigs[0]):
+        response, der_sig_len, der_sig = pop_size_prefixed_buf_from_buf(response)
+        response, v = pop_sized_buf_from_buffer(response, 1)
+        signatures.append((der_sig_len, der_sig, int.from_bytes(v, byteorder='big')))
+
+    assert len(response) == 0
+
+    return signatures
+
+# Unpack from response:
+# response = total_len (2)
+#            offset (2)
+#            chunk (var)
+def unpack_get_shared_note_response(response: bytes) -> Tuple[int, int, bytes]:
+    total_len, offset = unpack(">HH", response[:4])
+
+    return total_len, offset, response[4:]
+
+# Unpack from response:
+# response = nb_contacts (2)
+#            nb_banks (1)
+#            nb_pages (2)
+#            counters (4 * nb_counters_in_chunk)
+def unpack_get_wear_stats_response(response: bytes) -> Tuple[int, int, int, List[int]]:
+    nb_contacts, nb_banks, nb_pages = unpack(">HBH", response[:5])
+    response = response[5:]
+
+    assert len(response) % 4 == 0
+
+    return nb_contacts, nb_banks, nb_pages, list(unpack(f">{len(response) // 4}I", response))
+
+# Unpack from response:
+# response = nb_notes (2)
+#            nb_contacts (2)
+#            nb_corrupted_notes (2)
+#            root (32)
+def unpack_get_store_root_response(response: bytes) -> Tuple[int, int, int, bytes]:
+    assert len(response) == 38
+    nb_notes, nb_contacts, nb_corrupted_notes = unpack(">HHH", response[:6])
+
+    return nb_notes, nb_contacts, nb_corrupted_notes, response[6:]
+
+# Unpack from response:
+# response = slot (2)
+#            offset (2)
+#            bytes of the records (var)
+def unpack_export_notes_response(response: bytes) -> Tuple[int, int, bytes]:
+    slot, offset = unpack(">HH", response[:4])
+
+    return slot, offset, response[4:]
+
+# Unpack from exported stream:
+# stream = records, each of them:
+#            slot (2)
+#            body_len (2)
+#            body (var)
+def unpack_export_records(stream: bytes) -> List[Tuple[int, bytes]]:
+    records = []
+    while len(stream) > 0:
+        slot, body_len = unpack(">HH", stream[:4])
+        records.append((slot, stream[4:4 + body_len]))
+        stream = stream[4 + body_len:]
+
+    return records
+
+# Unpack from response:
+# response = next seq (4)
+#            next slot (2)
+#            changes, each of them:
+#              slot (2)
+#              seq (4)
+#              hash (32)
+def unpack_get_changes_response(response: bytes) -> Tuple[int, int, List[Tuple[int, int, bytes]]]:
+    next_seq, next_slot = unpack(">IH", response[:6])
+    changes = []
+    for offset in range(6, len(response), 38):
+        slot, seq = unpack(">HI", response[offset:offset + 6])
+        changes.append((slot, seq, response[offset + 6:offset + 38]))
+
+    return next_seq, next_slot, changes
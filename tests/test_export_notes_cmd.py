@@ -0,0 +1,46 @@
+import pytest
+
+from application_client.boilerplate_command_sender import BoilerplateCommandSender, Errors
+from application_client.boilerplate_response_unpacker import unpack_export_notes_response, \
+    unpack_export_records
+from ragger.error import ExceptionRAPDU
+from ragger.navigator import NavInsID
+
+
+# In this test we check that the EXPORT_NOTES is allowed once per export by the user, then
+# replies all the records until the end cursor is reached
+def test_export_notes_accepted(firmware, backend, navigator):
+    if firmware.device.startswith("nano"):
+        pytest.skip("Notes are not supported on Nano")
+    client = BoilerplateCommandSender(backend)
+    with client.export_notes_with_confirmation():
+        navigator.navigate([NavInsID.USE_CASE_CHOICE_CONFIRM],
+                           screen_change_after_last_instruction=False)
+    slot, offset, chunk = unpack_export_notes_response(client.get_async_response().data)
+    stream = chunk
+    # the next chunks are not confirmed again
+    while len(chunk) > 0:
+        response = client.export_notes(slot, offset)
+        slot, offset, chunk = unpack_export_notes_response(response.data)
+        stream += chunk
+    # the store of the emulator is empty
+    assert unpack_export_records(stream) == []
+    assert offset == 0
+    # once complete, the next export is allowed again by the user
+    with client.export_notes_with_confirmation():
+        navigator.navigate([NavInsID.USE_CASE_CHOICE_CONFIRM],
+                           screen_change_after_last_instruction=False)
+    slot, offset, chunk = unpack_export_notes_response(client.get_async_response().data)
+    assert len(chunk) == 0
+
+
+# In this test we check that the EXPORT_NOTES replies an error if the user refuses
+def test_export_notes_refused(firmware, backend, navigator):
+    if firmware.device.startswith("nano"):
+        pytest.skip("Notes are not supported on Nano")
+    client = BoilerplateCommandSender(backend)
+    with pytest.raises(ExceptionRAPDU) as e:
+        with client.export_notes_with_confirmation():
+            navigator.navigate([NavInsID.USE_CASE_CHOICE_REJECT],
+                               screen_change_after_last_instruction=False)
+    assert e.value.status == Errors.SW_DENY
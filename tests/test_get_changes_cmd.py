@@ -0,0 +1,49 @@
+from hashlib import sha256
+from struct import pack
+
+import pytest
+
+from application_client.boilerplate_command_sender import BoilerplateCommandSender
+from application_client.boilerplate_response_unpacker import unpack_get_changes_response, \
+    unpack_get_store_root_response
+from ragger.navigator import NavInsID
+
+
+# sync all the slots modified since the given sequence number
+def sync(client, seq):
+    next_slot = 0
+    all_changes = []
+    first_next_seq = None
+    while True:
+        response = client.get_changes(seq, next_slot)
+        next_seq, next_slot, changes = unpack_get_changes_response(response.data)
+        if first_next_seq is None:
+            first_next_seq = next_seq
+        all_changes += changes
+        if len(changes) == 0:
+            return first_next_seq, all_changes
+
+
+# In this test we check that the GET_CHANGES only replies the slots modified since the given
+# sequence number, with the hash of their leaf in the Merkle tree of the store
+def test_get_changes(firmware, backend, navigator):
+    if firmware.device.startswith("nano"):
+        pytest.skip("Notes are not supported on Nano")
+    client = BoilerplateCommandSender(backend)
+    nb_notes = unpack_get_store_root_response(client.get_store_root().data)[0]
+    cursor, changes = sync(client, 0)
+    assert len(changes) == nb_notes
+    # nothing changed since the last sync
+    assert sync(client, cursor)[1] == []
+    title, content = b"Synced", b"some content"
+    client.put_shared_note(title, content)
+    navigator.navigate([NavInsID.USE_CASE_CHOICE_CONFIRM],
+                       screen_change_after_last_instruction=False)
+    next_cursor, changes = sync(client, cursor)
+    assert len(changes) == 1
+    slot, seq, leaf_hash = changes[0]
+    assert seq >= cursor and next_cursor == seq + 1
+    leaf = pack(">BBH", 0x00, 0x01, slot) + pack(">H", len(title)) + title \
+        + pack(">H", len(content)) + content
+    assert leaf_hash == sha256(leaf).digest()
+    assert sync(client, next_cursor)[1] == []
@@ -0,0 +1,23 @@
+import pytest
+
+from ragger.error import ExceptionRAPDU
+from application_client.boilerplate_command_sender import BoilerplateCommandSender, CLA, \
+    InsType, P2, Errors
+
+
+# In this test we check that the GET_NOTE is rejected when no note is being shared, whatever
+# chunk is asked
+def test_get_note_nothing_shared(backend):
+    # Use the app interface instead of raw interface
+    client = BoilerplateCommandSender(backend)
+    for chunk in [0, 1]:
+        with pytest.raises(ExceptionRAPDU) as e:
+            client.get_shared_note(chunk)
+        assert e.value.status == Errors.SW_NO_SHARED_NOTE
+
+
+# Ensure the GET_NOTE is rejected when a bad P2 is used
+def test_get_note_wrong_p2(backend):
+    with pytest.raises(ExceptionRAPDU) as e:
+        backend.exchange(cla=CLA, ins=InsType.GET_NOTE, p1=0, p2=P2.P2_MORE)
+    assert e.value.status == Errors.SW_WRONG_P1P2
@@ -87,3 +87,18 @@ def test_get_public_key_confirm_refused(firmware, backend, navigator, test_name)
             # Assert that we have received a refusal
             assert e.value.status == Errors.SW_DENY
             assert len(e.value.data) == 0
+
+
+# In this test we check that, of the keys of the app, only the public key of the sharing key is given
+def test_get_public_key_app_paths(backend):
+    client = BoilerplateCommandSender(backend)
+    path = "m/1313821765'/0'"
+    response = client.get_public_key(path=path).data
+    _, public_key, _, _ = unpack_get_public_key_response(response)
+    ref_public_key, _ = calculate_public_key_and_chaincode(CurveChoice.Secp256k1, path=path)
+    assert public_key.hex() == ref_public_key
+
+    for path in ["m/1313821765'/1'", "m/1313821765'/0'/0"]:
+        with pytest.raises(ExceptionRAPDU) as e:
+            client.get_public_key(path=path)
+        assert e.value.status == Errors.SW_WRONG_DATA
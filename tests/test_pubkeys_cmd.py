@@ -0,0 +1,77 @@
+from time import perf_counter
+
+import pytest
+
+from application_client.boilerplate_command_sender import BoilerplateCommandSender, Errors
+from application_client.boilerplate_response_unpacker import unpack_get_public_keys_response, \
+    unpack_get_public_key_response
+from ragger.bip import calculate_public_key_and_chaincode, CurveChoice
+from ragger.error import ExceptionRAPDU
+from sha3 import keccak_256
+
+
+def compress(public_key: bytes) -> bytes:
+    return bytes([0x02 | (public_key[64] & 1)]) + public_key[1:33]
+
+
+def get_all_public_keys(client: BoilerplateCommandSender, path: str, first: int, count: int):
+    keys = []
+    while len(keys) < count:
+        response = client.get_public_keys(path, first + len(keys), count - len(keys))
+        keys += unpack_get_public_keys_response(response.data)
+    return keys
+
+
+# In this test we check that the GET_PUBLIC_KEYS sends the keys and addresses of the children of
+# the base path, across several responses, for normal and hardened indexes
+def test_get_public_keys(backend):
+    client = BoilerplateCommandSender(backend)
+    for path, first, children in [("m/44'/1'/0'/0", 0, [f"{i}" for i in range(10)]),
+                                  ("m/44'/1'/0'", 0x80000000 - 2, ["2147483646", "2147483647",
+                                                                   "0'", "1'", "2'"])]:
+        keys = get_all_public_keys(client, path, first, len(children))
+        assert len(keys) == len(children)
+        for (public_key, address), child in zip(keys, children):
+            ref_public_key, _ = calculate_public_key_and_chaincode(CurveChoice.Secp256k1,
+                                                                   path=f"{path}/{child}")
+            ref_public_key = bytes.fromhex(ref_public_key)
+            assert public_key == compress(ref_public_key)
+            assert address == keccak_256(ref_public_key[1:]).digest()[-20:]
+
+
+# In this test we compare the time to get the keys of an account with GET_PUBLIC_KEY and with
+# GET_PUBLIC_KEYS
+def test_get_public_keys_speed(backend):
+    client = BoilerplateCommandSender(backend)
+    count = 20
+    start = perf_counter()
+    for i in range(count):
+        response = client.get_public_key(path=f"m/44'/1'/0'/0/{i}")
+        _, public_key, _, _ = unpack_get_public_key_response(response.data)
+    single = perf_counter() - start
+    start = perf_counter()
+    keys = get_all_public_keys(client, "m/44'/1'/0'/0", 0, count)
+    batch = perf_counter() - start
+    assert keys[-1][0] == compress(public_key)
+    print(f"\n{count} keys: {single:.3f} s with GET_PUBLIC_KEY, {batch:.3f} s with "
+          f"GET_PUBLIC_KEYS ({single / batch:.1f}x)")
+
+
+# In this test we check that the invalid ranges are rejected
+def test_get_public_keys_invalid(backend):
+    client = BoilerplateCommandSender(backend)
+    for path, first, count in [("m/44'/1'/0'/0", 0, 0),
+                               ("m/44'/1'/0'/0", 0xFFFFFFFF, 2),
+                               ("m/44'/1'/0'/0/0/0/0/0/0/0", 0, 1)]:
+        with pytest.raises(ExceptionRAPDU) as e:
+            client.get_public_keys(path, first, count)
+        assert e.value.status == Errors.SW_WRONG_DATA_LENGTH
+
+
+# In this test we check that the keys of the app (sharing, storage) are not exported
+def test_get_public_keys_app_paths(backend):
+    client = BoilerplateCommandSender(backend)
+    for path in ["m/1313821765'", "m/1313821765'/0'", "m/1313821765'/1'"]:
+        with pytest.raises(ExceptionRAPDU) as e:
+            client.get_public_keys(path, 0, 1)
+        assert e.value.status == Errors.SW_WRONG_DATA
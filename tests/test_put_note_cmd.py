@@ -0,0 +1,188 @@
+from hashlib import sha256
+from struct import pack
+from time import perf_counter
+
+import pytest
+
+from ragger.error import ExceptionRAPDU
+from application_client.boilerplate_command_sender import BoilerplateCommandSender, CLA, \
+    InsType, P1Note, P2, Errors, MAX_APDU_LEN
+from application_client.boilerplate_response_unpacker import unpack_get_store_root_response, \
+    unpack_get_public_key_response
+from ragger.navigator import NavInsID
+from utils import compressed_public_key, seal_shared_note
+
+
+# Path of the sharing key of the device, whose public key the sender encrypts the note for
+SHARING_PATH = "m/1313821765'/0'"
+# Private keys of the sharing keys of the devices of the sender and of another contact, on other
+# seeds
+SENDER_PRIVATE_KEY = 0x5E9DE55E9DE55E9DE55E9DE55E9DE55E9DE55E9DE55E9DE55E9DE55E9DE55E9D
+OTHER_PRIVATE_KEY = 0x07E907E907E907E907E907E907E907E907E907E907E907E907E907E907E907E9
+
+
+def put_note(backend, p1: int, data: bytes):
+    return backend.exchange(cla=CLA, ins=InsType.PUT_NOTE, p1=p1, p2=P2.P2_LAST, data=data)
+
+
+# In this test we check that a full size note is received in several APDUs, the user being then
+# asked to accept it
+def test_put_note_full_size(backend):
+    # Use the app interface instead of raw interface
+    client = BoilerplateCommandSender(backend)
+    response = client.put_shared_note(b"T" * 127, b"content " * 63 + b"content")
+    assert response.status == 0x9000
+
+
+# In this test we check that the reception of a note is rejected when its lengths are too large
+def test_put_note_wrong_lengths(backend):
+    for title_len, content_len in [(128, 0), (0, 512)]:
+        with pytest.raises(ExceptionRAPDU) as e:
+            put_note(backend, P1Note.P1_NOTE_START, pack(">BH", title_len, content_len))
+        assert e.value.status == Errors.SW_WRONG_DATA_LENGTH
+
+
+# In this test we check that a note is rejected when more bytes than announced are received
+def test_put_note_too_many_bytes(backend):
+    put_note(backend, P1Note.P1_NOTE_START, pack(">BH", 2, 2))
+    put_note(backend, P1Note.P1_NOTE_CONTINUE, b"abc")
+    with pytest.raises(ExceptionRAPDU) as e:
+        put_note(backend, P1Note.P1_NOTE_CONTINUE, b"de")
+    assert e.value.status == Errors.SW_WRONG_DATA_LENGTH
+
+
+# In this test we check that a note is only accepted once complete, and with the right hash
+def test_put_note_wrong_hash(backend):
+    put_note(backend, P1Note.P1_NOTE_START, pack(">BH", 2, 2))
+    put_note(backend, P1Note.P1_NOTE_CONTINUE, b"ab")
+    with pytest.raises(ExceptionRAPDU) as e:
+        put_note(backend, P1Note.P1_NOTE_FINISH, bytes(32))
+    assert e.value.status == Errors.SW_BAD_STATE
+    put_note(backend, P1Note.P1_NOTE_CONTINUE, b"cd")
+    with pytest.raises(ExceptionRAPDU) as e:
+        put_note(backend, P1Note.P1_NOTE_FINISH, bytes(32))
+    assert e.value.status == Errors.SW_WRONG_NOTE_HASH
+    # the note has been dropped
+    with pytest.raises(ExceptionRAPDU) as e:
+        put_note(backend, P1Note.P1_NOTE_CONTINUE, b"e")
+    assert e.value.status == Errors.SW_WRONG_DATA_LENGTH
+
+
+# In this test we check that several notes are received after being announced, the user being
+# asked once to accept all of them
+def test_put_notes_batch(firmware, backend, navigator):
+    if firmware.device.startswith("nano"):
+        pytest.skip("Notes are not supported on Nano")
+    client = BoilerplateCommandSender(backend)
+    nb_notes = unpack_get_store_root_response(client.get_store_root().data)[0]
+    notes = [(b"Note %d" % i, b"content " * 30) for i in range(12)]
+    response = client.put_shared_notes(notes)
+    assert response.status == 0x9000
+    navigator.navigate([NavInsID.USE_CASE_CHOICE_CONFIRM],
+                       screen_change_after_last_instruction=False)
+    assert unpack_get_store_root_response(client.get_store_root().data)[0] == nb_notes + 12
+
+
+# Number of full size notes announced at once in each round of the throughput benchmark, and
+# number of rounds
+BENCHMARK_NB_NOTES = 10
+BENCHMARK_NB_ROUNDS = 5
+
+
+# In this benchmark, only run with "-m benchmark" (and "-s" to see the report), we measure the
+# throughput of the reception of announced full size notes, in APDU/s and B/s of titles and
+# contents. Only the APDUs are timed, not the confirmation, and the notes are rejected after each
+# round so that the storage is left as it was
+@pytest.mark.benchmark
+def test_put_notes_throughput(firmware, backend, navigator):
+    if firmware.device.startswith("nano"):
+        pytest.skip("Notes are not supported on Nano")
+    client = BoilerplateCommandSender(backend)
+    notes = [(b"T" * 127, b"c" * 511)] * BENCHMARK_NB_NOTES
+    nb_bytes = sum(len(title + content) for title, content in notes)
+    # the announce, then START, FINISH and as many CONTINUE as needed per note
+    nb_apdus = 1 + sum(2 + (len(title + content) + MAX_APDU_LEN - 1) // MAX_APDU_LEN
+                       for title, content in notes)
+    duration = 0.0
+    for _ in range(BENCHMARK_NB_ROUNDS):
+        start = perf_counter()
+        response = client.put_shared_notes(notes)
+        duration += perf_counter() - start
+        assert response.status == 0x9000
+        navigator.navigate([NavInsID.USE_CASE_CHOICE_REJECT],
+                           screen_change_after_last_instruction=False)
+    nb_apdus *= BENCHMARK_NB_ROUNDS
+    nb_bytes *= BENCHMARK_NB_ROUNDS
+    print(f"\n{firmware.device}: {nb_apdus} APDUs, {nb_bytes} bytes in {duration:.3f} s: "
+          f"{nb_apdus / duration:.1f} APDU/s, {nb_bytes / duration:.0f} B/s")
+
+
+# In this test we check that announced notes can not exceed the announced total length, nor be
+# more numerous than announced
+def test_put_notes_batch_too_many_bytes(backend):
+    put_note(backend, P1Note.P1_NOTE_BATCH, pack(">BH", 2, 4))
+    put_note(backend, P1Note.P1_NOTE_START, pack(">BH", 1, 1))
+    put_note(backend, P1Note.P1_NOTE_CONTINUE, b"ab")
+    put_note(backend, P1Note.P1_NOTE_FINISH, sha256(b"ab").digest())
+    with pytest.raises(ExceptionRAPDU) as e:
+        put_note(backend, P1Note.P1_NOTE_START, pack(">BH", 100, 100))
+    assert e.value.status == Errors.SW_NOT_ENOUGH_SPACE
+
+
+def device_sharing_public_key(client) -> bytes:
+    _, public_key, _, _ = unpack_get_public_key_response(
+        client.get_public_key(path=SHARING_PATH).data)
+    return bytes([0x02 + (public_key[64] & 1)]) + public_key[1:33]
+
+
+# In this test we check that a note encrypted by another seed for several contacts, as sent by
+# GET_NOTE, is decrypted by the device as one of the recipients, the user being then asked to
+# accept it
+def test_put_note_encrypted(firmware, backend, navigator):
+    if firmware.device.startswith("nano"):
+        pytest.skip("Notes are not supported on Nano")
+    client = BoilerplateCommandSender(backend)
+    nb_notes = unpack_get_store_root_response(client.get_store_root().data)[0]
+    recipients = [compressed_public_key(OTHER_PRIVATE_KEY), device_sharing_public_key(client)]
+    payload = seal_shared_note(SENDER_PRIVATE_KEY, recipients, b"T" * 127, b"c" * 511)
+    response = client.put_encrypted_note(payload)
+    assert response.status == 0x9000
+    navigator.navigate([NavInsID.USE_CASE_CHOICE_CONFIRM],
+                       screen_change_after_last_instruction=False)
+    assert unpack_get_store_root_response(client.get_store_root().data)[0] == nb_notes + 1
+
+
+# In this test we check that an encrypted note is rejected when the device is not one of its
+# recipients, or when any byte authenticated for the device has been modified
+def test_put_note_encrypted_not_authentic(backend):
+    client = BoilerplateCommandSender(backend)
+    device_public_key = device_sharing_public_key(client)
+    other_public_key = compressed_public_key(OTHER_PRIVATE_KEY)
+    payload = seal_shared_note(SENDER_PRIVATE_KEY, [other_public_key], b"Title", b"content")
+    with pytest.raises(ExceptionRAPDU) as e:
+        client.put_encrypted_note(payload)
+    assert e.value.status == Errors.SW_WRONG_SHARED_NOTE
+
+    payload = seal_shared_note(SENDER_PRIVATE_KEY, [device_public_key], b"Title", b"content")
+    # version, sender, number of recipients, public key and wrapped content key of the recipient,
+    # nonce, ciphertext and tag of the note
+    for offset in [0, 1, 34, 35, 35 + 33 + 8, 35 + 81, len(payload) - 9, len(payload) - 1]:
+        tampered = bytearray(payload)
+        tampered[offset] ^= 0x01
+        with pytest.raises(ExceptionRAPDU) as e:
+            client.put_encrypted_note(bytes(tampered))
+        assert e.value.status == Errors.SW_WRONG_SHARED_NOTE
+
+
+# In this test we check that the payload of an encrypted note is rejected when its length cannot
+# be the one of a payload, or when more bytes than announced are received
+def test_put_note_encrypted_wrong_lengths(backend):
+    for length in [10, 2000]:
+        with pytest.raises(ExceptionRAPDU) as e:
+            put_note(backend, P1Note.P1_NOTE_ENCRYPTED_START, pack(">H", length))
+        assert e.value.status == Errors.SW_WRONG_DATA_LENGTH
+    put_note(backend, P1Note.P1_NOTE_ENCRYPTED_START, pack(">H", 200))
+    put_note(backend, P1Note.P1_NOTE_ENCRYPTED_CONTINUE, bytes(150))
+    with pytest.raises(ExceptionRAPDU) as e:
+        put_note(backend, P1Note.P1_NOTE_ENCRYPTED_CONTINUE, bytes(51))
+    assert e.value.status == Errors.SW_WRONG_DATA_LENGTH
@@ -0,0 +1,98 @@
+import pytest
+
+from application_client.boilerplate_transaction import Transaction
+from application_client.boilerplate_command_sender import BoilerplateCommandSender, Errors
+from application_client.boilerplate_response_unpacker import unpack_get_public_key_response, \
+    unpack_sign_tx_batch_response
+from ragger.error import ExceptionRAPDU
+from ragger.navigator import NavInsID
+from utils import check_signature_validity
+
+# In this tests we check the behavior of the device when asked to sign several transactions at once
+
+PATH: str = "m/44'/1'/0'/0/0"
+DESTINATIONS = ["0xde0b295669a9fd93d5f28d9ec85e40f4cb697bae",
+                "0x7ac33997544e3175d266bd022439b22cdb16508c"]
+
+
+def build_transactions(nb_tx: int) -> list:
+    return [Transaction(nonce=i,
+                        to=DESTINATIONS[i % len(DESTINATIONS)],
+                        value=1000 + i,
+                        memo=f"Payout {i}").serialize() for i in range(nb_tx)]
+
+
+# In this test we send a batch of transactions, approve their summary once, and check that all the
+# signatures are valid, the first ones in the response and the next ones fetched by index
+def test_sign_tx_batch_accepted(firmware, backend, navigator):
+    if firmware.device.startswith("nano"):
+        pytest.skip("Batch review is not supported on Nano")
+    client = BoilerplateCommandSender(backend)
+    rapdu = client.get_public_key(path=PATH)
+    _, public_key, _, _ = unpack_get_public_key_response(rapdu.data)
+
+    # the long memo of the last transaction is sent in several chunks
+    transactions = build_transactions(6)
+    transactions.append(Transaction(nonce=6,
+                                    to=DESTINATIONS[0],
+                                    value=1,
+                                    memo="x" * 300).serialize())
+
+    with client.sign_tx_batch(path=PATH, transactions=transactions):
+        navigator.navigate_until_text(NavInsID.USE_CASE_REVIEW_TAP,
+                                      [NavInsID.USE_CASE_REVIEW_CONFIRM,
+                                       NavInsID.USE_CASE_STATUS_DISMISS],
+                                      "Hold to sign")
+    signatures = unpack_sign_tx_batch_response(client.get_async_response().data)
+    assert len(signatures) == 3
+    while len(signatures) < len(transactions):
+        response = client.get_batch_signatures(len(signatures))
+        signatures += unpack_sign_tx_batch_response(response.data)
+
+    assert len(signatures) == len(transactions)
+    for (_, der_sig, _), transaction in zip(signatures, transactions):
+        assert check_signature_validity(public_key, der_sig, transaction)
+
+
+# In this test we check that the batch is rejected if the user refuses its summary
+def test_sign_tx_batch_refused(firmware, backend, navigator):
+    if firmware.device.startswith("nano"):
+        pytest.skip("Batch review is not supported on Nano")
+    client = BoilerplateCommandSender(backend)
+    with pytest.raises(ExceptionRAPDU) as e:
+        with client.sign_tx_batch(path=PATH, transactions=build_transactions(2)):
+            navigator.navigate([NavInsID.USE_CASE_REVIEW_REJECT,
+                                NavInsID.USE_CASE_CHOICE_CONFIRM,
+                                NavInsID.USE_CASE_STATUS_DISMISS])
+    assert e.value.status == Errors.SW_DENY
+
+    # no signature can be fetched
+    with pytest.raises(ExceptionRAPDU) as e:
+        client.get_batch_signatures(0)
+    assert e.value.status == Errors.SW_BAD_STATE
+
+
+# In this test we check that an invalid transaction drops the whole batch as soon as it is received
+def test_sign_tx_batch_invalid_tx(backend):
+    client = BoilerplateCommandSender(backend)
+    transactions = build_transactions(3)
+    # the memo length of the second transaction is above the maximum
+    transactions[1] = transactions[1][:36] + b"\xfd\xff\x01" + transactions[1][37:]
+
+    with pytest.raises(ExceptionRAPDU) as e:
+        with client.sign_tx_batch(path=PATH, transactions=transactions):
+            pass
+    assert e.value.status == Errors.SW_TX_PARSING_FAIL
+
+    with pytest.raises(ExceptionRAPDU) as e:
+        client.get_batch_signatures(0)
+    assert e.value.status == Errors.SW_BAD_STATE
+
+
+# In this test we check that the number of transactions of a batch is limited
+def test_sign_tx_batch_too_many(backend):
+    client = BoilerplateCommandSender(backend)
+    with pytest.raises(ExceptionRAPDU) as e:
+        with client.sign_tx_batch(path=PATH, transactions=build_transactions(17)):
+            pass
+    assert e.value.status == Errors.SW_WRONG_DATA_LENGTH
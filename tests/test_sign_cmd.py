@@ -139,3 +139,20 @@ def test_sign_tx_refused(firmware, backend, navigator, test_name):
             # Assert that we have received a refusal
             assert e.value.status == Errors.SW_DENY
             assert len(e.value.data) == 0
+
+
+# In this test we check that the keys of the app (sharing, storage) never sign
+def test_sign_tx_app_path_rejected(backend):
+    client = BoilerplateCommandSender(backend)
+    transaction = Transaction(
+        nonce=1,
+        to="0xde0b295669a9fd93d5f28d9ec85e40f4cb697bae",
+        value=666,
+        memo="For u EthDev"
+    ).serialize()
+
+    for path in ["m/1313821765'/0'", "m/1313821765'/1'"]:
+        with pytest.raises(ExceptionRAPDU) as e:
+            with client.sign_tx(path=path, transaction=transaction):
+                pass
+        assert e.value.status == Errors.SW_WRONG_DATA
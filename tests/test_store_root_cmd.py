@@ -0,0 +1,21 @@
+from hashlib import sha256
+
+from application_client.boilerplate_command_sender import BoilerplateCommandSender
+from application_client.boilerplate_response_unpacker import unpack_get_store_root_response
+
+
+# In this test we check that the GET_STORE_ROOT replies the Merkle root of the saved notes and
+# contacts, which is the hash of nothing for an empty store
+def test_store_root(backend):
+    # Use the app interface instead of raw interface
+    client = BoilerplateCommandSender(backend)
+    # Send the GET_STORE_ROOT instruction to the app
+    response = client.get_store_root()
+    nb_notes, nb_contacts, nb_corrupted_notes, root = unpack_get_store_root_response(response.data)
+    assert nb_notes == 0
+    assert nb_contacts == 0
+    assert nb_corrupted_notes == 0
+    assert root == sha256(b"").digest()
+    # the root is computed again, with the same result
+    response = client.get_store_root()
+    assert unpack_get_store_root_response(response.data)[3] == root
@@ -0,0 +1,27 @@
+from application_client.boilerplate_command_sender import BoilerplateCommandSender
+from application_client.boilerplate_response_unpacker import unpack_get_wear_stats_response
+
+
+# In this test we check that the GET_WEAR_STATS replies the number of writes of each NVRAM slot
+# and page, in several chunks
+def test_wear_stats(backend):
+    # Use the app interface instead of raw interface
+    client = BoilerplateCommandSender(backend)
+    # Send the GET_WEAR_STATS instruction to the app, until all counters are received
+    counters = []
+    chunk = 0
+    while True:
+        response = client.get_wear_stats(chunk)
+        nb_contacts, nb_banks, nb_pages, chunk_counters = \
+            unpack_get_wear_stats_response(response.data)
+        if len(chunk_counters) == 0:
+            break
+        counters += chunk_counters
+        chunk += 1
+    assert nb_banks == 2
+    assert len(counters) == nb_contacts + nb_banks * nb_pages
+    contact_writes = counters[:nb_contacts]
+    page_writes = counters[nb_contacts:]
+    assert len(contact_writes) == nb_contacts
+    # the first page of the active bank has been written when initializing the NVRAM
+    assert sum(page_writes) > 0
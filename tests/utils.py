@@ -1,9 +1,14 @@
+import hmac
+import os
 from pathlib import Path
 from hashlib import sha256
+from struct import pack
+from typing import List
 from sha3 import keccak_256
 
+from cryptography.hazmat.primitives.ciphers import Cipher, algorithms, modes
 from ecdsa.curves import SECP256k1
-from ecdsa.keys import VerifyingKey
+from ecdsa.keys import SigningKey, VerifyingKey
 from ecdsa.util import sigdecode_der
 
 
@@ -21,3 +26,53 @@ def check_signature_validity(public_key: bytes, signature: bytes, message: bytes
                      data=message,
                      hashfunc=keccak_256,
                      sigdecode=sigdecode_der)
+
+
+# Fields of the payload of a shared note, see GET_NOTE in doc/APDU.md
+NOTE_SHARE_VERSION: int = 0x02
+FIELD_CONTENT_KEY: int = 0x04
+FIELD_SHARED_NOTE: int = 0x05
+
+
+# Compressed public key of the given private key
+def compressed_public_key(private_key: int) -> bytes:
+    signing_key = SigningKey.from_secret_exponent(private_key, curve=SECP256k1)
+    return signing_key.get_verifying_key().to_string("compressed")
+
+
+# Key shared by the given private key with the given public key (compressed or not)
+def sharing_key(private_key: int, public_key: bytes) -> bytes:
+    point = VerifyingKey.from_string(public_key, curve=SECP256k1).pubkey.point * private_key
+    return sha256(point.x().to_bytes(32, "big")).digest()
+
+
+# Encrypt a field of a shared note with the given key, as nonce (8) || ciphertext || tag (8)
+def seal_field(key: bytes, field: int, header: bytes, plaintext: bytes) -> bytes:
+    encryption_key = hmac.new(key, b"Notes encryption", sha256).digest()
+    authentication_key = hmac.new(key, b"Notes authentication", sha256).digest()
+    nonce = os.urandom(8)
+    encryptor = Cipher(algorithms.AES(encryption_key),
+                       modes.CTR(nonce + bytes([field]) + bytes(7))).encryptor()
+    ciphertext = encryptor.update(plaintext) + encryptor.finalize()
+    tag = hmac.new(authentication_key,
+                   pack(">HB", 0, field) + nonce + header + ciphertext,
+                   sha256).digest()[:8]
+    return nonce + ciphertext + tag
+
+
+# Payload of a note shared by the given private key with the given public keys, as sent by
+# GET_NOTE on the device of the sender
+def seal_shared_note(private_key: int,
+                     recipients: List[bytes],
+                     title: bytes,
+                     content: bytes) -> bytes:
+    content_key = os.urandom(32)
+    header = bytes([NOTE_SHARE_VERSION]) + compressed_public_key(private_key)
+    payload = header + bytes([len(recipients)])
+    for public_key in recipients:
+        payload += public_key + seal_field(sharing_key(private_key, public_key),
+                                           FIELD_CONTENT_KEY,
+                                           header,
+                                           content_key)
+    note = pack(">BH", len(title), len(content)) + title + content
+    return payload + seal_field(content_key, FIELD_SHARED_NOTE, payload, note)
@@ -0,0 +1,108 @@
+/**
+ * Host benchmark of the first start of the application, when NVRAM is initialized.
+ *
+ * It runs the initialization of the Notes storage over a host copy of NVRAM, counting the bytes
+ * and flash pages given to nvm_write(), and compares them with a copy of the whole NVRAM data,
+ * as done by the first versions of the application.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "app_notes.h"
+#include "key_cache.h"
+#include "nvram_struct.h"
+
+static uint32_t nb_bytes;
+static uint32_t nb_pages;
+
+// position of the given address in NVRAM, which is aligned on a flash page on device
+static uintptr_t nvram_offset(const void *address) {
+    return (uintptr_t) address - (uintptr_t) &N_nvram_real;
+}
+
+void nvm_write(void *dst, void *src, unsigned int len) {
+    uintptr_t offset = nvram_offset(dst);
+
+    if (len == 0) {
+        return;
+    }
+    memmove(dst, src, len);
+    nb_bytes += len;
+    nb_pages += (offset + len - 1) / NVRAM_PAGE_SIZE - offset / NVRAM_PAGE_SIZE + 1;
+}
+
+// the keys cannot be derived on host: Notes are stored without encryption
+cx_err_t key_cache_get(const uint32_t *bip32_path,
+                       uint8_t bip32_path_len,
+                       const key_cache_entry_t **entry) {
+    (void) bip32_path;
+    (void) bip32_path_len;
+    (void) entry;
+    return CX_INTERNAL_ERROR;
+}
+
+cx_err_t key_cache_get_sharing_key(uint16_t contact,
+                                   const uint8_t public_key[static 33],
+                                   uint8_t key[static 32]) {
+    (void) contact;
+    (void) public_key;
+    (void) key;
+    return CX_INTERNAL_ERROR;
+}
+
+cx_err_t key_cache_get_sharing_public_key(uint8_t public_key[static 33]) {
+    (void) public_key;
+    return CX_INTERNAL_ERROR;
+}
+
+void key_cache_clear(void) {
+}
+
+// NVRAM is a read-only variable, only written by nvm_write()
+static void nvram_unprotect(void) {
+    uintptr_t page_size = (uintptr_t) sysconf(_SC_PAGESIZE);
+    uintptr_t start = (uintptr_t) &N_nvram_real & ~(page_size - 1);
+    uintptr_t end = (uintptr_t) &N_nvram_real + sizeof(N_nvram_real);
+
+    if (mprotect((void *) start, end - start, PROT_READ | PROT_WRITE) != 0) {
+        perror("mprotect");
+        exit(1);
+    }
+}
+
+static void print_line(const char *name, uint32_t bytes, uint32_t pages) {
+    printf("%-28s %8u %8u\n", name, bytes, pages);
+}
+
+// run the first start of the application over the current content of NVRAM
+static void run(const char *name) {
+    nb_bytes = 0;
+    nb_pages = 0;
+    app_notesInit();
+    print_line(name, nb_bytes, nb_pages);
+}
+
+int main() {
+    uint8_t *nvram = (uint8_t *) &N_nvram_real;
+    uint32_t data_size = sizeof(N_nvram_real.data);
+
+    nvram_unprotect();
+    printf("%-28s %8s %8s\n", "first start", "bytes", "pages");
+    print_line("copy of all NVRAM data",
+               data_size,
+               (data_size + NVRAM_PAGE_SIZE - 1) / NVRAM_PAGE_SIZE);
+
+    memset(nvram, 0, sizeof(N_nvram_real));
+    run("erased NVRAM");
+
+    srand(0);
+    for (size_t i = 0; i < sizeof(N_nvram_real); i++) {
+        nvram[i] = rand();
+    }
+    run("NVRAM of another application");
+    return 0;
+}
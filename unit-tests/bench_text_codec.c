@@ -0,0 +1,116 @@
+/**
+ * Host benchmark of the codec used to compress the content of Notes in NVRAM.
+ *
+ * It reports, for a set of typical Notes, the compression ratio and the number of cycles (or
+ * nanoseconds if no cycle counter is available) spent to encode and decode each Note.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define COUNTER_UNIT "cycles"
+static uint64_t read_counter(void) {
+    return __rdtsc();
+}
+#else
+#define COUNTER_UNIT "ns"
+static uint64_t read_counter(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+
+#include "compression/text_codec.h"
+
+#define NOTE_MAX_LEN 512
+#define NB_RUNS      1000
+
+static const char *const NOTES[] = {
+    "Buy milk, eggs, bread and some coffee for the week end.",
+    "Meeting with the team on Monday at ten: review the roadmap, then discuss the budget for the "
+    "next quarter and the hiring of two more engineers.",
+    "The wifi password of the office is written on the board in the kitchen, next to the "
+    "coffee machine.",
+    "Call the bank about the transfer that was sent twice last month, and ask them to cancel "
+    "the second one before the end of the week.",
+    "Ideas for the holidays: a trip in the mountains with the children, or a few days at the "
+    "sea if the weather is good enough. Book the train tickets early, they are cheaper.",
+    "To do before leaving: water the plants, close the windows, take out the trash, turn off "
+    "the heating and leave the keys to the neighbour.",
+    "Recipe: mix the flour with the sugar and the butter, then add the eggs one by one. Pour "
+    "into the mould and bake for forty minutes at one hundred and eighty degrees.",
+    "This is a longer note, to check how the codec behaves when the text is close to the "
+    "maximum size of a Note. It contains several sentences that share many words with each "
+    "other, because that is what most notes written by people look like: there are the same "
+    "words, the same names and the same places repeated again and again. The codec should "
+    "find these repetitions and replace them with references to the previous occurrences, "
+    "and the most frequent words should be replaced by a single byte.",
+};
+
+int main() {
+    uint8_t compressed[NOTE_MAX_LEN];
+    char decompressed[NOTE_MAX_LEN];
+    size_t total_len = 0;
+    size_t total_compressed_len = 0;
+    uint64_t total_encode = 0;
+    uint64_t total_decode = 0;
+    size_t nb_notes = sizeof(NOTES) / sizeof(NOTES[0]);
+
+    printf("%4s %6s %6s %7s %12s %12s\n",
+           "note",
+           "raw",
+           "stored",
+           "ratio",
+           "encode (" COUNTER_UNIT ")",
+           "decode (" COUNTER_UNIT ")");
+    for (size_t i = 0; i < nb_notes; i++) {
+        size_t len = strlen(NOTES[i]);
+        int compressed_len = 0;
+        int decompressed_len = 0;
+        uint64_t start = read_counter();
+
+        for (int run = 0; run < NB_RUNS; run++) {
+            compressed_len = text_codec_compress(NOTES[i], len, compressed, sizeof(compressed));
+        }
+        uint64_t encode = (read_counter() - start) / NB_RUNS;
+        start = read_counter();
+        for (int run = 0; run < NB_RUNS; run++) {
+            decompressed_len = text_codec_decompress(compressed,
+                                                     compressed_len,
+                                                     decompressed,
+                                                     sizeof(decompressed));
+        }
+        uint64_t decode = (read_counter() - start) / NB_RUNS;
+
+        if ((compressed_len < 0) || (decompressed_len != (int) len) ||
+            (strcmp(decompressed, NOTES[i]) != 0)) {
+            fprintf(stderr, "round trip failed for note %zu\n", i);
+            return 1;
+        }
+        // as in NVRAM, a Note is stored raw (with its final '\0') if compression does not help
+        size_t stored_len = ((size_t) compressed_len < len + 1) ? (size_t) compressed_len : len + 1;
+        printf("%4zu %6zu %6zu %7.3f %12llu %12llu\n",
+               i,
+               len + 1,
+               stored_len,
+               (double) stored_len / (len + 1),
+               (unsigned long long) encode,
+               (unsigned long long) decode);
+        total_len += len + 1;
+        total_compressed_len += stored_len;
+        total_encode += encode;
+        total_decode += decode;
+    }
+    printf("total: %zu -> %zu bytes, ratio %.3f, %llu/%llu " COUNTER_UNIT
+           " per note to encode/decode\n",
+           total_len,
+           total_compressed_len,
+           (double) total_compressed_len / total_len,
+           (unsigned long long) (total_encode / nb_notes),
+           (unsigned long long) (total_decode / nb_notes));
+    return 0;
+}
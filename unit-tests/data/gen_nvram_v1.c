@@ -0,0 +1,77 @@
+/**
+ * Generator of nvram_v1.bin, the NVRAM left by the release 1.0.0 of the application (version 1 of
+ * the NVRAM structure), to test its conversion.
+ *
+ * It is built on host with the app_notes_utils.c and nvram_struct.c of this release, and the
+ * stubs of ../stubs, then run with the path of the image to write:
+ *   gcc -I../stubs -I<release>/src -I<release>/src/ui -include stdbool.h gen_nvram_v1.c \
+ *       <release>/src/app_notes_utils.c <release>/src/nvram_struct.c -o gen_nvram_v1
+ *   ./gen_nvram_v1 nvram_v1.bin
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "app_notes.h"
+#include "nvram_struct.h"
+
+void nvm_write(void *dst, void *src, unsigned int len) {
+    memmove(dst, src, len);
+}
+
+int main(int argc, char **argv) {
+    uintptr_t page_size = (uintptr_t) sysconf(_SC_PAGESIZE);
+    uintptr_t start = (uintptr_t) &N_nvram_real & ~(page_size - 1);
+    uintptr_t end = (uintptr_t) &N_nvram_real + sizeof(N_nvram_real);
+    char title[NOTE_TITLE_MAX_LEN];
+    char content[NOTE_CONTENT_MAX_LEN];
+    char name[CONTACT_NAME_LEN];
+    char address[CONTACT_ADDRESS_MAX_LEN];
+    FILE *file;
+
+    if (argc != 2 || mprotect((void *) start, end - start, PROT_READ | PROT_WRITE) != 0) {
+        return 1;
+    }
+    app_notesInit();
+    // all the notes, the last one with the longest title and content, then a deleted one
+    for (int i = 0; i < NB_MAX_NOTES; i++) {
+        snprintf(title, sizeof(title), "Note %d", i);
+        snprintf(content, sizeof(content), "Content of note %d", i);
+        if (i == NB_MAX_NOTES - 1) {
+            memset(title, 'T', sizeof(title) - 1);
+            title[sizeof(title) - 1] = '\0';
+            memset(content, 'C', sizeof(content) - 1);
+            content[sizeof(content) - 1] = '\0';
+        }
+        if (app_notesAddNote(title, content) < 0) {
+            return 1;
+        }
+    }
+    app_notesDeleteNote(3);
+    // as many contacts as this release can add, the last one with the longest name and address,
+    // then a deleted one
+    for (int i = 0; i < 10; i++) {
+        snprintf(name, sizeof(name), "Contact %d", i);
+        snprintf(address, sizeof(address), "0xaddress%02d", i);
+        if (i == 9) {
+            memset(name, 'N', sizeof(name) - 1);
+            name[sizeof(name) - 1] = '\0';
+            memset(address, 'A', sizeof(address) - 1);
+            address[sizeof(address) - 1] = '\0';
+        }
+        if (app_notesAddContact(name, address) < 0) {
+            return 1;
+        }
+    }
+    app_notesDeleteContact(5);
+
+    file = fopen(argv[1], "wb");
+    if (file == NULL || fwrite(&N_nvram_real, sizeof(N_nvram_real), 1, file) != 1) {
+        return 1;
+    }
+    fclose(file);
+    return 0;
+}
@@ -0,0 +1,121 @@
+/**
+ * Host replacement of the cryptography of the SDK, only used by the benchmark of NVRAM
+ * initialization: CRC-16 is computed as on device, the other primitives fail, so that Notes are
+ * stored without encryption.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define CX_OK                0x00000000
+#define CX_INTERNAL_ERROR    0xFFFFFF85
+#define CX_INVALID_PARAMETER 0xFFFFFF84
+#define CX_LAST              (1 << 0)
+#define CX_SHA256_SIZE       32
+
+typedef uint32_t cx_err_t;
+
+typedef struct {
+    uint8_t unused;
+} cx_hash_t;
+
+typedef struct {
+    cx_hash_t header;
+} cx_sha256_t;
+
+typedef struct {
+    cx_hash_t header;
+} cx_hmac_t;
+
+typedef cx_hmac_t cx_hmac_sha256_t;
+
+typedef struct {
+    uint8_t keys[240];
+} cx_aes_key_t;
+
+typedef struct {
+    uint8_t d[32];
+} cx_ecfp_256_private_key_t;
+
+static inline uint16_t cx_crc16(const void *buf, size_t len) {
+    const uint8_t *bytes = buf;
+    uint16_t crc = 0xFFFF;
+
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t) bytes[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t) ((crc << 1) ^ 0x1021) : (uint16_t) (crc << 1);
+        }
+    }
+    return crc;
+}
+
+static inline cx_err_t cx_sha256_init_no_throw(cx_sha256_t *hash) {
+    (void) hash;
+    return CX_INTERNAL_ERROR;
+}
+
+static inline cx_err_t cx_hash_no_throw(cx_hash_t *hash,
+                                        uint32_t mode,
+                                        const uint8_t *in,
+                                        size_t len,
+                                        uint8_t *out,
+                                        size_t out_len) {
+    (void) hash;
+    (void) mode;
+    (void) in;
+    (void) len;
+    if (out != NULL) {
+        memset(out, 0, out_len);
+    }
+    return CX_INTERNAL_ERROR;
+}
+
+static inline size_t cx_hash_sha256(const uint8_t *in, size_t len, uint8_t *out, size_t out_len) {
+    (void) in;
+    (void) len;
+    memset(out, 0, out_len);
+    return 0;
+}
+
+static inline cx_err_t cx_hmac_sha256_init_no_throw(cx_hmac_sha256_t *hmac,
+                                                    const uint8_t *key,
+                                                    size_t key_len) {
+    (void) hmac;
+    (void) key;
+    (void) key_len;
+    return CX_INTERNAL_ERROR;
+}
+
+static inline cx_err_t cx_hmac_no_throw(cx_hmac_t *hmac,
+                                        uint32_t mode,
+                                        const uint8_t *in,
+                                        size_t len,
+                                        uint8_t *mac,
+                                        size_t mac_len) {
+    return cx_hash_no_throw(&hmac->header, mode, in, len, mac, mac_len);
+}
+
+static inline cx_err_t cx_aes_init_key_no_throw(const uint8_t *raw_key,
+                                                size_t key_len,
+                                                cx_aes_key_t *key) {
+    (void) raw_key;
+    (void) key_len;
+    (void) key;
+    return CX_INTERNAL_ERROR;
+}
+
+static inline cx_err_t cx_aes_enc_block(const cx_aes_key_t *key,
+                                        const uint8_t *in,
+                                        uint8_t *out) {
+    (void) key;
+    (void) in;
+    (void) out;
+    return CX_INTERNAL_ERROR;
+}
+
+static inline void cx_rng_no_throw(uint8_t *buffer, size_t len) {
+    memset(buffer, 0, len);
+}
@@ -0,0 +1,6 @@
+/**
+ * Host replacement of the glyphs generated by the build of the application.
+ */
+#pragma once
+
+#include "nbgl_types.h"
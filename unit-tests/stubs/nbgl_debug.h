@@ -0,0 +1,6 @@
+/**
+ * Host replacement of the NBGL debug helpers of the SDK.
+ */
+#pragma once
+
+#include "nbgl_types.h"
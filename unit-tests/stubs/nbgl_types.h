@@ -0,0 +1,9 @@
+/**
+ * Host replacement of the NBGL types of the SDK.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef void (*nbgl_callback_t)(void);
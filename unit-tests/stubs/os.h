@@ -0,0 +1,11 @@
+/**
+ * Host replacement of the OS header of the SDK.
+ */
+#pragma once
+
+#include <string.h>
+
+#include "os_nvm.h"
+#include "os_pic.h"
+
+#define PRINTF(...)
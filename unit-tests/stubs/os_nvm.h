@@ -0,0 +1,6 @@
+/**
+ * Host replacement of the NVRAM writes of the SDK, implemented by the benchmark.
+ */
+#pragma once
+
+void nvm_write(void *dst, void *src, unsigned int len);
@@ -0,0 +1,6 @@
+/**
+ * Host replacement of the position-independent code helpers of the SDK.
+ */
+#pragma once
+
+#define PIC(x) (x)
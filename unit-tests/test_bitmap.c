@@ -0,0 +1,90 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "bitmap.h"
+
+#define NB_BITS 100
+
+static void test_bitmap_set_clear(void **state) {
+    (void) state;
+
+    uint32_t bitmap[BITMAP_NB_WORDS(NB_BITS)] = {0};
+
+    assert_int_equal(BITMAP_NB_WORDS(NB_BITS), 4);
+    assert_int_equal(bitmap_count(bitmap, NB_BITS), 0);
+    bitmap_set(bitmap, 0);
+    bitmap_set(bitmap, 31);
+    bitmap_set(bitmap, 32);
+    bitmap_set(bitmap, NB_BITS - 1);
+    assert_true(bitmap_test(bitmap, 0));
+    assert_true(bitmap_test(bitmap, 31));
+    assert_true(bitmap_test(bitmap, 32));
+    assert_false(bitmap_test(bitmap, 33));
+    assert_true(bitmap_test(bitmap, NB_BITS - 1));
+    assert_int_equal(bitmap[0], 0x80000001);
+    assert_int_equal(bitmap_count(bitmap, NB_BITS), 4);
+    bitmap_clear(bitmap, 31);
+    assert_false(bitmap_test(bitmap, 31));
+    assert_int_equal(bitmap[0], 0x00000001);
+    assert_int_equal(bitmap_count(bitmap, NB_BITS), 3);
+}
+
+static void test_bitmap_next(void **state) {
+    (void) state;
+
+    uint32_t bitmap[BITMAP_NB_WORDS(NB_BITS)] = {0};
+
+    assert_int_equal(bitmap_next_set(bitmap, NB_BITS, 0), NB_BITS);
+    assert_int_equal(bitmap_next_clear(bitmap, NB_BITS, 0), 0);
+    bitmap_set(bitmap, 5);
+    bitmap_set(bitmap, 70);
+    assert_int_equal(bitmap_next_set(bitmap, NB_BITS, 0), 5);
+    assert_int_equal(bitmap_next_set(bitmap, NB_BITS, 5), 5);
+    assert_int_equal(bitmap_next_set(bitmap, NB_BITS, 6), 70);
+    assert_int_equal(bitmap_next_set(bitmap, NB_BITS, 71), NB_BITS);
+    assert_int_equal(bitmap_next_set(bitmap, NB_BITS, NB_BITS), NB_BITS);
+
+    // fill all the bits but one
+    memset(bitmap, 0xFF, sizeof(bitmap));
+    bitmap[BITMAP_NB_WORDS(NB_BITS) - 1] = 0;
+    for (uint16_t i = 96; i < NB_BITS; i++) {
+        bitmap_set(bitmap, i);
+    }
+    bitmap_clear(bitmap, 64);
+    assert_int_equal(bitmap_next_clear(bitmap, NB_BITS, 0), 64);
+    assert_int_equal(bitmap_next_clear(bitmap, NB_BITS, 65), NB_BITS);
+    bitmap_set(bitmap, 64);
+    assert_int_equal(bitmap_next_clear(bitmap, NB_BITS, 0), NB_BITS);
+    assert_int_equal(bitmap_count(bitmap, NB_BITS), NB_BITS);
+}
+
+static void test_bitmap_select(void **state) {
+    (void) state;
+
+    uint32_t bitmap[BITMAP_NB_WORDS(NB_BITS)] = {0};
+    uint16_t indexes[]                         = {1, 2, 31, 33, 64, 98, 99};
+    size_t   i;
+
+    assert_int_equal(bitmap_select(bitmap, NB_BITS, 0), NB_BITS);
+    for (i = 0; i < sizeof(indexes) / sizeof(indexes[0]); i++) {
+        bitmap_set(bitmap, indexes[i]);
+    }
+    for (i = 0; i < sizeof(indexes) / sizeof(indexes[0]); i++) {
+        assert_int_equal(bitmap_select(bitmap, NB_BITS, i), indexes[i]);
+    }
+    assert_int_equal(bitmap_select(bitmap, NB_BITS, i), NB_BITS);
+}
+
+int main() {
+    const struct CMUnitTest tests[] = {cmocka_unit_test(test_bitmap_set_clear),
+                                       cmocka_unit_test(test_bitmap_next),
+                                       cmocka_unit_test(test_bitmap_select)};
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,144 @@
+/**
+ * Conversion of the NVRAM left by the release 1.0.0 of the application (version 1 of the NVRAM
+ * structure), from the image of data/nvram_v1.bin generated with this release (see
+ * data/gen_nvram_v1.c).
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cmocka.h>
+
+#include "app_notes.h"
+#include "key_cache.h"
+#include "nvram_struct.h"
+
+// notes and contacts deleted in the image
+#define DELETED_NOTE    3
+#define DELETED_CONTACT 5
+// number of contacts added in the image, the last one being the longest
+#define NB_V1_CONTACTS 10
+
+void nvm_write(void *dst, void *src, unsigned int len) {
+    memmove(dst, src, len);
+}
+
+// the keys cannot be derived on host: Notes are stored without encryption
+cx_err_t key_cache_get(const uint32_t *bip32_path,
+                       uint8_t bip32_path_len,
+                       const key_cache_entry_t **entry) {
+    (void) bip32_path;
+    (void) bip32_path_len;
+    (void) entry;
+    return CX_INTERNAL_ERROR;
+}
+
+cx_err_t key_cache_get_sharing_key(uint16_t contact,
+                                   const uint8_t public_key[static 33],
+                                   uint8_t key[static 32]) {
+    (void) contact;
+    (void) public_key;
+    (void) key;
+    return CX_INTERNAL_ERROR;
+}
+
+cx_err_t key_cache_get_sharing_public_key(uint8_t public_key[static 33]) {
+    (void) public_key;
+    return CX_INTERNAL_ERROR;
+}
+
+void key_cache_clear(void) {
+}
+
+// load the image over an erased NVRAM
+static int setup_nvram_v1(void **state) {
+    uintptr_t page_size = (uintptr_t) sysconf(_SC_PAGESIZE);
+    uintptr_t start = (uintptr_t) &N_nvram_real & ~(page_size - 1);
+    uintptr_t end = (uintptr_t) &N_nvram_real + sizeof(N_nvram_real);
+    FILE *file = fopen(NVRAM_V1_IMAGE, "rb");
+    size_t length;
+
+    (void) state;
+    if (file == NULL || mprotect((void *) start, end - start, PROT_READ | PROT_WRITE) != 0) {
+        return -1;
+    }
+    memset((void *) &N_nvram_real, 0, sizeof(N_nvram_real));
+    length = fread((void *) &N_nvram_real, 1, sizeof(N_nvram_real), file);
+    fclose(file);
+    return (length > sizeof(Nvram_header_t)) ? 0 : -1;
+}
+
+static void test_nvram_convert_v1(void **state) {
+    (void) state;
+
+    char title[NOTE_TITLE_MAX_LEN];
+    char content[NOTE_CONTENT_MAX_LEN];
+    char expected_title[NOTE_TITLE_MAX_LEN];
+    char expected_content[NOTE_CONTENT_MAX_LEN];
+    char expected_name[CONTACT_NAME_LEN];
+    char expected_address[CONTACT_ADDRESS_MAX_LEN];
+    Note_t note = {.title = title, .content = content};
+    Contact_t contacts[NB_MAX_CONTACTS];
+    uint16_t nb_contacts;
+
+    assert_int_equal(nvram_get_struct_version(), 1);
+    app_notesInit();
+    assert_int_equal(nvram_get_struct_version(), NVRAM_STRUCT_VERSION);
+
+    assert_int_equal(app_notesGetAll(NULL), NVRAM_V1_NB_NOTES - 1);
+    for (uint16_t i = 0; i < NVRAM_V1_NB_NOTES; i++) {
+        if (i == DELETED_NOTE) {
+            assert_true(app_notesGetNote(i, &note) < 0);
+            continue;
+        }
+        snprintf(expected_title, sizeof(expected_title), "Note %u", i);
+        snprintf(expected_content, sizeof(expected_content), "Content of note %u", i);
+        if (i == NVRAM_V1_NB_NOTES - 1) {
+            memset(expected_title, 'T', sizeof(expected_title) - 1);
+            expected_title[sizeof(expected_title) - 1] = '\0';
+            memset(expected_content, 'C', sizeof(expected_content) - 1);
+            expected_content[sizeof(expected_content) - 1] = '\0';
+        }
+        assert_int_equal(app_notesGetNote(i, &note), 0);
+        assert_string_equal(title, expected_title);
+        assert_string_equal(content, expected_content);
+    }
+
+    nb_contacts = app_notesGetContacts(contacts);
+    assert_int_equal(nb_contacts, NB_V1_CONTACTS - 1);
+    for (uint16_t i = 0; i < nb_contacts; i++) {
+        uint16_t index = (i < DELETED_CONTACT) ? i : i + 1;
+
+        snprintf(expected_name, sizeof(expected_name), "Contact %u", index);
+        snprintf(expected_address, sizeof(expected_address), "0xaddress%02u", index);
+        if (index == NB_V1_CONTACTS - 1) {
+            memset(expected_name, 'N', sizeof(expected_name) - 1);
+            expected_name[sizeof(expected_name) - 1] = '\0';
+            memset(expected_address, 'A', sizeof(expected_address) - 1);
+            expected_address[sizeof(expected_address) - 1] = '\0';
+        }
+        assert_int_equal(contacts[i].index, index);
+        assert_string_equal(contacts[i].name, expected_name);
+        assert_string_equal(contacts[i].address, expected_address);
+    }
+
+    // the converted storage is usable
+    assert_int_equal(app_notesAddNote("New", "New content"), DELETED_NOTE);
+    assert_int_equal(app_notesAddContact("New", "0xnew", NULL), DELETED_CONTACT);
+    assert_int_equal(app_notesGetContacts(contacts), NB_V1_CONTACTS);
+}
+
+int main() {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup(test_nvram_convert_v1, setup_nvram_v1),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
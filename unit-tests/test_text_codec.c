@@ -0,0 +1,96 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "compression/text_codec.h"
+
+#define TEXT_MAX_LEN 512
+
+static void check_round_trip(const char *text) {
+    uint8_t compressed[TEXT_MAX_LEN];
+    char decompressed[TEXT_MAX_LEN];
+    size_t text_len = strlen(text);
+
+    int compressed_len = text_codec_compress(text, text_len, compressed, sizeof(compressed));
+    assert_true(compressed_len >= 0);
+    assert_int_equal(
+        text_codec_decompress(compressed, compressed_len, decompressed, sizeof(decompressed)),
+        text_len);
+    assert_string_equal(decompressed, text);
+}
+
+static void test_text_codec_round_trip(void **state) {
+    (void) state;
+
+    check_round_trip("");
+    check_round_trip("a");
+    check_round_trip("Hello!");
+    check_round_trip("Remember to buy milk, eggs and bread on the way back home.");
+    check_round_trip("The password of the wifi at the office is written in the other note.");
+    check_round_trip("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa");
+    check_round_trip("abcabcabcabcabcabcabcabcabcabcabcabcabcabcabcabcabcabc");
+    check_round_trip("Caf\xc3\xa9 cr\xc3\xa8me br\xc3\xbbl\xc3\xa9" "e \x7f\x01\xff");
+
+    char long_text[TEXT_MAX_LEN];
+    for (size_t i = 0; i < sizeof(long_text) - 1; i++) {
+        long_text[i] = (char) (' ' + ((i * 7) % 95));
+    }
+    long_text[sizeof(long_text) - 1] = '\0';
+    check_round_trip(long_text);
+}
+
+static void test_text_codec_ratio(void **state) {
+    (void) state;
+
+    const char *text =
+        "Meeting with the team on Monday at ten: review the roadmap, then discuss the "
+        "budget for the next quarter and the hiring of two more engineers.";
+    uint8_t compressed[TEXT_MAX_LEN];
+
+    int compressed_len = text_codec_compress(text, strlen(text), compressed, sizeof(compressed));
+    assert_true(compressed_len > 0);
+    assert_true((size_t) compressed_len < strlen(text));
+}
+
+static void test_text_codec_errors(void **state) {
+    (void) state;
+
+    const char *text = "This text does not fit in a tiny output buffer.";
+    uint8_t compressed[TEXT_MAX_LEN];
+    char decompressed[TEXT_MAX_LEN];
+
+    // output buffer too small
+    assert_int_equal(text_codec_compress(text, strlen(text), compressed, 4), -1);
+
+    int compressed_len = text_codec_compress(text, strlen(text), compressed, sizeof(compressed));
+    assert_true(compressed_len > 0);
+    // output string too small
+    assert_int_equal(text_codec_decompress(compressed, compressed_len, decompressed, 8), -1);
+    // truncated input
+    const uint8_t back_reference_without_distance[] = {'a', 'b', 'c', 0xE0};
+    assert_int_equal(text_codec_decompress(back_reference_without_distance,
+                                           sizeof(back_reference_without_distance),
+                                           decompressed,
+                                           sizeof(decompressed)),
+                     -1);
+    // back-reference before the beginning of text
+    const uint8_t back_reference_too_far[] = {'a', 0xE0, 0x05};
+    assert_int_equal(text_codec_decompress(back_reference_too_far,
+                                           sizeof(back_reference_too_far),
+                                           decompressed,
+                                           sizeof(decompressed)),
+                     -1);
+}
+
+int main() {
+    const struct CMUnitTest tests[] = {cmocka_unit_test(test_text_codec_round_trip),
+                                       cmocka_unit_test(test_text_codec_ratio),
+                                       cmocka_unit_test(test_text_codec_errors)};
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -9,57 +9,59 @@
 
 #include "transaction/serialize.h"
 #include "transaction/deserialize.h"
-#include "types.h"
+#include "transaction/types.h"
+
+// clang-format off
+static const uint8_t raw_tx[] = {
+    // nonce (8)
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+    // to (20)
+    0x7a, 0xc3, 0x39, 0x97, 0x54, 0x4e, 0x31, 0x75,
+    0xd2, 0x66, 0xbd, 0x02, 0x24, 0x39, 0xb2, 0x2c,
+    0xdb, 0x16, 0x50, 0x8c,
+    // value (8)
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x09, 0x08, 0x07,
+    // memo length (varint: 1-9)
+    0xf1,
+    // memo (var: 241)
+    0x54, 0x68, 0x65, 0x20, 0x54, 0x68, 0x65, 0x6f,
+    0x72, 0x79, 0x20, 0x6f, 0x66, 0x20, 0x47, 0x72,
+    0x6f, 0x75, 0x70, 0x73, 0x20, 0x69, 0x73, 0x20,
+    0x61, 0x20, 0x62, 0x72, 0x61, 0x6e, 0x63, 0x68,
+    0x20, 0x6f, 0x66, 0x20, 0x6d, 0x61, 0x74, 0x68,
+    0x65, 0x6d, 0x61, 0x74, 0x69, 0x63, 0x73, 0x20,
+    0x69, 0x6e, 0x20, 0x77, 0x68, 0x69, 0x63, 0x68,
+    0x20, 0x6f, 0x6e, 0x65, 0x20, 0x64, 0x6f, 0x65,
+    0x73, 0x20, 0x73, 0x6f, 0x6d, 0x65, 0x74, 0x68,
+    0x69, 0x6e, 0x67, 0x20, 0x74, 0x6f, 0x20, 0x73,
+    0x6f, 0x6d, 0x65, 0x74, 0x68, 0x69, 0x6e, 0x67,
+    0x20, 0x61, 0x6e, 0x64, 0x20, 0x74, 0x68, 0x65,
+    0x6e, 0x20, 0x63, 0x6f, 0x6d, 0x70, 0x61, 0x72,
+    0x65, 0x73, 0x20, 0x74, 0x68, 0x65, 0x20, 0x72,
+    0x65, 0x73, 0x75, 0x6c, 0x74, 0x20, 0x77, 0x69,
+    0x74, 0x68, 0x20, 0x74, 0x68, 0x65, 0x20, 0x72,
+    0x65, 0x73, 0x75, 0x6c, 0x74, 0x20, 0x6f, 0x62,
+    0x74, 0x61, 0x69, 0x6e, 0x65, 0x64, 0x20, 0x66,
+    0x72, 0x6f, 0x6d, 0x20, 0x64, 0x6f, 0x69, 0x6e,
+    0x67, 0x20, 0x74, 0x68, 0x65, 0x20, 0x73, 0x61,
+    0x6d, 0x65, 0x20, 0x74, 0x68, 0x69, 0x6e, 0x67,
+    0x20, 0x74, 0x6f, 0x20, 0x73, 0x6f, 0x6d, 0x65,
+    0x74, 0x68, 0x69, 0x6e, 0x67, 0x20, 0x65, 0x6c,
+    0x73, 0x65, 0x2c, 0x20, 0x6f, 0x72, 0x20, 0x73,
+    0x6f, 0x6d, 0x65, 0x74, 0x68, 0x69, 0x6e, 0x67,
+    0x20, 0x65, 0x6c, 0x73, 0x65, 0x20, 0x74, 0x6f,
+    0x20, 0x74, 0x68, 0x65, 0x20, 0x73, 0x61, 0x6d,
+    0x65, 0x20, 0x74, 0x68, 0x69, 0x6e, 0x67, 0x2e,
+    0x20, 0x4e, 0x65, 0x77, 0x6d, 0x61, 0x6e, 0x2c,
+    0x20, 0x4a, 0x61, 0x6d, 0x65, 0x73, 0x20, 0x52,
+    0x2e
+};
+// clang-format on
 
 static void test_tx_serialization(void **state) {
     (void) state;
 
     transaction_t tx;
-    // clang-format off
-    uint8_t raw_tx[] = {
-        // nonce (8)
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
-        // to (20)
-        0x7a, 0xc3, 0x39, 0x97, 0x54, 0x4e, 0x31, 0x75,
-        0xd2, 0x66, 0xbd, 0x02, 0x24, 0x39, 0xb2, 0x2c,
-        0xdb, 0x16, 0x50, 0x8c,
-        // value (8)
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x09, 0x08, 0x07,
-        // memo length (varint: 1-9)
-        0xf1,
-        // memo (var: 241)
-        0x54, 0x68, 0x65, 0x20, 0x54, 0x68, 0x65, 0x6f,
-        0x72, 0x79, 0x20, 0x6f, 0x66, 0x20, 0x47, 0x72,
-        0x6f, 0x75, 0x70, 0x73, 0x20, 0x69, 0x73, 0x20,
-        0x61, 0x20, 0x62, 0x72, 0x61, 0x6e, 0x63, 0x68,
-        0x20, 0x6f, 0x66, 0x20, 0x6d, 0x61, 0x74, 0x68,
-        0x65, 0x6d, 0x61, 0x74, 0x69, 0x63, 0x73, 0x20,
-        0x69, 0x6e, 0x20, 0x77, 0x68, 0x69, 0x63, 0x68,
-        0x20, 0x6f, 0x6e, 0x65, 0x20, 0x64, 0x6f, 0x65,
-        0x73, 0x20, 0x73, 0x6f, 0x6d, 0x65, 0x74, 0x68,
-        0x69, 0x6e, 0x67, 0x20, 0x74, 0x6f, 0x20, 0x73,
-        0x6f, 0x6d, 0x65, 0x74, 0x68, 0x69, 0x6e, 0x67,
-        0x20, 0x61, 0x6e, 0x64, 0x20, 0x74, 0x68, 0x65,
-        0x6e, 0x20, 0x63, 0x6f, 0x6d, 0x70, 0x61, 0x72,
-        0x65, 0x73, 0x20, 0x74, 0x68, 0x65, 0x20, 0x72,
-        0x65, 0x73, 0x75, 0x6c, 0x74, 0x20, 0x77, 0x69,
-        0x74, 0x68, 0x20, 0x74, 0x68, 0x65, 0x20, 0x72,
-        0x65, 0x73, 0x75, 0x6c, 0x74, 0x20, 0x6f, 0x62,
-        0x74, 0x61, 0x69, 0x6e, 0x65, 0x64, 0x20, 0x66,
-        0x72, 0x6f, 0x6d, 0x20, 0x64, 0x6f, 0x69, 0x6e,
-        0x67, 0x20, 0x74, 0x68, 0x65, 0x20, 0x73, 0x61,
-        0x6d, 0x65, 0x20, 0x74, 0x68, 0x69, 0x6e, 0x67,
-        0x20, 0x74, 0x6f, 0x20, 0x73, 0x6f, 0x6d, 0x65,
-        0x74, 0x68, 0x69, 0x6e, 0x67, 0x20, 0x65, 0x6c,
-        0x73, 0x65, 0x2c, 0x20, 0x6f, 0x72, 0x20, 0x73,
-        0x6f, 0x6d, 0x65, 0x74, 0x68, 0x69, 0x6e, 0x67,
-        0x20, 0x65, 0x6c, 0x73, 0x65, 0x20, 0x74, 0x6f,
-        0x20, 0x74, 0x68, 0x65, 0x20, 0x73, 0x61, 0x6d,
-        0x65, 0x20, 0x74, 0x68, 0x69, 0x6e, 0x67, 0x2e,
-        0x20, 0x4e, 0x65, 0x77, 0x6d, 0x61, 0x6e, 0x2c,
-        0x20, 0x4a, 0x61, 0x6d, 0x65, 0x73, 0x20, 0x52,
-        0x2e
-    };
 
     buffer_t buf = {.ptr = raw_tx, .size = sizeof(raw_tx), .offset = 0};
 
@@ -73,8 +75,147 @@ static void test_tx_serialization(void **state) {
     assert_memory_equal(raw_tx, output, sizeof(raw_tx));
 }
 
+// parse raw_tx (or a modified copy) sent in chunks of chunk_len bytes, except the first one
+static parser_status_e parse_chunks(const uint8_t *data,
+                                    size_t size,
+                                    size_t first_len,
+                                    size_t chunk_len,
+                                    transaction_parser_t *parser,
+                                    transaction_t *tx) {
+    transaction_parser_init(parser, tx);
+
+    size_t offset = 0;
+    size_t len = first_len;
+    while (offset < size) {
+        if (len > size - offset) {
+            len = size - offset;
+        }
+        buffer_t buf = {.ptr = data + offset, .size = len, .offset = 0};
+        parser_status_e status = transaction_parser_update(parser, &buf);
+        if (status != PARSING_OK) {
+            return status;
+        }
+        assert_int_equal(buf.offset, buf.size);
+        offset += len;
+        len = chunk_len;
+    }
+
+    return transaction_parser_finish(parser);
+}
+
+static void assert_tx_equal(const transaction_t *tx) {
+    transaction_t expected;
+    buffer_t buf = {.ptr = raw_tx, .size = sizeof(raw_tx), .offset = 0};
+
+    assert_int_equal(transaction_deserialize(&buf, &expected), PARSING_OK);
+    assert_int_equal(tx->nonce, expected.nonce);
+    assert_int_equal(tx->value, expected.value);
+    assert_memory_equal(tx->to, expected.to, ADDRESS_LEN);
+    assert_int_equal(tx->memo_len, expected.memo_len);
+    assert_memory_equal(tx->memo, expected.memo, expected.memo_len);
+}
+
+static void test_tx_parser_chunks(void **state) {
+    (void) state;
+
+    transaction_parser_t parser;
+    transaction_t tx;
+
+    // every boundary between two chunks
+    for (size_t first_len = 0; first_len <= sizeof(raw_tx); first_len++) {
+        assert_int_equal(
+            parse_chunks(raw_tx, sizeof(raw_tx), first_len, sizeof(raw_tx), &parser, &tx),
+            PARSING_OK);
+        assert_tx_equal(&tx);
+    }
+
+    // every boundary at once
+    assert_int_equal(parse_chunks(raw_tx, sizeof(raw_tx), 1, 1, &parser, &tx), PARSING_OK);
+    assert_tx_equal(&tx);
+
+    uint8_t output[300];
+    int length = transaction_serialize(&tx, output, sizeof(output));
+    assert_int_equal(length, sizeof(raw_tx));
+    assert_memory_equal(raw_tx, output, sizeof(raw_tx));
+}
+
+static void test_tx_parser_varint(void **state) {
+    (void) state;
+
+    transaction_parser_t parser;
+    transaction_t tx;
+    uint8_t data[sizeof(raw_tx) + 2];
+
+    // memo length on 3 bytes, split in every way
+    memcpy(data, raw_tx, 36);
+    data[36] = 0xfd;
+    data[37] = 0xf1;
+    data[38] = 0x00;
+    memcpy(data + 39, raw_tx + 37, sizeof(raw_tx) - 37);
+    for (size_t first_len = 35; first_len <= 40; first_len++) {
+        assert_int_equal(parse_chunks(data, sizeof(data), first_len, 1, &parser, &tx), PARSING_OK);
+        assert_tx_equal(&tx);
+    }
+
+    // empty memo, complete as soon as its length is received
+    memcpy(data, raw_tx, 36);
+    data[36] = 0x00;
+    assert_int_equal(parse_chunks(data, 37, 37, 1, &parser, &tx), PARSING_OK);
+    assert_int_equal(tx.memo_len, 0);
+}
+
+static void test_tx_parser_early_rejection(void **state) {
+    (void) state;
+
+    transaction_parser_t parser;
+    transaction_t tx;
+    uint8_t data[sizeof(raw_tx)];
+    buffer_t buf;
+
+    // memo length above MAX_MEMO_LEN, rejected before the memo is sent
+    memcpy(data, raw_tx, sizeof(data));
+    data[36] = 0xfd;
+    data[37] = 0xff;
+    data[38] = 0xff;
+    transaction_parser_init(&parser, &tx);
+    buf = (buffer_t){.ptr = data, .size = 39, .offset = 0};
+    assert_int_equal(transaction_parser_update(&parser, &buf), MEMO_LENGTH_ERROR);
+    // and the error is kept for the next chunks
+    buf = (buffer_t){.ptr = data + 39, .size = sizeof(data) - 39, .offset = 0};
+    assert_int_equal(transaction_parser_update(&parser, &buf), MEMO_LENGTH_ERROR);
+    assert_int_equal(transaction_parser_finish(&parser), MEMO_LENGTH_ERROR);
+
+    // memo not in ASCII, rejected with its chunk
+    memcpy(data, raw_tx, sizeof(data));
+    data[100] = 0x80;
+    transaction_parser_init(&parser, &tx);
+    buf = (buffer_t){.ptr = data, .size = 64, .offset = 0};
+    assert_int_equal(transaction_parser_update(&parser, &buf), PARSING_OK);
+    buf = (buffer_t){.ptr = data + 64, .size = 64, .offset = 0};
+    assert_int_equal(transaction_parser_update(&parser, &buf), MEMO_ENCODING_ERROR);
+
+    // missing bytes, reported by the field left incomplete
+    assert_int_equal(parse_chunks(raw_tx, 4, 4, 1, &parser, &tx), NONCE_PARSING_ERROR);
+    assert_int_equal(parse_chunks(raw_tx, 20, 4, 1, &parser, &tx), TO_PARSING_ERROR);
+    assert_int_equal(parse_chunks(raw_tx, 30, 4, 1, &parser, &tx), VALUE_PARSING_ERROR);
+    assert_int_equal(parse_chunks(raw_tx, 36, 4, 1, &parser, &tx), MEMO_LENGTH_ERROR);
+    assert_int_equal(parse_chunks(raw_tx, sizeof(raw_tx) - 1, 4, 64, &parser, &tx),
+                     MEMO_PARSING_ERROR);
+
+    // extra byte after the memo
+    transaction_parser_init(&parser, &tx);
+    buf = (buffer_t){.ptr = raw_tx, .size = sizeof(raw_tx), .offset = 0};
+    assert_int_equal(transaction_parser_update(&parser, &buf), PARSING_OK);
+    buf = (buffer_t){.ptr = raw_tx, .size = 1, .offset = 0};
+    assert_int_equal(transaction_parser_update(&parser, &buf), WRONG_LENGTH_ERROR);
+    assert_int_equal(transaction_parser_finish(&parser), WRONG_LENGTH_ERROR);
+}
+
 int main() {
-    const struct CMUnitTest tests[] = {cmocka_unit_test(test_tx_serialization)};
+    const struct CMUnitTest tests[] = {cmocka_unit_test(test_tx_serialization),
+                                       cmocka_unit_test(test_tx_parser_chunks),
+                                       cmocka_unit_test(test_tx_parser_varint),
+                                       cmocka_unit_test(test_tx_parser_early_rejection)};
 
     return cmocka_run_group_tests(tests, NULL, NULL);
 }